@@ -0,0 +1,260 @@
+
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2013, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "common/common_types.h"
+#include "common/autobuf.h"
+#include "common/netaddr.h"
+
+#include "bintelnet_client/bintelnet_client.h"
+
+/**
+ * Connect to the binary telnet interface of a daemon
+ * @param client pointer to uninitialized client
+ * @param remote socket address of the daemon
+ * @param remote_len length of socket address
+ * @return -1 if an error happened, 0 otherwise
+ */
+int
+bintelnet_client_connect(struct bintelnet_client *client,
+    const struct sockaddr *remote, socklen_t remote_len) {
+  memset(client, 0, sizeof(*client));
+
+  if (abuf_init(&client->in)) {
+    return -1;
+  }
+
+  client->sock = socket(remote->sa_family, SOCK_STREAM, 0);
+  if (client->sock == -1) {
+    abuf_free(&client->in);
+    return -1;
+  }
+
+  if (connect(client->sock, remote, remote_len)) {
+    bintelnet_client_close(client);
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Close the connection to the daemon and free all allocated resources
+ * @param client pointer to client
+ */
+void
+bintelnet_client_close(struct bintelnet_client *client) {
+  if (client->sock != -1) {
+    close(client->sock);
+    client->sock = -1;
+  }
+  abuf_free(&client->in);
+}
+
+/**
+ * Send a request to the daemon. Multiple requests can be sent before
+ * receiving the answers, they will be answered in order.
+ * @param client pointer to client
+ * @param cmdline command line ("command parameter")
+ * @return -1 if an error happened, 0 otherwise
+ */
+int
+bintelnet_client_send(struct bintelnet_client *client, const char *cmdline) {
+  uint8_t buffer[BINTELNET_REQUEST_HEADER_SIZE + BINTELNET_MAX_REQUEST_LENGTH];
+  uint32_t length;
+  size_t total, offset;
+  ssize_t result;
+
+  length = strlen(cmdline);
+  if (length > BINTELNET_MAX_REQUEST_LENGTH) {
+    return -1;
+  }
+
+  total = BINTELNET_REQUEST_HEADER_SIZE + length;
+  memcpy(&buffer[BINTELNET_REQUEST_HEADER_SIZE], cmdline, length);
+  length = htonl(length);
+  memcpy(&buffer[0], &length, sizeof(length));
+
+  for (offset = 0; offset < total; offset += result) {
+    result = send(client->sock, &buffer[offset], total - offset, 0);
+    if (result < 0 && errno != EINTR) {
+      return -1;
+    }
+    if (result < 0) {
+      result = 0;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Wait for the next answer of the daemon. The answer data stays
+ * valid until the next call of this function.
+ * @param client pointer to client
+ * @param answer pointer to answer object that will be initialized
+ * @return -1 if an error happened, 0 otherwise
+ */
+int
+bintelnet_client_receive(struct bintelnet_client *client,
+    struct bintelnet_answer *answer) {
+  char buffer[65536];
+  uint32_t length;
+  ssize_t result;
+
+  /* remove last answer */
+  abuf_pull(&client->in, client->_consumed);
+  client->_consumed = 0;
+  length = 0;
+
+  while (true) {
+    if (abuf_getlen(&client->in) >= BINTELNET_ANSWER_HEADER_SIZE) {
+      memcpy(&length, abuf_getptr(&client->in), 4);
+      length = ntohl(length);
+
+      /* the length field must at least cover the result byte */
+      if (length < BINTELNET_ANSWER_HEADER_SIZE - 4) {
+        return -1;
+      }
+      if (abuf_getlen(&client->in) - 4 >= length) {
+        break;
+      }
+    }
+
+    result = recv(client->sock, buffer, sizeof(buffer), 0);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      return -1;
+    }
+    if (abuf_memcpy(&client->in, buffer, result)) {
+      return -1;
+    }
+  }
+
+  memset(answer, 0, sizeof(*answer));
+  answer->result = (uint8_t)abuf_getptr(&client->in)[4];
+  answer->data = (uint8_t *)abuf_getptr(&client->in) + BINTELNET_ANSWER_HEADER_SIZE;
+  answer->length = (size_t)length + 4 - BINTELNET_ANSWER_HEADER_SIZE;
+
+  client->_consumed = (size_t)length + 4;
+  return 0;
+}
+
+/**
+ * Decode the next typed entry of an answer
+ * @param answer pointer to answer
+ * @param entry pointer to entry object that will be initialized
+ * @return -1 if there are no more entries or the answer
+ *   is malformed, 0 otherwise
+ */
+int
+bintelnet_client_next_entry(struct bintelnet_answer *answer,
+    struct bintelnet_entry *entry) {
+  const uint8_t *ptr;
+  size_t key_length;
+
+  if (answer->_offset + TELNET_RECORD_HEADER_SIZE > answer->length) {
+    return -1;
+  }
+
+  ptr = &answer->data[answer->_offset];
+  key_length = ptr[1];
+
+  entry->type = ptr[0];
+  entry->length = (ptr[2] << 8) | ptr[3];
+
+  if (answer->_offset + TELNET_RECORD_HEADER_SIZE
+      + key_length + entry->length > answer->length) {
+    return -1;
+  }
+
+  ptr += TELNET_RECORD_HEADER_SIZE;
+  memcpy(entry->key, ptr, key_length);
+  entry->key[key_length] = 0;
+  entry->value = ptr + key_length;
+
+  answer->_offset += TELNET_RECORD_HEADER_SIZE + key_length + entry->length;
+  return 0;
+}
+
+/**
+ * @param entry pointer to TELNET_RECORD_INT64 entry
+ * @return value of the entry, 0 if the entry has the wrong type
+ */
+int64_t
+bintelnet_entry_get_int64(const struct bintelnet_entry *entry) {
+  uint64_t value;
+  size_t i;
+
+  if (entry->type != TELNET_RECORD_INT64 || entry->length != 8) {
+    return 0;
+  }
+
+  value = 0;
+  for (i=0; i<8; i++) {
+    value = (value << 8) | entry->value[i];
+  }
+  return (int64_t)value;
+}
+
+/**
+ * Convert a TELNET_RECORD_NETADDR entry into an address
+ * @param dst pointer to target address
+ * @param entry pointer to entry
+ * @return -1 if the entry has the wrong type or is malformed,
+ *   0 otherwise
+ */
+int
+bintelnet_entry_get_netaddr(struct netaddr *dst,
+    const struct bintelnet_entry *entry) {
+  if (entry->type != TELNET_RECORD_NETADDR || entry->length < 2) {
+    return -1;
+  }
+  return netaddr_from_binary_prefix(dst, &entry->value[2],
+      entry->length - 2, entry->value[0], entry->value[1]);
+}
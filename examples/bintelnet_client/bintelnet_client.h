@@ -0,0 +1,106 @@
+
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2013, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+#ifndef BINTELNET_CLIENT_H_
+#define BINTELNET_CLIENT_H_
+
+#include <sys/socket.h>
+
+#include "common/common_types.h"
+#include "common/autobuf.h"
+#include "common/netaddr.h"
+
+#include "bintelnet/bintelnet_proto.h"
+
+/* connection to the binary telnet interface of a daemon */
+struct bintelnet_client {
+  /* socket of the connection, -1 if not connected */
+  int sock;
+
+  /* buffer for incoming answers */
+  struct autobuf in;
+
+  /* length of the last answer that has been returned */
+  size_t _consumed;
+};
+
+/* one answer of the daemon */
+struct bintelnet_answer {
+  /* result of the telnet command */
+  enum oonf_telnet_result result;
+
+  /* typed entries of the answer */
+  const uint8_t *data;
+  size_t length;
+
+  /* offset of the next entry for bintelnet_client_next_entry() */
+  size_t _offset;
+};
+
+/* one typed entry of an answer */
+struct bintelnet_entry {
+  enum oonf_telnet_record_type type;
+
+  /* null terminated key of the entry */
+  char key[256];
+
+  /* binary value of the entry */
+  const uint8_t *value;
+  size_t length;
+};
+
+int bintelnet_client_connect(struct bintelnet_client *,
+    const struct sockaddr *remote, socklen_t remote_len);
+void bintelnet_client_close(struct bintelnet_client *);
+
+int bintelnet_client_send(struct bintelnet_client *, const char *cmdline);
+int bintelnet_client_receive(struct bintelnet_client *,
+    struct bintelnet_answer *);
+
+int bintelnet_client_next_entry(struct bintelnet_answer *,
+    struct bintelnet_entry *);
+int64_t bintelnet_entry_get_int64(const struct bintelnet_entry *);
+int bintelnet_entry_get_netaddr(struct netaddr *dst,
+    const struct bintelnet_entry *);
+
+#endif /* BINTELNET_CLIENT_H_ */
@@ -0,0 +1,296 @@
+
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2013, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+/*
+ * Small benchmark for the binary telnet interface. It executes
+ * the same telnet command multiple times over the binary interface
+ * (bintelnet plugin) and the text telnet interface and compares
+ * the time necessary to receive and decode the answers.
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common/common_types.h"
+#include "common/netaddr.h"
+
+#include "bintelnet_client/bintelnet_client.h"
+
+/* statistics of one benchmark run */
+struct _bench_result {
+  uint64_t bytes;
+  uint64_t items;
+  uint64_t usec;
+};
+
+static uint64_t _now(void);
+static int _run_binary(struct _bench_result *, struct sockaddr_in *remote,
+    const char *cmdline, int count);
+static int _run_text(struct _bench_result *, struct sockaddr_in *remote,
+    const char *cmdline, int count);
+static void _print_result(const char *name,
+    struct _bench_result *, int count);
+
+/**
+ * @return monotonic timestamp in microseconds
+ */
+static uint64_t
+_now(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ull + ts.tv_nsec / 1000;
+}
+
+/**
+ * Execute a command multiple times over the binary interface and
+ * decode all entries of the answers.
+ * @param result pointer to benchmark statistics
+ * @param remote address of binary telnet interface
+ * @param cmdline command line
+ * @param count number of requests
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_run_binary(struct _bench_result *result, struct sockaddr_in *remote,
+    const char *cmdline, int count) {
+  struct bintelnet_client client;
+  struct bintelnet_answer answer;
+  struct bintelnet_entry entry;
+  struct netaddr addr;
+  uint64_t start;
+  int i;
+
+  if (bintelnet_client_connect(&client,
+      (struct sockaddr *)remote, sizeof(*remote))) {
+    fprintf(stderr, "Cannot connect to binary telnet interface: %s\n",
+        strerror(errno));
+    return -1;
+  }
+
+  start = _now();
+  for (i=0; i<count; i++) {
+    if (bintelnet_client_send(&client, cmdline)
+        || bintelnet_client_receive(&client, &answer)) {
+      fprintf(stderr, "Binary telnet request failed\n");
+      bintelnet_client_close(&client);
+      return -1;
+    }
+
+    result->bytes += answer.length + BINTELNET_ANSWER_HEADER_SIZE;
+    while (bintelnet_client_next_entry(&answer, &entry) == 0) {
+      switch (entry.type) {
+        case TELNET_RECORD_INT64:
+          bintelnet_entry_get_int64(&entry);
+          break;
+        case TELNET_RECORD_NETADDR:
+          bintelnet_entry_get_netaddr(&addr, &entry);
+          break;
+        default:
+          break;
+      }
+      result->items++;
+    }
+  }
+  result->usec = _now() - start;
+
+  bintelnet_client_close(&client);
+  return 0;
+}
+
+/**
+ * Execute a command multiple times over the text telnet interface
+ * and split the answers into lines. Each command is followed by an
+ * echo command to detect the end of the answer.
+ * @param result pointer to benchmark statistics
+ * @param remote address of text telnet interface
+ * @param cmdline command line
+ * @param count number of requests
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_run_text(struct _bench_result *result, struct sockaddr_in *remote,
+    const char *cmdline, int count) {
+  static const char END_MARKER[] = "--bintelnet-benchmark--";
+  char buffer[65536];
+  char request[1100];
+  uint64_t start;
+  size_t matched;
+  ssize_t len, i;
+  int sock, n;
+  bool done;
+
+  snprintf(request, sizeof(request), "%s\necho %s\n", cmdline, END_MARKER);
+
+  sock = socket(AF_INET, SOCK_STREAM, 0);
+  if (sock == -1
+      || connect(sock, (struct sockaddr *)remote, sizeof(*remote))) {
+    fprintf(stderr, "Cannot connect to telnet interface: %s\n",
+        strerror(errno));
+    if (sock != -1) {
+      close(sock);
+    }
+    return -1;
+  }
+
+  start = _now();
+  for (n=0; n<count; n++) {
+    if (send(sock, request, strlen(request), 0) < 0) {
+      close(sock);
+      return -1;
+    }
+
+    matched = 0;
+    done = false;
+    while (!done) {
+      len = recv(sock, buffer, sizeof(buffer), 0);
+      if (len <= 0) {
+        fprintf(stderr, "Telnet connection closed\n");
+        close(sock);
+        return -1;
+      }
+
+      result->bytes += len;
+      for (i=0; i<len && !done; i++) {
+        if (buffer[i] == '\n') {
+          result->items++;
+        }
+
+        /* look for the end marker */
+        if (buffer[i] == END_MARKER[matched]) {
+          matched++;
+          done = matched == sizeof(END_MARKER) - 1;
+        }
+        else {
+          matched = buffer[i] == END_MARKER[0] ? 1 : 0;
+        }
+      }
+    }
+  }
+  result->usec = _now() - start;
+
+  close(sock);
+  return 0;
+}
+
+/**
+ * Print the statistics of a benchmark run
+ * @param name name of the run
+ * @param result pointer to statistics
+ * @param count number of requests
+ */
+static void
+_print_result(const char *name, struct _bench_result *result, int count) {
+  printf("%-7s %d requests, %"PRIu64" bytes, %"PRIu64" entries/lines, "
+      "%"PRIu64" us total, %"PRIu64" us/request\n",
+      name, count, result->bytes, result->items,
+      result->usec, result->usec / count);
+}
+
+int
+main(int argc, char **argv) {
+  struct _bench_result binary, text;
+  struct sockaddr_in remote;
+  int bin_port, text_port, count, opt;
+
+  bin_port = 2007;
+  text_port = 0;
+  count = 1000;
+
+  memset(&remote, 0, sizeof(remote));
+  remote.sin_family = AF_INET;
+  remote.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  while ((opt = getopt(argc, argv, "a:b:t:n:")) != -1) {
+    switch (opt) {
+      case 'a':
+        if (inet_pton(AF_INET, optarg, &remote.sin_addr) != 1) {
+          fprintf(stderr, "Illegal IPv4 address: %s\n", optarg);
+          return 1;
+        }
+        break;
+      case 'b':
+        bin_port = atoi(optarg);
+        break;
+      case 't':
+        text_port = atoi(optarg);
+        break;
+      case 'n':
+        count = atoi(optarg);
+        break;
+      default:
+        optind = argc;
+        break;
+    }
+  }
+
+  if (optind != argc - 1 || count <= 0) {
+    fprintf(stderr, "Usage: %s [-a <ipv4 address>] [-b <binary port>]"
+        " [-t <text telnet port>] [-n <count>] '<command> <parameter>'\n",
+        argv[0]);
+    return 1;
+  }
+
+  memset(&binary, 0, sizeof(binary));
+  remote.sin_port = htons(bin_port);
+  if (_run_binary(&binary, &remote, argv[optind], count)) {
+    return 1;
+  }
+  _print_result("binary", &binary, count);
+
+  if (text_port) {
+    memset(&text, 0, sizeof(text));
+    remote.sin_port = htons(text_port);
+    if (_run_text(&text, &remote, argv[optind], count)) {
+      return 1;
+    }
+    _print_result("text", &text, count);
+  }
+  return 0;
+}
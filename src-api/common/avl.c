@@ -47,7 +47,7 @@
 #include "common/list.h"
 #include "common/avl.h"
 
-static struct avl_node *_avl_find_rec(struct avl_node *node,
+static struct avl_node *_avl_find(struct avl_node *node,
     const void *key, avl_tree_comp comp, int *cmp_result);
 static void _avl_insert_before(struct avl_tree *tree,
     struct avl_node *pos_node, struct avl_node *node);
@@ -94,7 +94,7 @@ avl_find(const struct avl_tree *tree, const void *key)
   if (tree->root == NULL)
     return NULL;
 
-  node = _avl_find_rec(tree->root, key, tree->comp, &diff);
+  node = _avl_find(tree->root, key, tree->comp, &diff);
 
   return diff == 0 ? node : NULL;
 }
@@ -115,7 +115,7 @@ avl_find_lessequal(const struct avl_tree *tree, const void *key) {
   if (tree->root == NULL)
     return NULL;
 
-  node = _avl_find_rec(tree->root, key, tree->comp, &diff);
+  node = _avl_find(tree->root, key, tree->comp, &diff);
 
   /* go left as long as key<node.key */
   while (diff < 0) {
@@ -157,7 +157,7 @@ avl_find_greaterequal(const struct avl_tree *tree, const void *key) {
   if (tree->root == NULL)
     return NULL;
 
-  node = _avl_find_rec(tree->root, key, tree->comp, &diff);
+  node = _avl_find(tree->root, key, tree->comp, &diff);
 
   /* go right as long as key>node.key */
   while (diff > 0) {
@@ -211,7 +211,7 @@ avl_insert(struct avl_tree *tree, struct avl_node *new)
     return 0;
   }
 
-  node = _avl_find_rec(tree->root, new->key, tree->comp, &diff);
+  node = _avl_find(tree->root, new->key, tree->comp, &diff);
 
   last = node;
 
@@ -332,27 +332,25 @@ avl_remove(struct avl_tree *tree, struct avl_node *node)
  * @return pointer to result of the lookup (avl_node)
  */
 static struct avl_node *
-_avl_find_rec(struct avl_node *node, const void *key, avl_tree_comp comp, int *cmp_result)
+_avl_find(struct avl_node *node, const void *key, avl_tree_comp comp, int *cmp_result)
 {
   int diff;
 
-  diff = (*comp) (key, node->key);
-  *cmp_result = diff;
-
-  if (diff < 0) {
-    if (node->left != NULL)
-      return _avl_find_rec(node->left, key, comp, cmp_result);
-
-    return node;
-  }
-
-  if (diff > 0) {
-    if (node->right != NULL)
-      return _avl_find_rec(node->right, key, comp, cmp_result);
+  while (true) {
+    diff = (*comp) (key, node->key);
 
-    return node;
+    if (diff < 0 && node->left != NULL) {
+      node = node->left;
+    }
+    else if (diff > 0 && node->right != NULL) {
+      node = node->right;
+    }
+    else {
+      break;
+    }
   }
 
+  *cmp_result = diff;
   return node;
 }
 
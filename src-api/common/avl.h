@@ -63,9 +63,12 @@ struct avl_node {
   struct list_entity list;
 
   /**
-   * Pointer to parent node in tree, NULL if root node
+   * pointer to key of node
+   *
+   * key and child pointers are next to each other because they
+   * are the only fields a lookup touches
    */
-  struct avl_node *parent;
+  const void *key;
 
   /**
    * Pointer to left child
@@ -78,9 +81,9 @@ struct avl_node {
   struct avl_node *right;
 
   /**
-   * pointer to key of node
+   * Pointer to parent node in tree, NULL if root node
    */
-  const void *key;
+  struct avl_node *parent;
 
   /**
    * balance state of AVL tree (0,-1,+1)
@@ -184,6 +187,36 @@ avl_is_node_added(struct avl_node *node) {
   return list_is_node_added(&node->list);
 }
 
+/**
+ * Defines an inline lookup function for a tree with a fixed key type.
+ * The comparison is compiled into the lookup loop instead of calling
+ * the comparator of the tree through a function pointer, so the
+ * comparator must give the same ordering as the one of the tree.
+ *
+ * The generated function has the prototype
+ *   struct avl_node *name(const struct avl_tree *, const key_type *)
+ * and returns the same node as avl_find().
+ *
+ * @param name name of the generated function
+ * @param key_type type of the keys in the tree
+ * @param key_comp comparator for two (const key_type *) pointers,
+ *    returns <0, 0 or >0 like the comparator of the tree
+ */
+#define AVL_DEFINE_TYPED_FIND(name, key_type, key_comp) \
+  static INLINE struct avl_node * \
+  name(const struct avl_tree *tree, const key_type *key) { \
+    struct avl_node *node = tree->root; \
+    int diff; \
+    while (node != NULL) { \
+      diff = key_comp(key, (const key_type *)node->key); \
+      if (diff == 0) { \
+        return node; \
+      } \
+      node = diff < 0 ? node->left : node->right; \
+    } \
+    return NULL; \
+  }
+
 /**
  * Legacy function for code that still use the old avl_delete
  * function instead of the new avl_remove one.
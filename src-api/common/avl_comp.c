@@ -54,16 +54,7 @@
  */
 int
 avl_comp_uint32(const void *k1, const void *k2) {
-  const uint32_t *u1 = k1;
-  const uint32_t *u2 = k2;
-
-  if (*u1 > *u2) {
-    return 1;
-  }
-  if (*u2 > *u1) {
-    return -1;
-  }
-  return 0;
+  return avl_comp_inline_uint32(k1, k2);
 }
 
 /**
@@ -116,9 +107,7 @@ avl_comp_uint8(const void *k1, const void *k2) {
  */
 int
 avl_comp_netaddr(const void *k1, const void *k2) {
-  const struct netaddr *n1 = k1;
-  const struct netaddr *n2 = k2;
-  return memcmp(n1, n2, sizeof(struct netaddr));
+  return avl_comp_inline_netaddr(k1, k2);
 }
 
 /**
@@ -42,7 +42,10 @@
 #ifndef AVL_COMP_H_
 #define AVL_COMP_H_
 
+#include <string.h>
+
 #include "common/common_types.h"
+#include "common/avl.h"
 #include "common/netaddr.h"
 
 EXPORT int avl_comp_uint32(const void *k1, const void *k2);
@@ -52,4 +55,48 @@ EXPORT int avl_comp_netaddr(const void *k1, const void *k2);
 EXPORT int avl_comp_netaddr_socket(const void *k1, const void *k2);
 EXPORT int avl_comp_strcasecmp(const void *, const void *);
 
+/**
+ * Inline comparator for unsigned 32 bit integers,
+ * same ordering as avl_comp_uint32()
+ * @param k1 pointer to key 1
+ * @param k2 pointer to key 2
+ * @return +1 if k1>k2, -1 if k1<k2, 0 if k1==k2
+ */
+static INLINE int
+avl_comp_inline_uint32(const uint32_t *k1, const uint32_t *k2) {
+  return (*k1 > *k2) - (*k1 < *k2);
+}
+
+/**
+ * Inline comparator for netaddr objects,
+ * same ordering as avl_comp_netaddr()
+ * @param k1 pointer to key 1
+ * @param k2 pointer to key 2
+ * @return <0 if k1<k2, >0 if k1>k2, 0 if k1==k2
+ */
+static INLINE int
+avl_comp_inline_netaddr(const struct netaddr *k1, const struct netaddr *k2) {
+  return memcmp(k1, k2, sizeof(*k1));
+}
+
+/*
+ * lookup function for trees that use avl_comp_uint32, avl_find()
+ * does not use it automatically to keep the generic path free of
+ * comparator checks
+ */
+AVL_DEFINE_TYPED_FIND(avl_find_uint32, uint32_t, avl_comp_inline_uint32)
+
+/**
+ * @param tree pointer to avl-tree using avl_comp_uint32
+ * @param key pointer to uint32_t key
+ * @param element pointer to a node element
+ *    (don't need to be initialized)
+ * @param node_element name of the avl_node element inside the
+ *    larger struct
+ * @return pointer to tree element with the specified key,
+ *    NULL if no element was found
+ */
+#define avl_find_uint32_element(tree, key, element, node_element) \
+  container_of_if_notnull(avl_find_uint32(tree, key), typeof(*(element)), node_element)
+
 #endif /* AVL_COMP_H_ */
@@ -0,0 +1,448 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2013, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/common_types.h"
+#include "common/list.h"
+#include "common/netaddr.h"
+#include "common/hash_table.h"
+
+/* FNV-1a parameters */
+#define FNV_OFFSET 2166136261u
+#define FNV_PRIME  16777619u
+
+static struct hash_node *_lookup(struct hash_node **slots, uint32_t size,
+    hash_table_comp comp, const void *key, uint32_t hash);
+static int _lookup_node(struct hash_node **slots, uint32_t size,
+    struct hash_node *node);
+static void _put(struct hash_node **slots, uint32_t size, struct hash_node *node);
+static void _delete_slot(struct hash_node **slots, uint32_t size, uint32_t idx);
+static int _reserve(struct hash_table *);
+static void _rehash_step(struct hash_table *, uint32_t steps);
+static void _free_old_slots(struct hash_table *);
+static uint32_t _mix(uint32_t hash);
+
+/* marker for removed and migrated slots in the old slot array */
+static struct hash_node _tombstone;
+
+/**
+ * Initialize a new hash table
+ * @param table pointer to hash table
+ * @param hash hash function for the keys of the table
+ * @param comp comparator for the keys of the table
+ */
+void
+hash_table_init(struct hash_table *table, hash_table_hash hash, hash_table_comp comp) {
+  memset(table, 0, sizeof(*table));
+  list_init_head(&table->list_head);
+  table->hash = hash;
+  table->comp = comp;
+}
+
+/**
+ * Remove all nodes from a hash table and release its memory.
+ * The nodes themselves are not touched except for their list
+ * membership.
+ * @param table pointer to hash table
+ */
+void
+hash_table_free(struct hash_table *table) {
+  struct hash_node *node, *ptr;
+
+  list_for_each_element_safe(&table->list_head, node, list, ptr) {
+    list_remove(&node->list);
+  }
+
+  _free_old_slots(table);
+  free(table->_slots);
+  table->_slots = NULL;
+  table->_size = 0;
+  table->count = 0;
+}
+
+/**
+ * Finds a node in a hash table with a certain key
+ * @param table pointer to hash table
+ * @param key pointer to key
+ * @return pointer to hash node with key, NULL if no node with
+ *    this key exists
+ */
+struct hash_node *
+hash_table_find(const struct hash_table *table, const void *key) {
+  struct hash_node *node;
+  uint32_t hash;
+
+  if (table->count == 0) {
+    return NULL;
+  }
+
+  hash = table->hash(key);
+
+  node = _lookup(table->_slots, table->_size, table->comp, key, hash);
+  if (node == NULL) {
+    node = _lookup(table->_old_slots, table->_old_size, table->comp, key, hash);
+  }
+  return node;
+}
+
+/**
+ * Inserts a hash node into a table. If the table grows, the existing
+ * nodes are migrated into the larger slot array step by step during
+ * the following inserts and removals.
+ * @param table pointer to hash table
+ * @param node pointer to node, the key must be set
+ * @return -1 if the key is already in the table or an out of
+ *    memory error happened, 0 otherwise
+ */
+int
+hash_table_insert(struct hash_table *table, struct hash_node *node) {
+  node->hash = table->hash(node->key);
+
+  if (_lookup(table->_slots, table->_size, table->comp, node->key, node->hash) != NULL
+      || _lookup(table->_old_slots, table->_old_size, table->comp, node->key, node->hash) != NULL) {
+    return -1;
+  }
+
+  if (_reserve(table)) {
+    return -1;
+  }
+
+  _put(table->_slots, table->_size, node);
+
+  list_add_tail(&table->list_head, &node->list);
+  table->count++;
+
+  _rehash_step(table, HASH_TABLE_REHASH_STEP);
+  return 0;
+}
+
+/**
+ * Make sure the next insert into a hash table cannot fail because
+ * of an out of memory error. This allows to prepare an insert
+ * before an action that cannot be undone.
+ * @param table pointer to hash table
+ * @return -1 if an out of memory error happened, 0 otherwise
+ */
+int
+hash_table_reserve(struct hash_table *table) {
+  return _reserve(table);
+}
+
+/**
+ * Remove a node from a hash table. The memory of the table is
+ * released when its last node is removed.
+ * @param table pointer to hash table
+ * @param node pointer to node
+ */
+void
+hash_table_remove(struct hash_table *table, struct hash_node *node) {
+  int idx;
+
+  idx = _lookup_node(table->_slots, table->_size, node);
+  if (idx != -1) {
+    _delete_slot(table->_slots, table->_size, idx);
+  }
+  else {
+    idx = _lookup_node(table->_old_slots, table->_old_size, node);
+    if (idx == -1) {
+      /* node is not part of this table */
+      return;
+    }
+
+    /* keep probe sequences of the old slots intact */
+    table->_old_slots[idx] = &_tombstone;
+    table->_old_count--;
+  }
+
+  list_remove(&node->list);
+  table->count--;
+
+  if (table->count == 0) {
+    hash_table_free(table);
+  }
+  else {
+    _rehash_step(table, HASH_TABLE_REHASH_STEP);
+  }
+}
+
+/**
+ * Hash function for unsigned 32 bit integers
+ * @param key pointer to integer
+ * @return hash value
+ */
+uint32_t
+hash_table_hash_uint32(const void *key) {
+  const uint32_t *u32 = key;
+
+  return _mix(*u32);
+}
+
+/**
+ * Hash function for netaddr objects, compatible with avl_comp_netaddr()
+ * @param key pointer to netaddr
+ * @return hash value
+ */
+uint32_t
+hash_table_hash_netaddr(const void *key) {
+  const uint8_t *ptr = key;
+  uint32_t hash;
+  size_t i;
+
+  hash = FNV_OFFSET;
+  for (i=0; i<sizeof(struct netaddr); i++) {
+    hash = (hash ^ ptr[i]) * FNV_PRIME;
+  }
+  return _mix(hash);
+}
+
+/**
+ * Case insensitive hash function for strings, compatible with
+ * avl_comp_strcasecmp()
+ * @param key pointer to zero terminated string
+ * @return hash value
+ */
+uint32_t
+hash_table_hash_strcase(const void *key) {
+  const unsigned char *ptr;
+  uint32_t hash;
+
+  hash = FNV_OFFSET;
+  for (ptr = key; *ptr; ptr++) {
+    hash = (hash ^ (uint32_t)tolower(*ptr)) * FNV_PRIME;
+  }
+  return _mix(hash);
+}
+
+/**
+ * Lookup a key in a slot array
+ * @param slots pointer to slot array
+ * @param size number of slots
+ * @param comp key comparator
+ * @param key pointer to key
+ * @param hash hash value of key
+ * @return pointer to node, NULL if not found
+ */
+static struct hash_node *
+_lookup(struct hash_node **slots, uint32_t size,
+    hash_table_comp comp, const void *key, uint32_t hash) {
+  struct hash_node *node;
+  uint32_t i, idx;
+
+  for (i=0, idx = hash & (size-1); i<size; i++, idx = (idx+1) & (size-1)) {
+    node = slots[idx];
+    if (node == NULL) {
+      return NULL;
+    }
+    if (node != &_tombstone && node->hash == hash && comp(node->key, key) == 0) {
+      return node;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Lookup the slot of a node in a slot array
+ * @param slots pointer to slot array
+ * @param size number of slots
+ * @param node pointer to node
+ * @return index of slot, -1 if not found
+ */
+static int
+_lookup_node(struct hash_node **slots, uint32_t size, struct hash_node *node) {
+  uint32_t i, idx;
+
+  for (i=0, idx = node->hash & (size-1); i<size; i++, idx = (idx+1) & (size-1)) {
+    if (slots[idx] == NULL) {
+      return -1;
+    }
+    if (slots[idx] == node) {
+      return (int)idx;
+    }
+  }
+  return -1;
+}
+
+/**
+ * Put a node into the first free slot of its probe sequence.
+ * The slot array must not be full.
+ * @param slots pointer to slot array
+ * @param size number of slots
+ * @param node pointer to node
+ */
+static void
+_put(struct hash_node **slots, uint32_t size, struct hash_node *node) {
+  uint32_t idx;
+
+  idx = node->hash & (size-1);
+  while (slots[idx] != NULL) {
+    idx = (idx+1) & (size-1);
+  }
+  slots[idx] = node;
+}
+
+/**
+ * Clear a slot and move the following nodes of the cluster
+ * back so that no probe sequence is interrupted.
+ * @param slots pointer to slot array
+ * @param size number of slots
+ * @param idx index of slot to clear
+ */
+static void
+_delete_slot(struct hash_node **slots, uint32_t size, uint32_t idx) {
+  uint32_t next, home;
+
+  next = idx;
+  while (true) {
+    next = (next+1) & (size-1);
+    if (slots[next] == NULL) {
+      break;
+    }
+
+    home = slots[next]->hash & (size-1);
+
+    /* move node if its home slot is not between the hole and its position */
+    if ((idx <= next) ? (home <= idx || home > next) : (home <= idx && home > next)) {
+      slots[idx] = slots[next];
+      idx = next;
+    }
+  }
+  slots[idx] = NULL;
+}
+
+/**
+ * Make sure the current slot array has room for one more node.
+ * Starts a rehash into a twice as large slot array if the load
+ * factor would exceed 50%.
+ * @param table pointer to hash table
+ * @return -1 if an out of memory error happened, 0 otherwise
+ */
+static int
+_reserve(struct hash_table *table) {
+  struct hash_node **slots;
+  uint32_t size;
+
+  if ((table->count + 1) * 2 <= table->_size) {
+    return 0;
+  }
+
+  /* finish the last rehash before starting a new one */
+  _rehash_step(table, table->_old_size);
+
+  size = table->_size == 0 ? HASH_TABLE_MIN_SIZE : table->_size * 2;
+  slots = calloc(size, sizeof(*slots));
+  if (slots == NULL) {
+    /* keep using the current slots as long as there is room */
+    return table->count + 1 < table->_size ? 0 : -1;
+  }
+
+  if (table->count > 0) {
+    table->_old_slots = table->_slots;
+    table->_old_size = table->_size;
+    table->_old_count = table->count;
+    table->_rehash_pos = 0;
+  }
+  else {
+    free(table->_slots);
+  }
+
+  table->_slots = slots;
+  table->_size = size;
+  return 0;
+}
+
+/**
+ * Migrate nodes from the old slot array into the current one
+ * @param table pointer to hash table
+ * @param steps number of old slots to migrate
+ */
+static void
+_rehash_step(struct hash_table *table, uint32_t steps) {
+  struct hash_node *node;
+
+  while (table->_old_slots != NULL && steps > 0) {
+    node = table->_old_slots[table->_rehash_pos];
+    if (node != NULL && node != &_tombstone) {
+      _put(table->_slots, table->_size, node);
+      table->_old_slots[table->_rehash_pos] = &_tombstone;
+      table->_old_count--;
+    }
+    table->_rehash_pos++;
+    steps--;
+
+    if (table->_old_count == 0 || table->_rehash_pos >= table->_old_size) {
+      _free_old_slots(table);
+    }
+  }
+}
+
+/**
+ * Release the old slot array of a rehash
+ * @param table pointer to hash table
+ */
+static void
+_free_old_slots(struct hash_table *table) {
+  free(table->_old_slots);
+  table->_old_slots = NULL;
+  table->_old_size = 0;
+  table->_old_count = 0;
+  table->_rehash_pos = 0;
+}
+
+/**
+ * Final mixing step for hash values (murmur3 finalizer), spreads
+ * the entropy into the lower bits used to select a slot.
+ * @param hash hash value
+ * @return mixed hash value
+ */
+static uint32_t
+_mix(uint32_t hash) {
+  hash ^= hash >> 16;
+  hash *= 0x85ebca6bu;
+  hash ^= hash >> 13;
+  hash *= 0xc2b2ae35u;
+  hash ^= hash >> 16;
+  return hash;
+}
@@ -0,0 +1,248 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2013, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+#ifndef HASH_TABLE_H_
+#define HASH_TABLE_H_
+
+#include <stddef.h>
+
+#include "common/common_types.h"
+#include "common/list.h"
+#include "common/container_of.h"
+
+/* minimum number of slots of a hash table */
+#define HASH_TABLE_MIN_SIZE 16
+
+/* number of old slots migrated by each insert/remove during a rehash */
+#define HASH_TABLE_REHASH_STEP 4
+
+/**
+ * This element is a member of a hash table. It must be contained in all
+ * larger structs that should be put into a hash table.
+ */
+struct hash_node {
+  /**
+   * Linked list node for supporting easy iteration in insertion order
+   */
+  struct list_entity list;
+
+  /**
+   * pointer to key of node, must be set before the node is inserted
+   * and must not change while it is in the table
+   */
+  const void *key;
+
+  /**
+   * cached hash value of the key
+   */
+  uint32_t hash;
+};
+
+/**
+ * Prototype for hash functions
+ * @param key pointer to key
+ * @return 32 bit hash value of the key
+ */
+typedef uint32_t (*hash_table_hash) (const void *key);
+
+/**
+ * Prototype for key comparators, compatible with the avl tree
+ * comparators. Only equality (return value 0) is used.
+ * @param k1 first key
+ * @param k2 second key
+ * @return 0 if keys are equal, non-zero otherwise
+ */
+typedef int (*hash_table_comp) (const void *k1, const void *k2);
+
+/**
+ * This struct is the central management part of a hash table.
+ * One of them is necessary for each table.
+ */
+struct hash_table {
+  /**
+   * Head of linked list node for supporting easy iteration
+   */
+  struct list_entity list_head;
+
+  /**
+   * number of nodes in the table
+   */
+  uint32_t count;
+
+  /**
+   * hash function for keys
+   */
+  hash_table_hash hash;
+
+  /**
+   * comparator for keys
+   */
+  hash_table_comp comp;
+
+  /* open addressing slot array, size is a power of two */
+  struct hash_node **_slots;
+  uint32_t _size;
+
+  /* slot array that is migrated into the current one during a rehash */
+  struct hash_node **_old_slots;
+  uint32_t _old_size;
+  uint32_t _old_count;
+  uint32_t _rehash_pos;
+};
+
+EXPORT void hash_table_init(struct hash_table *, hash_table_hash, hash_table_comp);
+EXPORT void hash_table_free(struct hash_table *);
+EXPORT struct hash_node *hash_table_find(const struct hash_table *, const void *);
+EXPORT int hash_table_insert(struct hash_table *, struct hash_node *);
+EXPORT int hash_table_reserve(struct hash_table *);
+EXPORT void hash_table_remove(struct hash_table *, struct hash_node *);
+
+EXPORT uint32_t hash_table_hash_uint32(const void *key);
+EXPORT uint32_t hash_table_hash_netaddr(const void *key);
+EXPORT uint32_t hash_table_hash_strcase(const void *key);
+
+/**
+ * @param table pointer to hash table
+ * @return true if the table is empty, false otherwise
+ */
+static INLINE bool
+hash_table_is_empty(struct hash_table *table) {
+  return table->count == 0;
+}
+
+/**
+ * @param node pointer to hash node
+ * @return true if node is currently in a table, false otherwise
+ */
+static INLINE bool
+hash_table_is_node_added(struct hash_node *node) {
+  return list_is_node_added(&node->list);
+}
+
+/**
+ * @param table pointer to hash table
+ * @param key pointer to key
+ * @param element pointer to a node element
+ *    (don't need to be initialized)
+ * @param node_element name of the hash_node element inside the
+ *    larger struct
+ * @return pointer to table element with the specified key,
+ *    NULL if no element was found
+ */
+#define hash_table_find_element(table, key, element, node_element) \
+  container_of_if_notnull(hash_table_find(table, key), typeof(*(element)), node_element)
+
+/**
+ * This function must not be called for an empty table
+ *
+ * @param table pointer to hash table
+ * @param element pointer to a node element
+ *    (don't need to be initialized)
+ * @param node_member name of the hash_node element inside the
+ *    larger struct
+ * @return pointer to the first element of the table
+ *    (automatically converted to type 'element')
+ */
+#define hash_table_first_element(table, element, node_member) \
+  list_first_element(&(table)->list_head, element, node_member.list)
+
+/**
+ * This function must not be called for an empty table
+ *
+ * @param table pointer to hash table
+ * @param element pointer to a node element
+ *    (don't need to be initialized)
+ * @param node_member name of the hash_node element inside the
+ *    larger struct
+ * @return pointer to the last element of the table
+ *    (automatically converted to type 'element')
+ */
+#define hash_table_last_element(table, element, node_member) \
+  list_last_element(&(table)->list_head, element, node_member.list)
+
+/**
+ * This function must not be called for the last element of
+ * a hash table
+ *
+ * @param element pointer to a node of the table
+ * @param node_member name of the hash_node element inside the
+ *    larger struct
+ * @return pointer to the node after 'element'
+ *    (automatically converted to type 'element')
+ */
+#define hash_table_next_element(element, node_member) \
+  list_next_element(element, node_member.list)
+
+/**
+ * Loop over all elements of a hash table in insertion order,
+ * used similar to a for() command.
+ * This loop should not be used if elements are removed from the table
+ * during the loop.
+ *
+ * @param table pointer to hash table
+ * @param element pointer to a node of the table, this element will
+ *    contain the current node of the table during the loop
+ * @param node_member name of the hash_node element inside the
+ *    larger struct
+ */
+#define hash_table_for_each_element(table, element, node_member) \
+  list_for_each_element(&(table)->list_head, element, node_member.list)
+
+/**
+ * Loop over all elements of a hash table in insertion order,
+ * used similar to a for() command.
+ * This loop can be used if the current element might be removed from
+ * the table during the loop. Other elements should not be removed during
+ * the loop.
+ *
+ * @param table pointer to hash table
+ * @param element pointer to a node of the table, this element will
+ *    contain the current node of the table during the loop
+ * @param node_member name of the hash_node element inside the
+ *    larger struct
+ * @param ptr pointer to a node of the table, used to store
+ *    the next node during the loop
+ */
+#define hash_table_for_each_element_safe(table, element, node_member, ptr) \
+  list_for_each_element_safe(&(table)->list_head, element, node_member.list, ptr)
+
+#endif /* HASH_TABLE_H_ */
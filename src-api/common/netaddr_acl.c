@@ -45,6 +45,17 @@
 #include "common/string.h"
 
 static bool _is_in_array(const struct netaddr *, size_t, const struct netaddr *);
+static int _compile(struct netaddr_acl *acl);
+static int _insert(struct netaddr_acl *acl, int32_t *ref,
+    const struct netaddr *prefix, bool accept);
+static int32_t _new_node(struct netaddr_acl *acl,
+    const struct netaddr *prefix, uint8_t prefix_len);
+static int _get_family_index(const struct netaddr *addr);
+static int _get_bit(const struct netaddr *addr, uint8_t bit);
+static uint8_t _get_common_prefix(const struct netaddr *a1,
+    const struct netaddr *a2, uint8_t max_len);
+static void _lookup(const struct netaddr_acl *acl, const struct netaddr *addr,
+    bool *accept, bool *reject);
 
 /**
  * Initialize an ACL object. It will contain no addresses on both
@@ -64,6 +75,7 @@ void
 netaddr_acl_remove(struct netaddr_acl *acl) {
   free(acl->accept);
   free(acl->reject);
+  free(acl->_trie);
 
   memset(acl, 0, sizeof(*acl));
 }
@@ -138,6 +150,10 @@ netaddr_acl_from_strarray(struct netaddr_acl *acl,
       acl->accept_count++;
     }
   }
+
+  if (_compile(acl)) {
+    goto from_entry_error;
+  }
   return 0;
 
 from_entry_error:
@@ -156,6 +172,11 @@ netaddr_acl_copy(struct netaddr_acl *to, const struct netaddr_acl *from) {
   netaddr_acl_remove(to);
   memcpy(to, from, sizeof(*to));
 
+  /* arrays are not shared between the ACLs */
+  to->accept = NULL;
+  to->reject = NULL;
+  to->_trie = NULL;
+
   if (to->accept_count) {
     to->accept = calloc(to->accept_count, sizeof(struct netaddr));
     if (to->accept == NULL) {
@@ -171,6 +192,17 @@ netaddr_acl_copy(struct netaddr_acl *to, const struct netaddr_acl *from) {
     }
     memcpy(to->reject, from->reject, to->reject_count * sizeof(struct netaddr));
   }
+
+  if (from->_trie == NULL) {
+    /* source ACL has been created without trie */
+    return _compile(to);
+  }
+
+  to->_trie = calloc(from->_trie_count, sizeof(struct netaddr_acl_node));
+  if (to->_trie == NULL) {
+    return -1;
+  }
+  memcpy(to->_trie, from->_trie, from->_trie_count * sizeof(struct netaddr_acl_node));
   return 0;
 }
 
@@ -182,6 +214,23 @@ netaddr_acl_copy(struct netaddr_acl *to, const struct netaddr_acl *from) {
  */
 bool
 netaddr_acl_check_accept(const struct netaddr_acl *acl, const struct netaddr *addr) {
+  bool accept, reject;
+
+  if (acl->_trie != NULL) {
+    _lookup(acl, addr, &accept, &reject);
+
+    if (acl->reject_first && reject) {
+      return false;
+    }
+    if (accept) {
+      return true;
+    }
+    if (reject) {
+      return false;
+    }
+    return acl->accept_default;
+  }
+
   if (acl->reject_first) {
     if (_is_in_array(acl->reject, acl->reject_count, addr)) {
       return false;
@@ -247,3 +296,265 @@ _is_in_array(const struct netaddr *array, size_t length, const struct netaddr *a
   }
   return false;
 }
+
+/**
+ * Build the prefix trie for the accept and reject arrays of an ACL.
+ * Small ACLs and entries of address families without trie support
+ * leave the ACL without trie, which will be checked linearly.
+ * @param acl pointer to ACL
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_compile(struct netaddr_acl *acl) {
+  size_t i;
+  int j;
+
+  free(acl->_trie);
+  acl->_trie = NULL;
+  acl->_trie_count = 0;
+
+  for (j=0; j<NETADDR_ACL_TRIE_FAMILIES; j++) {
+    acl->_trie_root[j] = -1;
+  }
+
+  if (acl->accept_count + acl->reject_count < NETADDR_ACL_TRIE_MIN_ENTRIES) {
+    /* scanning a few entries is faster than walking the trie */
+    return 0;
+  }
+
+  for (i=0; i<acl->accept_count; i++) {
+    if (_get_family_index(&acl->accept[i]) == -1) {
+      return 0;
+    }
+  }
+  for (i=0; i<acl->reject_count; i++) {
+    if (_get_family_index(&acl->reject[i]) == -1) {
+      return 0;
+    }
+  }
+
+  /* a path compressed trie has less than two nodes per entry */
+  acl->_trie = calloc(2 * (acl->accept_count + acl->reject_count) + 1,
+      sizeof(struct netaddr_acl_node));
+  if (acl->_trie == NULL) {
+    return -1;
+  }
+
+  for (i=0; i<acl->accept_count; i++) {
+    if (_insert(acl, &acl->_trie_root[_get_family_index(&acl->accept[i])],
+        &acl->accept[i], true)) {
+      return -1;
+    }
+  }
+  for (i=0; i<acl->reject_count; i++) {
+    if (_insert(acl, &acl->_trie_root[_get_family_index(&acl->reject[i])],
+        &acl->reject[i], false)) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Insert a prefix into the subtrie of an ACL
+ * @param acl pointer to ACL
+ * @param ref pointer to the reference of the subtrie
+ * @param prefix pointer to prefix
+ * @param accept true if prefix is part of the accept array,
+ *   false if it is part of the reject array
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_insert(struct netaddr_acl *acl, int32_t *ref,
+    const struct netaddr *prefix, bool accept) {
+  struct netaddr_acl_node *node;
+  uint8_t node_len, prefix_len, common;
+  int32_t idx, glue;
+
+  prefix_len = netaddr_get_prefix_length(prefix);
+
+  while (*ref != -1) {
+    node = &acl->_trie[*ref];
+    node_len = netaddr_get_prefix_length(&node->prefix);
+
+    common = _get_common_prefix(&node->prefix, prefix,
+        node_len < prefix_len ? node_len : prefix_len);
+
+    if (common == node_len && common == prefix_len) {
+      /* prefix is already in the trie */
+      break;
+    }
+    if (common == node_len) {
+      /* prefix is below this node */
+      ref = &node->child[_get_bit(prefix, node_len)];
+      continue;
+    }
+
+    if (common == prefix_len) {
+      /* prefix is above this node */
+      idx = _new_node(acl, prefix, prefix_len);
+      if (idx == -1) {
+        return -1;
+      }
+      acl->_trie[idx].child[_get_bit(&acl->_trie[*ref].prefix, prefix_len)] = *ref;
+      *ref = idx;
+      break;
+    }
+
+    /* prefix and node only share a part, add node for common prefix */
+    glue = _new_node(acl, prefix, common);
+    idx = _new_node(acl, prefix, prefix_len);
+    if (glue == -1 || idx == -1) {
+      return -1;
+    }
+    acl->_trie[glue].child[_get_bit(prefix, common)] = idx;
+    acl->_trie[glue].child[_get_bit(&acl->_trie[*ref].prefix, common)] = *ref;
+    *ref = glue;
+    ref = &acl->_trie[glue].child[_get_bit(prefix, common)];
+    break;
+  }
+
+  if (*ref == -1) {
+    *ref = _new_node(acl, prefix, prefix_len);
+    if (*ref == -1) {
+      return -1;
+    }
+  }
+
+  if (accept) {
+    acl->_trie[*ref].accept = true;
+  }
+  else {
+    acl->_trie[*ref].reject = true;
+  }
+  return 0;
+}
+
+/**
+ * Allocate a new node from the node array of an ACL
+ * @param acl pointer to ACL
+ * @param prefix pointer to prefix of node
+ * @param prefix_len prefix length of node
+ * @return index of node, -1 if the array is full
+ */
+static int32_t
+_new_node(struct netaddr_acl *acl,
+    const struct netaddr *prefix, uint8_t prefix_len) {
+  struct netaddr_acl_node *node;
+
+  if (acl->_trie_count >= 2 * (acl->accept_count + acl->reject_count) + 1) {
+    return -1;
+  }
+
+  node = &acl->_trie[acl->_trie_count];
+  memcpy(&node->prefix, prefix, sizeof(*prefix));
+  netaddr_set_prefix_length(&node->prefix, prefix_len);
+  node->child[0] = -1;
+  node->child[1] = -1;
+
+  return acl->_trie_count++;
+}
+
+/**
+ * Check which kind of entries of an ACL contain an address
+ * @param acl pointer to ACL with trie
+ * @param addr pointer to address
+ * @param accept will be set to true if address is in the accept array
+ * @param reject will be set to true if address is in the reject array
+ */
+static void
+_lookup(const struct netaddr_acl *acl, const struct netaddr *addr,
+    bool *accept, bool *reject) {
+  const struct netaddr_acl_node *node;
+  uint8_t prefix_len;
+  int32_t idx;
+  int family;
+
+  *accept = false;
+  *reject = false;
+
+  family = _get_family_index(addr);
+  if (family == -1) {
+    return;
+  }
+
+  idx = acl->_trie_root[family];
+  while (idx != -1) {
+    node = &acl->_trie[idx];
+    if (!netaddr_is_in_subnet(&node->prefix, addr)) {
+      return;
+    }
+
+    *accept |= node->accept;
+    *reject |= node->reject;
+
+    prefix_len = netaddr_get_prefix_length(&node->prefix);
+    if (prefix_len >= netaddr_get_maxprefix(addr)) {
+      return;
+    }
+    idx = node->child[_get_bit(addr, prefix_len)];
+  }
+}
+
+/**
+ * @param addr pointer to address
+ * @return index of the address family trie, -1 if not supported
+ */
+static int
+_get_family_index(const struct netaddr *addr) {
+  switch (netaddr_get_address_family(addr)) {
+    case AF_INET:
+      return 0;
+    case AF_INET6:
+      return 1;
+    case AF_MAC48:
+      return 2;
+    case AF_EUI64:
+      return 3;
+    default:
+      return -1;
+  }
+}
+
+/**
+ * @param addr pointer to address
+ * @param bit index of bit, 0 is the most significant bit
+ * @return value of bit
+ */
+static int
+_get_bit(const struct netaddr *addr, uint8_t bit) {
+  const uint8_t *bin;
+
+  bin = netaddr_get_binptr(addr);
+  return (bin[bit / 8] >> (7 - (bit % 8))) & 1;
+}
+
+/**
+ * @param a1 pointer to first address
+ * @param a2 pointer to second address
+ * @param max_len maximum number of bits to compare
+ * @return number of leading bits both addresses have in common
+ */
+static uint8_t
+_get_common_prefix(const struct netaddr *a1,
+    const struct netaddr *a2, uint8_t max_len) {
+  const uint8_t *b1, *b2;
+  unsigned len;
+  uint8_t diff;
+
+  b1 = netaddr_get_binptr(a1);
+  b2 = netaddr_get_binptr(a2);
+
+  /* compare whole bytes */
+  for (len = 0; len + 8 <= max_len && b1[len/8] == b2[len/8]; len += 8);
+
+  if (len < max_len) {
+    /* find first different bit */
+    diff = b1[len/8] ^ b2[len/8];
+    while (len < max_len && (diff & 0x80) == 0) {
+      diff <<= 1;
+      len++;
+    }
+  }
+  return len;
+}
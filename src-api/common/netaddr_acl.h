@@ -57,6 +57,24 @@
 #define ACL_DEFAULT_ACCEPT "default_accept"
 #define ACL_DEFAULT_REJECT "default_reject"
 
+/* number of address families with a compiled prefix trie */
+#define NETADDR_ACL_TRIE_FAMILIES 4
+
+/* minimum number of accept and reject entries for a compiled trie */
+#define NETADDR_ACL_TRIE_MIN_ENTRIES 8
+
+/* node of the compiled prefix trie of an ACL */
+struct netaddr_acl_node {
+  /* common prefix of all entries below this node */
+  struct netaddr prefix;
+
+  /* true if the prefix is an entry of the accept/reject array */
+  bool accept, reject;
+
+  /* index of the child nodes for the next prefix bit, -1 if none */
+  int32_t child[2];
+};
+
 /* represents an netaddr access control list with white/blacklist */
 struct netaddr_acl {
   /* array of prefixes that will be accepted by the ACL */
@@ -75,6 +93,17 @@ struct netaddr_acl {
 
   /* result of the check if neither of the arrays have a match */
   bool accept_default;
+
+  /*
+   * compiled prefix trie of both arrays, NULL if the ACL was not
+   * created by netaddr_acl_from_strarray() or netaddr_acl_copy()
+   * or has less than NETADDR_ACL_TRIE_MIN_ENTRIES entries
+   */
+  struct netaddr_acl_node *_trie;
+  size_t _trie_count;
+
+  /* index of the trie root for each address family, -1 if empty */
+  int32_t _trie_root[NETADDR_ACL_TRIE_FAMILIES];
 };
 
 EXPORT void netaddr_acl_add(struct netaddr_acl *);
@@ -0,0 +1,630 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2013, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/common_types.h"
+#include "common/container_of.h"
+#include "common/netaddr.h"
+#include "common/netaddr_trie.h"
+
+/* internal node of the trie with storage for its prefix */
+struct _trie_glue {
+  struct netaddr_trie_node node;
+
+  struct netaddr prefix;
+};
+
+/* block of internal nodes allocated at once */
+struct _trie_glue_block {
+  struct _trie_glue_block *next;
+
+  struct _trie_glue glue[];
+};
+
+static struct netaddr_trie_node **_get_ref(
+    struct netaddr_trie *, struct netaddr_trie_node *);
+static struct netaddr_trie_node *_pop_glue(
+    struct netaddr_trie *, const struct netaddr *prefix, uint8_t prefix_len);
+static void _push_glue(struct netaddr_trie *, struct netaddr_trie_node *);
+static int _reserve_glue(struct netaddr_trie *);
+static void _free_glue(struct netaddr_trie *);
+static struct netaddr_trie_node *_get_next(const struct netaddr_trie_node *);
+static bool _is_in_prefix(const struct netaddr *prefix, const struct netaddr *addr);
+static int _get_family_index(const struct netaddr *addr);
+static int _get_bit(const struct netaddr *addr, uint8_t bit);
+static uint8_t _get_common_prefix(const struct netaddr *a1,
+    const struct netaddr *a2, uint8_t max_len);
+
+/**
+ * Initialize a new prefix trie
+ * @param trie pointer to prefix trie
+ */
+void
+netaddr_trie_init(struct netaddr_trie *trie) {
+  memset(trie, 0, sizeof(*trie));
+}
+
+/**
+ * Insert a node into a prefix trie
+ * @param trie pointer to prefix trie
+ * @param node pointer to node, the key must be set
+ * @return -1 if the prefix is already in the trie, the address
+ *   family is not supported or an out of memory error happened,
+ *   0 otherwise
+ */
+int
+netaddr_trie_insert(struct netaddr_trie *trie, struct netaddr_trie_node *node) {
+  struct netaddr_trie_node **ref, *parent, *cur, *glue;
+  uint8_t len, cur_len, common;
+  int family;
+
+  family = _get_family_index(node->key);
+  if (family == -1) {
+    return -1;
+  }
+
+  /* reserve the internal node for removing this node later */
+  if (_reserve_glue(trie)) {
+    return -1;
+  }
+
+  node->parent = NULL;
+  node->child[0] = NULL;
+  node->child[1] = NULL;
+  node->_glue = false;
+
+  len = netaddr_get_prefix_length(node->key);
+  parent = NULL;
+  ref = &trie->root[family];
+
+  while (*ref != NULL) {
+    cur = *ref;
+    cur_len = netaddr_get_prefix_length(cur->key);
+
+    common = _get_common_prefix(cur->key, node->key, cur_len < len ? cur_len : len);
+
+    if (common == cur_len && common == len) {
+      if (!cur->_glue) {
+        /* prefix is already in the trie */
+        return -1;
+      }
+
+      /* replace internal node */
+      node->parent = cur->parent;
+      node->child[0] = cur->child[0];
+      node->child[1] = cur->child[1];
+      node->child[0]->parent = node;
+      node->child[1]->parent = node;
+      *ref = node;
+
+      _push_glue(trie, cur);
+      trie->count++;
+      return 0;
+    }
+
+    if (common == cur_len) {
+      /* node is below the current one */
+      parent = cur;
+      ref = &cur->child[_get_bit(node->key, cur_len)];
+      continue;
+    }
+
+    if (common == len) {
+      /* node is above the current one */
+      node->child[_get_bit(cur->key, len)] = cur;
+    }
+    else {
+      /* both share a part of the prefix, add internal node for it */
+      glue = _pop_glue(trie, node->key, common);
+      glue->child[_get_bit(node->key, common)] = node;
+      glue->child[_get_bit(cur->key, common)] = cur;
+      glue->parent = parent;
+      node->parent = glue;
+
+      cur->parent = glue;
+      *ref = glue;
+      trie->count++;
+      return 0;
+    }
+
+    cur->parent = node;
+    break;
+  }
+
+  node->parent = parent;
+  *ref = node;
+  trie->count++;
+  return 0;
+}
+
+/**
+ * Remove a node from a prefix trie
+ * @param trie pointer to prefix trie
+ * @param node pointer to node
+ */
+void
+netaddr_trie_remove(struct netaddr_trie *trie, struct netaddr_trie_node *node) {
+  struct netaddr_trie_node **ref, *parent, *child, *glue;
+
+  ref = _get_ref(trie, node);
+  parent = node->parent;
+
+  if (node->child[0] != NULL && node->child[1] != NULL) {
+    /* node is still necessary to split the trie */
+    glue = _pop_glue(trie, node->key, netaddr_get_prefix_length(node->key));
+    glue->parent = parent;
+    glue->child[0] = node->child[0];
+    glue->child[1] = node->child[1];
+    glue->child[0]->parent = glue;
+    glue->child[1]->parent = glue;
+    *ref = glue;
+  }
+  else {
+    child = node->child[0] != NULL ? node->child[0] : node->child[1];
+
+    *ref = child;
+    if (child != NULL) {
+      child->parent = parent;
+    }
+    else if (parent != NULL && parent->_glue) {
+      /* internal node is not necessary anymore */
+      child = parent->child[0] != NULL ? parent->child[0] : parent->child[1];
+
+      ref = _get_ref(trie, parent);
+      *ref = child;
+      child->parent = parent->parent;
+
+      _push_glue(trie, parent);
+    }
+  }
+
+  node->parent = NULL;
+  node->child[0] = NULL;
+  node->child[1] = NULL;
+  trie->count--;
+
+  if (trie->count == 0) {
+    /* all internal nodes are unused now */
+    _free_glue(trie);
+  }
+}
+
+/**
+ * Find a node with a specific prefix
+ * @param trie pointer to prefix trie
+ * @param prefix pointer to prefix
+ * @return pointer to node with the same prefix, NULL if not found
+ */
+struct netaddr_trie_node *
+netaddr_trie_find(const struct netaddr_trie *trie, const struct netaddr *prefix) {
+  struct netaddr_trie_node *cur;
+  uint8_t len, cur_len;
+  int family;
+
+  family = _get_family_index(prefix);
+  if (family == -1) {
+    return NULL;
+  }
+
+  len = netaddr_get_prefix_length(prefix);
+  cur = trie->root[family];
+
+  while (cur != NULL) {
+    cur_len = netaddr_get_prefix_length(cur->key);
+    if (cur_len > len || !netaddr_is_in_subnet(cur->key, prefix)) {
+      return NULL;
+    }
+    if (cur_len == len) {
+      return cur->_glue ? NULL : cur;
+    }
+    cur = cur->child[_get_bit(prefix, cur_len)];
+  }
+  return NULL;
+}
+
+/**
+ * Find the longest prefix that contains an address or prefix
+ * @param trie pointer to prefix trie
+ * @param addr pointer to address or prefix
+ * @return pointer to node with the longest matching prefix,
+ *   NULL if not found
+ */
+struct netaddr_trie_node *
+netaddr_trie_find_lpm(const struct netaddr_trie *trie, const struct netaddr *addr) {
+  struct netaddr_trie_node *cur, *best;
+  uint8_t len, cur_len;
+  int family;
+
+  family = _get_family_index(addr);
+  if (family == -1) {
+    return NULL;
+  }
+
+  len = netaddr_get_prefix_length(addr);
+  cur = trie->root[family];
+  best = NULL;
+
+  while (cur != NULL) {
+    cur_len = netaddr_get_prefix_length(cur->key);
+    if (cur_len > len || !netaddr_is_in_subnet(cur->key, addr)) {
+      break;
+    }
+    if (!cur->_glue) {
+      best = cur;
+    }
+    if (cur_len == len) {
+      break;
+    }
+    cur = cur->child[_get_bit(addr, cur_len)];
+  }
+  return best;
+}
+
+/**
+ * @param trie pointer to prefix trie
+ * @return first node of the trie, NULL if trie is empty
+ */
+struct netaddr_trie_node *
+netaddr_trie_first(const struct netaddr_trie *trie) {
+  struct netaddr_trie_node *node;
+  int i;
+
+  for (i=0; i<NETADDR_TRIE_FAMILIES; i++) {
+    node = trie->root[i];
+    if (node != NULL) {
+      /* internal nodes always have children */
+      return node->_glue ? _get_next(node) : node;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @param trie pointer to prefix trie
+ * @param node pointer to node of the trie
+ * @return next node of the trie, NULL if node was the last one
+ */
+struct netaddr_trie_node *
+netaddr_trie_next(const struct netaddr_trie *trie,
+    const struct netaddr_trie_node *node) {
+  struct netaddr_trie_node *next;
+  int i;
+
+  next = _get_next(node);
+  if (next != NULL) {
+    return next;
+  }
+
+  /* continue with the next address family */
+  for (i=_get_family_index(node->key)+1; i<NETADDR_TRIE_FAMILIES; i++) {
+    next = trie->root[i];
+    if (next != NULL) {
+      return next->_glue ? _get_next(next) : next;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @param trie pointer to prefix trie
+ * @param prefix pointer to prefix
+ * @return first node of the trie contained in the prefix,
+ *   NULL if there is none
+ */
+struct netaddr_trie_node *
+netaddr_trie_subtree_first(const struct netaddr_trie *trie,
+    const struct netaddr *prefix) {
+  struct netaddr_trie_node *cur;
+  uint8_t len, cur_len;
+  int family;
+
+  family = _get_family_index(prefix);
+  if (family == -1) {
+    return NULL;
+  }
+
+  len = netaddr_get_prefix_length(prefix);
+  cur = trie->root[family];
+
+  /* look for the top node of the subtree */
+  while (cur != NULL) {
+    cur_len = netaddr_get_prefix_length(cur->key);
+    if (cur_len >= len) {
+      break;
+    }
+    if (!netaddr_is_in_subnet(cur->key, prefix)) {
+      return NULL;
+    }
+    cur = cur->child[_get_bit(prefix, cur_len)];
+  }
+
+  if (cur == NULL || !_is_in_prefix(prefix, cur->key)) {
+    return NULL;
+  }
+  return cur->_glue ? _get_next(cur) : cur;
+}
+
+/**
+ * @param trie pointer to prefix trie
+ * @param prefix pointer to prefix
+ * @param node pointer to a node of the trie contained in the prefix
+ * @return next node of the trie contained in the prefix,
+ *   NULL if there is none
+ */
+struct netaddr_trie_node *
+netaddr_trie_subtree_next(
+    const struct netaddr_trie *trie __attribute__((unused)),
+    const struct netaddr *prefix, const struct netaddr_trie_node *node) {
+  struct netaddr_trie_node *next;
+
+  /* nodes of a subtree are consecutive */
+  next = _get_next(node);
+  if (next == NULL || !_is_in_prefix(prefix, next->key)) {
+    return NULL;
+  }
+  return next;
+}
+
+/**
+ * @param trie pointer to prefix trie
+ * @param node pointer to node
+ * @return pointer to the link that points to the node
+ */
+static struct netaddr_trie_node **
+_get_ref(struct netaddr_trie *trie, struct netaddr_trie_node *node) {
+  if (node->parent == NULL) {
+    return &trie->root[_get_family_index(node->key)];
+  }
+  if (node->parent->child[0] == node) {
+    return &node->parent->child[0];
+  }
+  return &node->parent->child[1];
+}
+
+/**
+ * Get a reserved internal node. There is always at least one
+ * unused internal node if this is called by insert or remove.
+ * @param trie pointer to prefix trie
+ * @param prefix pointer to prefix for internal node
+ * @param prefix_len prefix length for internal node
+ * @return pointer to internal node
+ */
+static struct netaddr_trie_node *
+_pop_glue(struct netaddr_trie *trie,
+    const struct netaddr *prefix, uint8_t prefix_len) {
+  struct _trie_glue *glue;
+
+  glue = container_of(trie->_free_glue, struct _trie_glue, node);
+  trie->_free_glue = glue->node.parent;
+
+  memcpy(&glue->prefix, prefix, sizeof(*prefix));
+  netaddr_set_prefix_length(&glue->prefix, prefix_len);
+
+  glue->node.parent = NULL;
+  glue->node.child[0] = NULL;
+  glue->node.child[1] = NULL;
+  return &glue->node;
+}
+
+/**
+ * Put an internal node back into the list of unused ones
+ * @param trie pointer to prefix trie
+ * @param glue pointer to internal node
+ */
+static void
+_push_glue(struct netaddr_trie *trie, struct netaddr_trie_node *glue) {
+  glue->child[0] = NULL;
+  glue->child[1] = NULL;
+  glue->parent = trie->_free_glue;
+  trie->_free_glue = glue;
+}
+
+/**
+ * Make sure there is one internal node for each prefix of the trie
+ * including the one about to be inserted. Internal nodes are
+ * allocated in blocks which double in size up to
+ * NETADDR_TRIE_GLUE_BLOCK_MAX nodes.
+ * @param trie pointer to prefix trie
+ * @return -1 if an out of memory error happened, 0 otherwise
+ */
+static int
+_reserve_glue(struct netaddr_trie *trie) {
+  struct _trie_glue_block *block;
+  uint32_t i, size;
+
+  if (trie->_glue_count > trie->count) {
+    return 0;
+  }
+
+  size = trie->_glue_count;
+  if (size < NETADDR_TRIE_GLUE_BLOCK_MIN) {
+    size = NETADDR_TRIE_GLUE_BLOCK_MIN;
+  }
+  if (size > NETADDR_TRIE_GLUE_BLOCK_MAX) {
+    size = NETADDR_TRIE_GLUE_BLOCK_MAX;
+  }
+
+  block = calloc(1, sizeof(*block) + size * sizeof(struct _trie_glue));
+  if (block == NULL) {
+    return -1;
+  }
+
+  block->next = trie->_glue_blocks;
+  trie->_glue_blocks = block;
+  trie->_glue_count += size;
+
+  for (i=0; i<size; i++) {
+    block->glue[i].node._glue = true;
+    block->glue[i].node.key = &block->glue[i].prefix;
+    _push_glue(trie, &block->glue[i].node);
+  }
+  return 0;
+}
+
+/**
+ * Free all internal nodes, must only be called for an empty trie
+ * @param trie pointer to prefix trie
+ */
+static void
+_free_glue(struct netaddr_trie *trie) {
+  struct _trie_glue_block *block;
+
+  while (trie->_glue_blocks != NULL) {
+    block = trie->_glue_blocks;
+    trie->_glue_blocks = block->next;
+    free(block);
+  }
+  trie->_free_glue = NULL;
+  trie->_glue_count = 0;
+}
+
+/**
+ * Get the next node of the user in prefix order
+ * within the same address family
+ * @param node pointer to trie node
+ * @return next node, NULL if node was the last one
+ */
+static struct netaddr_trie_node *
+_get_next(const struct netaddr_trie_node *node) {
+  const struct netaddr_trie_node *parent;
+
+  do {
+    if (node->child[0] != NULL) {
+      node = node->child[0];
+    }
+    else if (node->child[1] != NULL) {
+      node = node->child[1];
+    }
+    else {
+      /* go up until there is an unvisited right subtree */
+      while (true) {
+        parent = node->parent;
+        if (parent == NULL) {
+          return NULL;
+        }
+        if (parent->child[0] == node && parent->child[1] != NULL) {
+          node = parent->child[1];
+          break;
+        }
+        node = parent;
+      }
+    }
+  } while (node->_glue);
+
+  return (struct netaddr_trie_node *)node;
+}
+
+/**
+ * @param prefix pointer to prefix
+ * @param addr pointer to address or prefix
+ * @return true if addr is the prefix or contained in it
+ */
+static bool
+_is_in_prefix(const struct netaddr *prefix, const struct netaddr *addr) {
+  return netaddr_get_prefix_length(addr) >= netaddr_get_prefix_length(prefix)
+      && netaddr_is_in_subnet(prefix, addr);
+}
+
+/**
+ * @param addr pointer to address
+ * @return index of the address family subtrie, -1 if not supported
+ */
+static int
+_get_family_index(const struct netaddr *addr) {
+  switch (netaddr_get_address_family(addr)) {
+    case AF_INET:
+      return 0;
+    case AF_INET6:
+      return 1;
+    case AF_MAC48:
+      return 2;
+    case AF_EUI64:
+      return 3;
+    default:
+      return -1;
+  }
+}
+
+/**
+ * @param addr pointer to address
+ * @param bit index of bit, 0 is the most significant bit
+ * @return value of bit
+ */
+static int
+_get_bit(const struct netaddr *addr, uint8_t bit) {
+  const uint8_t *bin;
+
+  bin = netaddr_get_binptr(addr);
+  return (bin[bit / 8] >> (7 - (bit % 8))) & 1;
+}
+
+/**
+ * @param a1 pointer to first address
+ * @param a2 pointer to second address
+ * @param max_len maximum number of bits to compare
+ * @return number of leading bits both addresses have in common
+ */
+static uint8_t
+_get_common_prefix(const struct netaddr *a1,
+    const struct netaddr *a2, uint8_t max_len) {
+  const uint8_t *b1, *b2;
+  unsigned len;
+  uint8_t diff;
+
+  b1 = netaddr_get_binptr(a1);
+  b2 = netaddr_get_binptr(a2);
+
+  /* compare whole bytes */
+  for (len = 0; len + 8 <= max_len && b1[len/8] == b2[len/8]; len += 8);
+
+  if (len < max_len) {
+    /* find first different bit */
+    diff = b1[len/8] ^ b2[len/8];
+    while (len < max_len && (diff & 0x80) == 0) {
+      diff <<= 1;
+      len++;
+    }
+  }
+  return len;
+}
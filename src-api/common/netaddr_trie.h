@@ -0,0 +1,250 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2013, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+#ifndef NETADDR_TRIE_H_
+#define NETADDR_TRIE_H_
+
+#include <stddef.h>
+
+#include "common/common_types.h"
+#include "common/container_of.h"
+#include "common/netaddr.h"
+
+/* number of address families with their own subtrie */
+#define NETADDR_TRIE_FAMILIES 4
+
+/* minimum and maximum number of internal nodes allocated at once */
+#define NETADDR_TRIE_GLUE_BLOCK_MIN 4
+#define NETADDR_TRIE_GLUE_BLOCK_MAX 256
+
+/**
+ * This element is a member of a prefix trie. It must be contained
+ * in all larger structs that should be put into a trie.
+ */
+struct netaddr_trie_node {
+  /**
+   * pointer to prefix of node, must be set before the node
+   * is inserted and must not change while it is in the trie
+   */
+  const struct netaddr *key;
+
+  /**
+   * Pointer to parent node in trie, NULL if root node
+   */
+  struct netaddr_trie_node *parent;
+
+  /**
+   * Pointer to child nodes for the next prefix bit 0 and 1
+   */
+  struct netaddr_trie_node *child[2];
+
+  /**
+   * true if this is an internal node that only exists
+   * to split the trie, false for nodes of the user
+   */
+  bool _glue;
+};
+
+/**
+ * This struct is the central management part of a prefix trie.
+ * One of them is necessary for each trie.
+ */
+struct netaddr_trie {
+  /**
+   * root of the subtrie for IPv4, IPv6, MAC48 and EUI64,
+   * NULL if there is no prefix of this family
+   */
+  struct netaddr_trie_node *root[NETADDR_TRIE_FAMILIES];
+
+  /**
+   * number of prefixes in the trie
+   */
+  uint32_t count;
+
+  /**
+   * unused internal nodes, there is at least one internal node
+   * for each prefix in the trie to make removal always successful.
+   * Internal nodes are allocated in blocks and only released
+   * when the trie becomes empty.
+   */
+  struct netaddr_trie_node *_free_glue;
+
+  /* number of allocated internal nodes */
+  uint32_t _glue_count;
+
+  /* list of allocated blocks of internal nodes */
+  void *_glue_blocks;
+};
+
+EXPORT void netaddr_trie_init(struct netaddr_trie *);
+EXPORT int netaddr_trie_insert(struct netaddr_trie *, struct netaddr_trie_node *);
+EXPORT void netaddr_trie_remove(struct netaddr_trie *, struct netaddr_trie_node *);
+EXPORT struct netaddr_trie_node *netaddr_trie_find(
+    const struct netaddr_trie *, const struct netaddr *prefix);
+EXPORT struct netaddr_trie_node *netaddr_trie_find_lpm(
+    const struct netaddr_trie *, const struct netaddr *addr);
+EXPORT struct netaddr_trie_node *netaddr_trie_first(const struct netaddr_trie *);
+EXPORT struct netaddr_trie_node *netaddr_trie_next(
+    const struct netaddr_trie *, const struct netaddr_trie_node *);
+EXPORT struct netaddr_trie_node *netaddr_trie_subtree_first(
+    const struct netaddr_trie *, const struct netaddr *prefix);
+EXPORT struct netaddr_trie_node *netaddr_trie_subtree_next(
+    const struct netaddr_trie *, const struct netaddr *prefix,
+    const struct netaddr_trie_node *);
+
+/**
+ * @param trie pointer to prefix trie
+ * @return true if the trie is empty, false otherwise
+ */
+static INLINE bool
+netaddr_trie_is_empty(const struct netaddr_trie *trie) {
+  return trie->count == 0;
+}
+
+/**
+ * @param trie pointer to prefix trie
+ * @param key pointer to prefix
+ * @param element pointer to a node element
+ *    (don't need to be initialized)
+ * @param node_element name of the netaddr_trie_node element inside the
+ *    larger struct
+ * @return pointer to trie element with exactly the specified prefix,
+ *    NULL if no element was found
+ */
+#define netaddr_trie_find_element(trie, key, element, node_element) \
+  container_of_if_notnull(netaddr_trie_find(trie, key), typeof(*(element)), node_element)
+
+/**
+ * @param trie pointer to prefix trie
+ * @param addr pointer to address or prefix
+ * @param element pointer to a node element
+ *    (don't need to be initialized)
+ * @param node_element name of the netaddr_trie_node element inside the
+ *    larger struct
+ * @return pointer to the trie element with the longest prefix
+ *    that contains the address, NULL if no element was found
+ */
+#define netaddr_trie_find_lpm_element(trie, addr, element, node_element) \
+  container_of_if_notnull(netaddr_trie_find_lpm(trie, addr), typeof(*(element)), node_element)
+
+/**
+ * @param trie pointer to prefix trie
+ * @param element pointer to a node element
+ *    (don't need to be initialized)
+ * @param node_member name of the netaddr_trie_node element inside the
+ *    larger struct
+ * @return pointer to the first element of the trie,
+ *    NULL if trie is empty
+ */
+#define netaddr_trie_first_element(trie, element, node_member) \
+  container_of_if_notnull(netaddr_trie_first(trie), typeof(*(element)), node_member)
+
+/**
+ * @param trie pointer to prefix trie
+ * @param element pointer to a node of the trie
+ * @param node_member name of the netaddr_trie_node element inside the
+ *    larger struct
+ * @return pointer to the node after 'element',
+ *    NULL if 'element' was the last one
+ */
+#define netaddr_trie_next_element(trie, element, node_member) \
+  container_of_if_notnull(netaddr_trie_next(trie, &(element)->node_member), typeof(*(element)), node_member)
+
+/**
+ * Loop over all elements of a prefix trie, used similar to a for() command.
+ * Elements are ordered by address family and prefix, a prefix comes
+ * before all the prefixes it contains. This loop should not be used
+ * if elements are removed from the trie during the loop.
+ *
+ * @param trie pointer to prefix trie
+ * @param element pointer to a node of the trie, this element will
+ *    contain the current node of the trie during the loop
+ * @param node_member name of the netaddr_trie_node element inside the
+ *    larger struct
+ */
+#define netaddr_trie_for_each_element(trie, element, node_member) \
+  for (element = netaddr_trie_first_element(trie, element, node_member); \
+       element != NULL; \
+       element = netaddr_trie_next_element(trie, element, node_member))
+
+/**
+ * Loop over all elements of a prefix trie, used similar to a for() command.
+ * This loop can be used if the current element might be removed from
+ * the trie during the loop. Other elements should not be removed during
+ * the loop.
+ *
+ * @param trie pointer to prefix trie
+ * @param element pointer to a node of the trie, this element will
+ *    contain the current node of the trie during the loop
+ * @param node_member name of the netaddr_trie_node element inside the
+ *    larger struct
+ * @param ptr pointer to a trie element which is used to store
+ *    the next node during the loop
+ */
+#define netaddr_trie_for_each_element_safe(trie, element, node_member, ptr) \
+  for (element = netaddr_trie_first_element(trie, element, node_member), \
+       ptr = element == NULL ? NULL : netaddr_trie_next_element(trie, element, node_member); \
+       element != NULL; \
+       element = ptr, \
+       ptr = element == NULL ? NULL : netaddr_trie_next_element(trie, element, node_member))
+
+/**
+ * Loop over all elements of a prefix trie that are contained in
+ * a prefix (including the prefix itself), used similar to a for()
+ * command. This loop should not be used if elements are removed
+ * from the trie during the loop.
+ *
+ * @param trie pointer to prefix trie
+ * @param prefix pointer to prefix of the subtree
+ * @param element pointer to a node of the trie, this element will
+ *    contain the current node of the trie during the loop
+ * @param node_member name of the netaddr_trie_node element inside the
+ *    larger struct
+ */
+#define netaddr_trie_for_each_element_in_subtree(trie, prefix, element, node_member) \
+  for (element = container_of_if_notnull(netaddr_trie_subtree_first(trie, prefix), \
+           typeof(*(element)), node_member); \
+       element != NULL; \
+       element = container_of_if_notnull(netaddr_trie_subtree_next(trie, prefix, \
+           &(element)->node_member), typeof(*(element)), node_member))
+
+#endif /* NETADDR_TRIE_H_ */
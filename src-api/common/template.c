@@ -51,6 +51,22 @@ static struct abuf_template_data *_find_template(
     struct abuf_template_data *data, size_t tmplLength, const char *txt, size_t txtLength);
 static int _json_printvalue(struct autobuf *out, const char *txt, bool string);
 
+/*
+ * JSON escape table, 0 for characters that can be copied,
+ * 'u' for characters that need an unicode escape sequence and
+ * the character to put after the backslash otherwise
+ */
+static const char _json_escape[256] = {
+  'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+  'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+  ['"'] = '"',
+  ['\\'] = '\\',
+  [127] = 'u',
+  [255] = 'u',
+};
+
+static const char _hex_digits[16] = "0123456789abcdef";
+
 /**
  * Initialize an index table for a template engine.
  * Each usage of a key in the format has to be %key%.
@@ -116,6 +132,7 @@ abuf_template_init (
     pos++;
   }
 
+  storage->format_length = pos;
   return storage;
 }
 
@@ -155,8 +172,8 @@ abuf_add_template(struct autobuf *out, const char *format,
     last = entry->end;
   }
 
-  if (last < strlen(format)) {
-    if (abuf_puts(out, &format[last]) < 0) {
+  if (last < storage->format_length) {
+    if (abuf_memcpy(out, &format[last], storage->format_length - last) < 0) {
       return -1;
     }
   }
@@ -175,10 +192,13 @@ abuf_add_template(struct autobuf *out, const char *format,
 int
 abuf_add_json(struct autobuf *out, const char *prefix,
     struct abuf_template_data *data, size_t data_count) {
+  size_t i, prefix_len;
   bool first;
-  size_t i;
 
-  if (abuf_appendf(out, "%s{\n", prefix) < 0) {
+  prefix_len = strlen(prefix);
+
+  if (abuf_memcpy(out, prefix, prefix_len) < 0
+      || abuf_memcpy(out, "{\n", 2) < 0) {
     return -1;
   }
 
@@ -189,7 +209,7 @@ abuf_add_json(struct autobuf *out, const char *prefix,
     }
 
     if (!first) {
-      if (abuf_puts(out, ",\n") < 0) {
+      if (abuf_memcpy(out, ",\n", 2) < 0) {
         return -1;
       }
     }
@@ -197,8 +217,10 @@ abuf_add_json(struct autobuf *out, const char *prefix,
       first = false;
     }
 
-    if (abuf_appendf(out, "%s    \"%s\" : ",
-        prefix, data[i].key) < 0) {
+    if (abuf_memcpy(out, prefix, prefix_len) < 0
+        || abuf_memcpy(out, "    \"", 5) < 0
+        || abuf_puts(out, data[i].key) < 0
+        || abuf_memcpy(out, "\" : ", 4) < 0) {
       return -1;
     }
     if (_json_printvalue(out, data[i].value, data[i].string)) {
@@ -207,12 +229,13 @@ abuf_add_json(struct autobuf *out, const char *prefix,
   }
 
   if (!first) {
-    if (abuf_puts(out, "\n") < 0) {
+    if (abuf_memcpy(out, "\n", 1) < 0) {
       return -1;
     }
   }
 
-  if (abuf_appendf(out, "%s}\n", prefix) < 0) {
+  if (abuf_memcpy(out, prefix, prefix_len) < 0
+      || abuf_memcpy(out, "}\n", 2) < 0) {
     return -1;
   }
   return 0;
@@ -251,53 +274,57 @@ _find_template(struct abuf_template_data *data, size_t tmplLength, const char *t
 static int
 _json_printvalue(struct autobuf *out, const char *txt, bool delimiter) {
   const char *ptr;
-  bool unprintable;
+  char escape[6];
+  unsigned char c;
 
   if (delimiter) {
-    if (abuf_puts(out, "\"") < 0) {
+    if (abuf_memcpy(out, "\"", 1) < 0) {
       return -1;
     }
   }
   else if (*txt == 0) {
-    abuf_puts(out, "0");
+    abuf_memcpy(out, "0", 1);
   }
 
-  ptr = txt;
-  while (*ptr) {
-    unprintable = !str_char_is_printable(*ptr);
-    if (unprintable || *ptr == '\\' || *ptr == '\"') {
-      if (ptr != txt) {
-        if (abuf_memcpy(out, txt, ptr - txt) < 0) {
-          return -1;
-        }
-      }
+  for (ptr = txt; *ptr; ptr++) {
+    c = (unsigned char)(*ptr);
+    if (_json_escape[c] == 0) {
+      continue;
+    }
 
-      if (unprintable) {
-        if (abuf_appendf(out, "\\u00%02x", (unsigned char)(*ptr++)) < 0) {
-          return -1;
-        }
-      }
-      else {
-        if (abuf_appendf(out, "\\%c", *ptr++) < 0) {
-          return -1;
-        }
+    /* copy the text before the escaped character */
+    if (abuf_memcpy(out, txt, ptr - txt) < 0) {
+      return -1;
+    }
+
+    escape[0] = '\\';
+    if (_json_escape[c] == 'u') {
+      escape[1] = 'u';
+      escape[2] = '0';
+      escape[3] = '0';
+      escape[4] = _hex_digits[c >> 4];
+      escape[5] = _hex_digits[c & 15];
+      if (abuf_memcpy(out, escape, 6) < 0) {
+        return -1;
       }
-      txt = ptr;
     }
     else {
-      ptr++;
+      escape[1] = _json_escape[c];
+      if (abuf_memcpy(out, escape, 2) < 0) {
+        return -1;
+      }
     }
+    txt = ptr + 1;
   }
 
-  if (abuf_puts(out, txt) < 0) {
+  if (abuf_memcpy(out, txt, ptr - txt) < 0) {
     return -1;
   }
   if (delimiter) {
-    if (abuf_puts(out, "\"") < 0) {
+    if (abuf_memcpy(out, "\"", 1) < 0) {
       return -1;
     }
   }
 
   return 0;
 }
-
@@ -57,12 +57,19 @@ struct abuf_template_data {
   bool string;
 };
 
+/*
+ * one key of a precompiled template, the literal text before
+ * the key ends at start, the literal text after it begins at end
+ */
 struct abuf_template_storage_entry {
   size_t start, end;
   struct abuf_template_data *data;
 };
 
 struct abuf_template_storage {
+  /* length of the format string, so rendering needs no strlen() */
+  size_t format_length;
+
   size_t count;
   struct abuf_template_storage_entry indices[0];
 };
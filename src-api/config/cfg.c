@@ -99,7 +99,6 @@ cfg_append_printable_line(struct autobuf *autobuf, const char *fmt, ...) {
 
   if (autobuf == NULL) return 0;
 
-  _value = (unsigned char *)abuf_getptr(autobuf) + abuf_getlen(autobuf);
   len = abuf_getlen(autobuf);
 
   va_start(ap, fmt);
@@ -110,6 +109,9 @@ cfg_append_printable_line(struct autobuf *autobuf, const char *fmt, ...) {
     return rv;
   }
 
+  /* appending might have moved the buffer */
+  _value = (unsigned char *)abuf_getptr(autobuf) + len;
+
   /* convert everything non-printable to '.' */
   while (*_value && len++ < abuf_getlen(autobuf)) {
     if (*_value < 32 || *_value == 127 || *_value == 255) {
@@ -0,0 +1,446 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2013, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#else
+#include <winsock2.h>
+#endif
+
+#include "common/autobuf.h"
+#include "common/avl.h"
+#include "common/common_types.h"
+#include "common/string.h"
+
+#include "config/cfg.h"
+#include "config/cfg_binary.h"
+#include "config/cfg_db.h"
+
+/* deduplicated string table of a snapshot under construction */
+struct _string_table {
+  /* tree of _string_node objects */
+  struct avl_tree tree;
+
+  /* content of the string table */
+  struct autobuf buf;
+};
+
+/* one string of the string table */
+struct _string_node {
+  struct avl_node node;
+
+  /* offset of string in table */
+  uint32_t offset;
+};
+
+/* read position in a snapshot */
+struct _reader {
+  const char *ptr;
+  const char *end;
+};
+
+static int _add_string(struct _string_table *table, const char *str,
+    uint32_t *ref);
+static int _append_string(struct _string_table *table, const char *str,
+    uint32_t *ref);
+static void _free_strings(struct _string_table *table);
+static int _avlcmp_string(const void *k1, const void *k2);
+static int _append_u32(struct autobuf *out, uint32_t value);
+static int _read_u32(struct _reader *reader, uint32_t *value);
+static int _read_string(struct _reader *reader,
+    const char *strings, uint32_t strings_len, const char **str);
+static int _parse_sections(struct cfg_db *db, struct _reader *reader,
+    const char *strings, uint32_t strings_len, uint32_t type_count);
+
+/**
+ * Check if a buffer starts with the header of a binary snapshot
+ * @param src pointer to buffer
+ * @param len length of buffer
+ * @return true if buffer is a binary snapshot, false otherwise
+ */
+bool
+cfg_binary_is_snapshot(const void *src, size_t len) {
+  return len >= CFG_BINARY_HEADER_LENGTH
+      && memcmp(src, CFG_BINARY_MAGIC, 4) == 0;
+}
+
+/**
+ * Serialize a configuration database into a binary snapshot
+ * @param dst target buffer
+ * @param src source configuration database
+ * @param log autobuffer for logging output
+ * @return 0 if database was serialized, -1 otherwise
+ */
+int
+cfg_binary_serialize(struct autobuf *dst, struct cfg_db *src,
+    struct autobuf *log) {
+  struct _string_table strings;
+  struct autobuf body;
+  struct cfg_section_type *section, *s_it;
+  struct cfg_named_section *named, *n_it;
+  struct cfg_entry *entry, *e_it;
+  uint32_t ref;
+  int result;
+
+  result = -1;
+  avl_init(&strings.tree, _avlcmp_string, false);
+  if (abuf_init(&strings.buf)) {
+    goto serialize_oom;
+  }
+  if (abuf_init(&body)) {
+    abuf_free(&strings.buf);
+    goto serialize_oom;
+  }
+
+  CFG_FOR_ALL_SECTION_TYPES(src, section, s_it) {
+    if (_add_string(&strings, section->type, &ref)) {
+      goto serialize_cleanup;
+    }
+    _append_u32(&body, ref);
+    _append_u32(&body, section->names.count);
+
+    CFG_FOR_ALL_SECTION_NAMES(section, named, n_it) {
+      /* section names are unique within a type, so don't look them up */
+      ref = CFG_BINARY_UNNAMED;
+      if (named->name != NULL && _append_string(&strings, named->name, &ref)) {
+        goto serialize_cleanup;
+      }
+      _append_u32(&body, ref);
+      _append_u32(&body, named->entries.count);
+
+      CFG_FOR_ALL_ENTRIES(named, entry, e_it) {
+        if (_add_string(&strings, entry->name, &ref)) {
+          goto serialize_cleanup;
+        }
+        _append_u32(&body, ref);
+        _append_u32(&body, entry->val.length);
+        abuf_memcpy(&body, entry->val.value, entry->val.length);
+      }
+    }
+  }
+
+  if (abuf_has_failed(&body)) {
+    goto serialize_cleanup;
+  }
+
+  /* header */
+  abuf_memcpy(dst, CFG_BINARY_MAGIC, 4);
+  abuf_append_uint16(dst, htons(CFG_BINARY_VERSION));
+  abuf_append_uint16(dst, 0);
+  _append_u32(dst, abuf_getlen(&strings.buf));
+  _append_u32(dst, src->sectiontypes.count);
+
+  /* string table and sections */
+  abuf_memcpy(dst, abuf_getptr(&strings.buf), abuf_getlen(&strings.buf));
+  abuf_memcpy(dst, abuf_getptr(&body), abuf_getlen(&body));
+
+  result = abuf_has_failed(dst) ? -1 : 0;
+
+serialize_cleanup:
+  _free_strings(&strings);
+  abuf_free(&body);
+  if (result == 0) {
+    return 0;
+  }
+serialize_oom:
+  cfg_append_printable_line(log,
+      "Out of memory error while creating binary snapshot");
+  return -1;
+}
+
+/**
+ * Parse a binary snapshot into a configuration database
+ * @param src pointer to snapshot
+ * @param len length of snapshot
+ * @param log autobuffer for logging output
+ * @return pointer to configuration database, NULL if an error happened
+ */
+struct cfg_db *
+cfg_binary_parse(const void *src, size_t len, struct autobuf *log) {
+  struct _reader reader;
+  struct cfg_db *db;
+  const char *strings;
+  uint16_t version;
+  uint32_t strings_len, type_count;
+
+  if (!cfg_binary_is_snapshot(src, len)) {
+    cfg_append_printable_line(log,
+        "Buffer is no binary configuration snapshot");
+    return NULL;
+  }
+
+  memcpy(&version, (const char *)src + 4, sizeof(version));
+  version = ntohs(version);
+  if (version != CFG_BINARY_VERSION) {
+    cfg_append_printable_line(log,
+        "Unsupported binary configuration snapshot version %u", version);
+    return NULL;
+  }
+
+  reader.ptr = (const char *)src + 8;
+  reader.end = (const char *)src + len;
+
+  _read_u32(&reader, &strings_len);
+  _read_u32(&reader, &type_count);
+
+  /* all strings must be zero terminated */
+  strings = reader.ptr;
+  if (strings_len > (size_t)(reader.end - reader.ptr)
+      || (strings_len > 0 && strings[strings_len - 1] != 0)) {
+    cfg_append_printable_line(log,
+        "Corrupt string table in binary configuration snapshot");
+    return NULL;
+  }
+  reader.ptr += strings_len;
+
+  db = cfg_db_add();
+  if (db == NULL) {
+    cfg_append_printable_line(log,
+        "Out of memory error while parsing binary snapshot");
+    return NULL;
+  }
+
+  if (_parse_sections(db, &reader, strings, strings_len, type_count)
+      || reader.ptr != reader.end) {
+    cfg_append_printable_line(log,
+        "Corrupt section data in binary configuration snapshot");
+    cfg_db_remove(db);
+    return NULL;
+  }
+  return db;
+}
+
+/**
+ * Parse the sections of a binary snapshot into a database
+ * @param db pointer to configuration database
+ * @param reader read position in snapshot
+ * @param strings pointer to string table
+ * @param strings_len length of string table
+ * @param type_count number of section types in snapshot
+ * @return -1 if snapshot is corrupt or an out of memory
+ *   error happened, 0 otherwise
+ */
+static int
+_parse_sections(struct cfg_db *db, struct _reader *reader,
+    const char *strings, uint32_t strings_len, uint32_t type_count) {
+  struct cfg_named_section *named;
+  struct const_strarray value;
+  const char *type, *name, *key;
+  uint32_t name_count, entry_count, length, ref;
+  bool dummy;
+
+  while (type_count-- > 0) {
+    if (_read_string(reader, strings, strings_len, &type)
+        || _read_u32(reader, &name_count)) {
+      return -1;
+    }
+
+    while (name_count-- > 0) {
+      if (_read_u32(reader, &ref) || _read_u32(reader, &entry_count)) {
+        return -1;
+      }
+
+      if (ref == CFG_BINARY_UNNAMED) {
+        name = NULL;
+      }
+      else if (ref < strings_len) {
+        name = &strings[ref];
+      }
+      else {
+        return -1;
+      }
+
+      named = _cfg_db_add_section(db, type, name, &dummy);
+      if (named == NULL) {
+        return -1;
+      }
+
+      while (entry_count-- > 0) {
+        if (_read_string(reader, strings, strings_len, &key)
+            || _read_u32(reader, &length)
+            || length > (size_t)(reader->end - reader->ptr)) {
+          return -1;
+        }
+
+        value.value = reader->ptr;
+        value.length = length;
+        reader->ptr += length;
+
+        if (length == 0) {
+          /* empty entries are not stored in a database */
+          continue;
+        }
+        if (value.value[length - 1] != 0
+            || cfg_db_set_entry_array(named, key, &value) == NULL) {
+          return -1;
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+/**
+ * Get the reference of a string in the string table,
+ * add the string to the table if necessary.
+ * @param table pointer to string table
+ * @param str string
+ * @param ref pointer to string reference, will be set by this function
+ * @return -1 if an out of memory error happened, 0 otherwise
+ */
+static int
+_add_string(struct _string_table *table, const char *str, uint32_t *ref) {
+  struct _string_node *string;
+
+  string = avl_find_element(&table->tree, str, string, node);
+  if (string == NULL) {
+    string = calloc(1, sizeof(*string));
+    if (string == NULL) {
+      return -1;
+    }
+
+    if (_append_string(table, str, &string->offset)) {
+      free(string);
+      return -1;
+    }
+
+    string->node.key = str;
+    avl_insert(&table->tree, &string->node);
+  }
+
+  *ref = string->offset;
+  return 0;
+}
+
+/**
+ * Append a string to the string table without checking
+ * if it is already stored there.
+ * @param table pointer to string table
+ * @param str string
+ * @param ref pointer to string reference, will be set by this function
+ * @return -1 if an out of memory error happened, 0 otherwise
+ */
+static int
+_append_string(struct _string_table *table, const char *str, uint32_t *ref) {
+  *ref = abuf_getlen(&table->buf);
+  return abuf_memcpy(&table->buf, str, strlen(str) + 1);
+}
+
+/**
+ * Free all memory allocated for a string table
+ * @param table pointer to string table
+ */
+static void
+_free_strings(struct _string_table *table) {
+  struct _string_node *string, *it;
+
+  avl_for_each_element_safe(&table->tree, string, node, it) {
+    avl_remove(&table->tree, &string->node);
+    free(string);
+  }
+  abuf_free(&table->buf);
+}
+
+/**
+ * AVL comparator for case sensitive strings
+ * @param k1 pointer to first string
+ * @param k2 pointer to second string
+ * @return similar to strcmp()
+ */
+static int
+_avlcmp_string(const void *k1, const void *k2) {
+  return strcmp(k1, k2);
+}
+
+/**
+ * Append a 32 bit integer in network byte order to a buffer
+ * @param out pointer to autobuffer
+ * @param value host order integer
+ * @return -1 if an out of memory error happened, 0 otherwise
+ */
+static int
+_append_u32(struct autobuf *out, uint32_t value) {
+  value = htonl(value);
+  return abuf_memcpy(out, &value, sizeof(value));
+}
+
+/**
+ * Read a 32 bit integer in network byte order from a snapshot
+ * @param reader read position in snapshot
+ * @param value pointer to host order integer,
+ *   will be set by this function
+ * @return -1 if the snapshot ended too early, 0 otherwise
+ */
+static int
+_read_u32(struct _reader *reader, uint32_t *value) {
+  if ((size_t)(reader->end - reader->ptr) < sizeof(*value)) {
+    return -1;
+  }
+  memcpy(value, reader->ptr, sizeof(*value));
+  *value = ntohl(*value);
+  reader->ptr += sizeof(*value);
+  return 0;
+}
+
+/**
+ * Read a string reference from a snapshot and resolve it
+ * @param reader read position in snapshot
+ * @param strings pointer to string table
+ * @param strings_len length of string table
+ * @param str pointer to string pointer, will be set by this function
+ * @return -1 if the snapshot ended too early or the
+ *   reference was illegal, 0 otherwise
+ */
+static int
+_read_string(struct _reader *reader,
+    const char *strings, uint32_t strings_len, const char **str) {
+  uint32_t ref;
+
+  if (_read_u32(reader, &ref) || ref >= strings_len) {
+    return -1;
+  }
+  *str = &strings[ref];
+  return 0;
+}
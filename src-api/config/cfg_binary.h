@@ -0,0 +1,100 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2013, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+#ifndef CFG_BINARY_H_
+#define CFG_BINARY_H_
+
+#include "common/autobuf.h"
+#include "common/common_types.h"
+#include "config/cfg_db.h"
+
+/*
+ * Binary snapshot format of a configuration database,
+ * all integers are stored in network byte order.
+ *
+ * header:
+ *   char     magic[4]         "OCDB"
+ *   uint16_t version          CFG_BINARY_VERSION
+ *   uint16_t reserved         0
+ *   uint32_t string_length    length of string table in bytes
+ *   uint32_t type_count       number of section types
+ *
+ * string table:
+ *   zero terminated section types, section names and entry keys,
+ *   referenced by their offset in the table. Section types and
+ *   entry keys are only stored once.
+ *
+ * for each section type:
+ *   uint32_t type             string reference
+ *   uint32_t name_count       number of named sections
+ *
+ *   for each named section:
+ *     uint32_t name           string reference or CFG_BINARY_UNNAMED
+ *     uint32_t entry_count    number of entries
+ *
+ *     for each entry:
+ *       uint32_t key          string reference
+ *       uint32_t length       length of value in bytes
+ *       char     value[]      string array buffer of the entry
+ */
+
+/* magic bytes at the start of a binary snapshot */
+#define CFG_BINARY_MAGIC "OCDB"
+
+enum {
+  /* current version of the binary snapshot format */
+  CFG_BINARY_VERSION = 1,
+
+  /* length of snapshot header in bytes */
+  CFG_BINARY_HEADER_LENGTH = 16,
+
+  /* string reference of an unnamed section */
+  CFG_BINARY_UNNAMED = 0xffffffff,
+};
+
+EXPORT bool cfg_binary_is_snapshot(const void *src, size_t len);
+EXPORT int cfg_binary_serialize(struct autobuf *dst, struct cfg_db *src,
+    struct autobuf *log);
+EXPORT struct cfg_db *cfg_binary_parse(const void *src, size_t len,
+    struct autobuf *log);
+
+#endif /* CFG_BINARY_H_ */
@@ -62,6 +62,9 @@ static void _free_namedsection(struct cfg_named_section *);
 static struct cfg_entry *_alloc_entry(
     struct cfg_named_section *, const char *);
 static void _free_entry(struct cfg_entry *);
+static int _append_entry(struct cfg_named_section *, struct cfg_entry *);
+static int _avlcmp_dirty(const void *, const void *);
+static bool _is_sectiontype_dirty(struct cfg_db *, const char *);
 
 /**
  * @return new configuration database without entries,
@@ -74,6 +77,7 @@ cfg_db_add(void) {
   db = calloc(1, sizeof(*db));
   if (db) {
     avl_init(&db->sectiontypes, cfg_avlcmp_keys, false);
+    avl_init(&db->dirty, _avlcmp_dirty, false);
   }
   return db;
 }
@@ -89,6 +93,7 @@ cfg_db_remove(struct cfg_db *db) {
   CFG_FOR_ALL_SECTION_TYPES(db, section, section_it) {
     _free_sectiontype(section);
   }
+  cfg_db_clear_dirty(db);
   free(db);
 }
 
@@ -107,9 +112,8 @@ int
 _cfg_db_append(struct cfg_db *dst, struct cfg_db *src,
     const char *section_type, const char *section_name, const char *entry_name) {
   struct cfg_section_type *section, *section_it;
-  struct cfg_named_section *named, *named_it;
+  struct cfg_named_section *named, *named_it, *dst_named;
   struct cfg_entry *entry, *entry_it;
-  char *ptr;
   bool dummy;
 
   CFG_FOR_ALL_SECTION_TYPES(src, section, section_it) {
@@ -122,20 +126,19 @@ _cfg_db_append(struct cfg_db *dst, struct cfg_db *src,
         continue;
       }
 
-      if (_cfg_db_add_section(dst, section->type, named->name, &dummy) == NULL) {
+      dst_named = _cfg_db_add_section(dst, section->type, named->name, &dummy);
+      if (dst_named == NULL) {
         return -1;
       }
+      cfg_db_mark_dirty(dst, section->type, named->name);
 
       CFG_FOR_ALL_ENTRIES(named, entry, entry_it) {
         if (entry_name != NULL && cfg_cmp_keys(entry->name, entry_name) != 0) {
           continue;
         }
 
-        strarray_for_each_element(&entry->val, ptr) {
-          if (cfg_db_set_entry_ext(
-              dst, section->type, named->name, entry->name, ptr, true, false) == NULL) {
-            return -1;
-          }
+        if (_append_entry(dst_named, entry)) {
+          return -1;
         }
       }
     }
@@ -143,6 +146,72 @@ _cfg_db_append(struct cfg_db *dst, struct cfg_db *src,
   return 0;
 }
 
+/**
+ * Creates a copy of a configuration database. Section types of the
+ * source without recorded changes are moved over from a base database
+ * instead of being copied again. The base must be a copy of the source
+ * from the time of the last cfg_db_clear_dirty() call, afterwards it
+ * only contains the section types that have changed since then.
+ * If the source does not track its changes, the base stays untouched
+ * and the whole source is copied.
+ * The copy tracks its changes, its dirty tree contains all named
+ * sections that have been copied instead of moved.
+ * @param src pointer to source database
+ * @param base pointer to older copy of the source database
+ * @return pointer to the new database, NULL if out of memory
+ */
+struct cfg_db *
+cfg_db_duplicate_dirty(struct cfg_db *src, struct cfg_db *base) {
+  struct cfg_section_type *section, *section_it, *base_section;
+  struct cfg_db *dst;
+
+  if (!src->track_changes || src->dirty_all) {
+    dst = cfg_db_duplicate(src);
+    if (dst) {
+      cfg_db_track_changes(dst, true);
+      dst->dirty_all = true;
+    }
+    return dst;
+  }
+
+  dst = cfg_db_add();
+  if (dst == NULL) {
+    return NULL;
+  }
+  cfg_db_track_changes(dst, true);
+
+  /* copy changed section types first, the base stays intact on error */
+  CFG_FOR_ALL_SECTION_TYPES(src, section, section_it) {
+    if (!_is_sectiontype_dirty(src, section->type)
+        && cfg_db_find_sectiontype(base, section->type) != NULL) {
+      continue;
+    }
+
+    if (_cfg_db_append(dst, src, section->type, NULL, NULL)) {
+      cfg_db_remove(dst);
+      return NULL;
+    }
+  }
+
+  /* now move the unchanged section types */
+  CFG_FOR_ALL_SECTION_TYPES(src, section, section_it) {
+    if (_is_sectiontype_dirty(src, section->type)) {
+      continue;
+    }
+
+    base_section = cfg_db_find_sectiontype(base, section->type);
+    if (base_section == NULL) {
+      /* already copied */
+      continue;
+    }
+
+    avl_remove(&base->sectiontypes, &base_section->node);
+    base_section->db = dst;
+    avl_insert(&dst->sectiontypes, &base_section->node);
+  }
+  return dst;
+}
+
 /**
  * Adds a named section to a configuration database
  * @param db pointer to configuration database
@@ -180,6 +249,7 @@ _cfg_db_add_section(struct cfg_db *db, const char *section_type,
   if (named == NULL) {
     named = _alloc_namedsection(section, section_name);
     *new_section = true;
+    cfg_db_mark_dirty(db, section_type, section_name);
   }
 
   return named;
@@ -195,6 +265,7 @@ _cfg_db_add_section(struct cfg_db *db, const char *section_type,
 int
 cfg_db_remove_sectiontype(struct cfg_db *db, const char *section_type) {
   struct cfg_section_type *section;
+  struct cfg_named_section *named, *named_it;
 
   /* find section */
   section = cfg_db_find_sectiontype(db, section_type);
@@ -202,6 +273,10 @@ cfg_db_remove_sectiontype(struct cfg_db *db, const char *section_type) {
     return -1;
   }
 
+  CFG_FOR_ALL_SECTION_NAMES(section, named, named_it) {
+    cfg_db_mark_dirty(db, section->type, named->name);
+  }
+
   _free_sectiontype(section);
   return 0;
 }
@@ -246,6 +321,8 @@ cfg_db_remove_namedsection(struct cfg_db *db, const char *section_type,
     return -1;
   }
 
+  cfg_db_mark_dirty(db, section_type, section_name);
+
   /* only free named section */
   _free_namedsection(named);
   return 0;
@@ -288,6 +365,7 @@ cfg_db_set_entry_ext(struct cfg_db *db, const char *section_type,
     new_entry = true;
   }
 
+  cfg_db_reset_bincache(entry);
   if (!append) {
     strarray_free(&entry->val);
   }
@@ -303,6 +381,7 @@ cfg_db_set_entry_ext(struct cfg_db *db, const char *section_type,
     }
   }
 
+  cfg_db_mark_dirty(db, section_type, section_name);
   return entry;
 set_entry_error:
   if (new_entry) {
@@ -314,6 +393,43 @@ set_entry_error:
   return NULL;
 }
 
+/**
+ * Sets all values of an entry in a named section with a
+ * single copy of a string array.
+ * @param named pointer to named section
+ * @param entry_name entry name
+ * @param value string array with all values of the entry,
+ *   must not be empty
+ * @return pointer to cfg_entry, NULL if an error happened
+ */
+struct cfg_entry *
+cfg_db_set_entry_array(struct cfg_named_section *named,
+    const char *entry_name, const struct const_strarray *value) {
+  struct cfg_entry *entry;
+  bool new_entry = false;
+
+  entry = cfg_db_get_entry(named, entry_name);
+  if (!entry) {
+    entry = _alloc_entry(named, entry_name);
+    if (!entry) {
+      return NULL;
+    }
+    new_entry = true;
+  }
+
+  if (strarray_copy_c(&entry->val, value)) {
+    if (new_entry) {
+      _free_entry(entry);
+    }
+    return NULL;
+  }
+
+  cfg_db_reset_bincache(entry);
+  cfg_db_mark_dirty(named->section_type->db,
+      named->section_type->type, named->name);
+  return entry;
+}
+
 /**
  * Finds a specific entry inside a configuration database
  * @param db pointer to configuration database
@@ -356,6 +472,7 @@ cfg_db_remove_entry(struct cfg_db *db, const char *section_type,
     return -1;
   }
 
+  cfg_db_mark_dirty(db, section_type, section_name);
   _free_entry(entry);
   return 0;
 }
@@ -428,6 +545,7 @@ cfg_db_remove_element(struct cfg_db *db, const char *section_type,
   if (!cfg_db_is_multipart_entry(entry)) {
     /* only a single element in list */
     if (strcmp(value, entry->val.value) == 0) {
+      cfg_db_mark_dirty(db, section_type, section_name);
       _free_entry(entry);
       return 0;
     }
@@ -436,6 +554,8 @@ cfg_db_remove_element(struct cfg_db *db, const char *section_type,
 
   strarray_for_each_element(&entry->val, ptr) {
     if (strcmp(ptr, value) == 0) {
+      cfg_db_mark_dirty(db, section_type, section_name);
+      cfg_db_reset_bincache(entry);
       strarray_remove(&entry->val, ptr);
       return 0;
     }
@@ -445,6 +565,90 @@ cfg_db_remove_element(struct cfg_db *db, const char *section_type,
   return -1;
 }
 
+/**
+ * Records a changed named section in the dirty tree of a
+ * database, if the database tracks its changes.
+ * @param db pointer to configuration database
+ * @param section_type type of section
+ * @param section_name name of section, NULL if an unnamed one
+ */
+void
+cfg_db_mark_dirty(struct cfg_db *db,
+    const char *section_type, const char *section_name) {
+  struct cfg_db_dirty_key key;
+  struct cfg_db_dirty *dirty;
+  size_t type_len, name_len;
+  char *ptr;
+
+  if (!db->track_changes || db->dirty_all) {
+    return;
+  }
+
+  key.type = section_type;
+  key.name = section_name;
+  if (avl_find(&db->dirty, &key)) {
+    /* already marked */
+    return;
+  }
+
+  type_len = strlen(section_type) + 1;
+  name_len = section_name == NULL ? 0 : strlen(section_name) + 1;
+
+  /* allocate entry and both strings in one block */
+  dirty = calloc(1, sizeof(*dirty) + type_len + name_len);
+  if (dirty == NULL) {
+    /* we cannot track the change, remember to check everything */
+    db->dirty_all = true;
+    return;
+  }
+
+  ptr = (char *)(dirty + 1);
+  memcpy(ptr, section_type, type_len);
+  dirty->key.type = ptr;
+
+  if (section_name != NULL) {
+    memcpy(ptr + type_len, section_name, name_len);
+    dirty->key.name = ptr + type_len;
+  }
+
+  dirty->node.key = &dirty->key;
+  avl_insert(&db->dirty, &dirty->node);
+}
+
+/**
+ * Forget all recorded changes of a configuration database
+ * @param db pointer to configuration database
+ */
+void
+cfg_db_clear_dirty(struct cfg_db *db) {
+  struct cfg_db_dirty *dirty, *dirty_it;
+
+  CFG_FOR_ALL_DIRTY_SECTIONS(db, dirty, dirty_it) {
+    avl_remove(&db->dirty, &dirty->node);
+    free(dirty);
+  }
+  db->dirty_all = false;
+}
+
+/**
+ * @param db pointer to configuration database
+ * @param section_type type of section
+ * @return true if a named section of this type has been marked
+ *   as changed, false otherwise
+ */
+static bool
+_is_sectiontype_dirty(struct cfg_db *db, const char *section_type) {
+  struct cfg_db_dirty_key key;
+  struct cfg_db_dirty *dirty;
+
+  /* the unnamed section sorts first within a type */
+  key.type = section_type;
+  key.name = NULL;
+
+  dirty = avl_find_ge_element(&db->dirty, &key, dirty, node);
+  return dirty != NULL && cfg_cmp_keys(dirty->key.type, section_type) == 0;
+}
+
 /**
  * Creates a section type in a configuration database
  * @param db pointer to configuration database
@@ -588,3 +792,65 @@ _free_entry(struct cfg_entry *entry) {
   free(entry->name);
   free(entry);
 }
+
+/**
+ * Appends the values of a configuration entry to the entry
+ * with the same name in a named section.
+ * @param named pointer to target named section
+ * @param src pointer to source entry
+ * @return -1 if an out of memory error happened, 0 otherwise
+ */
+static int
+_append_entry(struct cfg_named_section *named, struct cfg_entry *src) {
+  struct cfg_entry *entry;
+  char *ptr;
+
+  if (strarray_is_empty(&src->val)) {
+    return 0;
+  }
+
+  entry = cfg_db_get_entry(named, src->name);
+  if (entry == NULL) {
+    /* new entry, copy the value buffer as a whole */
+    entry = _alloc_entry(named, src->name);
+    if (entry == NULL) {
+      return -1;
+    }
+    if (strarray_copy(&entry->val, &src->val)) {
+      _free_entry(entry);
+      return -1;
+    }
+
+    /* same value, so the binary value is still valid */
+    memcpy(&entry->_bincache, &src->_bincache, sizeof(entry->_bincache));
+    return 0;
+  }
+
+  cfg_db_reset_bincache(entry);
+  strarray_for_each_element(&src->val, ptr) {
+    if (strarray_append(&entry->val, ptr)) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * AVL comparator for the keys of the dirty tree. Compares
+ * the section type first and the section name afterwards.
+ * @param p1 pointer to first key
+ * @param p2 pointer to second key
+ * @return <0 if p1 comes first, 0 if both are the same, >0 otherwise
+ */
+static int
+_avlcmp_dirty(const void *p1, const void *p2) {
+  const struct cfg_db_dirty_key *key1 = p1;
+  const struct cfg_db_dirty_key *key2 = p2;
+  int result;
+
+  result = cfg_avlcmp_keys(key1->type, key2->type);
+  if (result) {
+    return result;
+  }
+  return cfg_avlcmp_keys(key1->name, key2->name);
+}
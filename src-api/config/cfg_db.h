@@ -47,9 +47,11 @@ struct cfg_db;
 struct cfg_section_type;
 struct cfg_named_section;
 struct cfg_entry;
+struct cfg_schema_entry;
 
 #include "common/avl.h"
 #include "common/common_types.h"
+#include "common/netaddr.h"
 #include "common/string.h"
 
 #include "config/cfg_schema.h"
@@ -61,6 +63,33 @@ struct cfg_db {
 
   /* linked schema of db */
   struct cfg_schema *schema;
+
+  /* tree of named sections changed since the last cfg_db_clear_dirty() */
+  struct avl_tree dirty;
+
+  /* true if the dirty tree is incomplete and the whole db has to be checked */
+  bool dirty_all;
+
+  /* true if changes of the db should be recorded in the dirty tree */
+  bool track_changes;
+};
+
+/* key of a changed named section */
+struct cfg_db_dirty_key {
+  /* type of section */
+  const char *type;
+
+  /* name of section, NULL for an unnamed section */
+  const char *name;
+};
+
+/* Represents a changed named section of a configuration database */
+struct cfg_db_dirty {
+  /* node for dirty tree in database */
+  struct avl_node node;
+
+  /* type and name of the changed section */
+  struct cfg_db_dirty_key key;
 };
 
 /* Represents a section type in a configuration database */
@@ -93,6 +122,25 @@ struct cfg_named_section {
   struct avl_tree entries;
 };
 
+/* binary representation of a configuration value */
+struct cfg_entry_bincache {
+  /* converter that created the binary value, NULL if cache is not valid */
+  int (*cb_to_binary)(const struct cfg_schema_entry *s_entry,
+      const struct const_strarray *value, void *ptr);
+
+  /* conversion parameters of the schema entry used by the converter */
+  uint64_t param[3];
+
+  /* number of bytes of binary value */
+  size_t size;
+
+  /* binary value */
+  union {
+    int64_t i64;
+    struct netaddr addr;
+  } value;
+};
+
 /* Represents a configuration entry */
 struct cfg_entry {
   /* node for tree in named section */
@@ -106,16 +154,21 @@ struct cfg_entry {
 
   /* backpointer to named section */
   struct cfg_named_section *named_section;
+
+  /* cached binary value, see cfg_schema_tobin() */
+  struct cfg_entry_bincache _bincache;
 };
 
 #define CFG_FOR_ALL_SECTION_TYPES(db, s_type, iterator) avl_for_each_element_safe(&db->sectiontypes, s_type, node, iterator)
 #define CFG_FOR_ALL_SECTION_NAMES(s_type, s_name, iterator) avl_for_each_element_safe(&s_type->names, s_name, node, iterator)
 #define CFG_FOR_ALL_ENTRIES(s_name, entry, iterator) avl_for_each_element_safe(&s_name->entries, entry, node, iterator)
+#define CFG_FOR_ALL_DIRTY_SECTIONS(db, dirty, iterator) avl_for_each_element_safe(&db->dirty, dirty, node, iterator)
 
 EXPORT struct cfg_db *cfg_db_add(void);
 EXPORT void cfg_db_remove(struct cfg_db *);
 EXPORT int _cfg_db_append(struct cfg_db *dst, struct cfg_db *src,
     const char *section_type, const char *section_name, const char *entry_name);
+EXPORT struct cfg_db *cfg_db_duplicate_dirty(struct cfg_db *src, struct cfg_db *base);
 
 EXPORT struct cfg_named_section *_cfg_db_add_section(
     struct cfg_db *, const char *section_type, const char *section_name,
@@ -131,6 +184,8 @@ EXPORT int cfg_db_remove_namedsection(struct cfg_db *db, const char *section_typ
 EXPORT struct cfg_entry *cfg_db_set_entry_ext(struct cfg_db *db, const char *section_type,
     const char *section_name, const char *entry_name, const char *value,
     bool append, bool front);
+EXPORT struct cfg_entry *cfg_db_set_entry_array(struct cfg_named_section *named,
+    const char *entry_name, const struct const_strarray *value);
 
 EXPORT struct cfg_entry *cfg_db_find_entry(struct cfg_db *db,
     const char *section_type, const char *section_name, const char *entry_name);
@@ -142,6 +197,10 @@ EXPORT const struct const_strarray *cfg_db_get_entry_value(struct cfg_db *db,
 EXPORT int cfg_db_remove_element(struct cfg_db *, const char *section_type,
     const char *section_name, const char *entry_name, const char *value);
 
+EXPORT void cfg_db_mark_dirty(struct cfg_db *,
+    const char *section_type, const char *section_name);
+EXPORT void cfg_db_clear_dirty(struct cfg_db *);
+
 /**
  * Link a configuration schema to a database
  * @param db pointer to database
@@ -152,6 +211,27 @@ cfg_db_link_schema(struct cfg_db *db, struct cfg_schema *schema) {
   db->schema = schema;
 }
 
+/**
+ * Enable or disable recording of changed named sections
+ * in the dirty tree of a database.
+ * @param db pointer to database
+ * @param track true to record changes, false otherwise
+ */
+static INLINE void
+cfg_db_track_changes(struct cfg_db *db, bool track) {
+  db->track_changes = track;
+}
+
+/**
+ * @param db pointer to database
+ * @return true if no change has been recorded since the last
+ *   call of cfg_db_clear_dirty()
+ */
+static INLINE bool
+cfg_db_is_clean(struct cfg_db *db) {
+  return !db->dirty_all && avl_is_empty(&db->dirty);
+}
+
 /**
  * Creates a copy of a configuration database
  * @param src original database
@@ -416,4 +496,14 @@ cfg_db_entry_get_listsize(struct cfg_entry *entry) {
   return strarray_get_count(&entry->val);
 }
 
+/**
+ * Invalidates the cached binary value of a configuration entry,
+ * must be called every time the value of the entry is modified.
+ * @param entry pointer to cfg entry
+ */
+static INLINE void
+cfg_db_reset_bincache(struct cfg_entry *entry) {
+  entry->_bincache.cb_to_binary = NULL;
+}
+
 #endif /* CFG_DB_H_ */
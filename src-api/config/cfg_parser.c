@@ -40,6 +40,8 @@
  */
 
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "common/autobuf.h"
 #include "common/avl.h"
@@ -152,6 +154,54 @@ cfg_parser_parse_buffer(struct cfg_instance *instance,
   return f->parse(src, len, log);
 }
 
+/**
+ * Parse the content of a read-only buffer into a configuration database.
+ * Parsers without support for read-only buffers get a temporary copy.
+ * @param instance pointer to cfg_instance
+ * @param parser parser name
+ * @param src pointer to input buffer
+ * @param len length of input buffer
+ * @param log autobuffer for logging output
+ * @return pointer to configuration database, NULL if an error happened
+ */
+struct cfg_db *
+cfg_parser_parse_const_buffer(struct cfg_instance *instance,
+    const char *parser, const void *src, size_t len, struct autobuf *log) {
+  struct cfg_parser *f;
+  struct cfg_db *db;
+  char *copy;
+
+  f = _find_parser(instance, parser);
+  if (f == NULL) {
+    cfg_append_printable_line(log, "Cannot find parser '%s'", parser);
+    return NULL;
+  }
+
+  if (f->parse_const != NULL) {
+    return f->parse_const(src, len, log);
+  }
+
+  if (f->parse == NULL) {
+    cfg_append_printable_line(log, "Configuration parser '%s'"
+        " does not support parsing", parser);
+    return NULL;
+  }
+
+  /* parser needs a writable and zero terminated buffer */
+  copy = malloc(len + 1);
+  if (copy == NULL) {
+    cfg_append_printable_line(log,
+        "Out of memory error while allocating parser buffer");
+    return NULL;
+  }
+  memcpy(copy, src, len);
+  copy[len] = 0;
+
+  db = f->parse(copy, len, log);
+  free(copy);
+  return db;
+}
+
 /**
  * Serialize a configuration database into a buffer
  * @param instance pointer to cfg_instance
@@ -66,6 +66,12 @@ struct cfg_parser {
   /* callback for parsing a buffer into a configuration database */
   struct cfg_db *(*parse)(char *src, size_t len, struct autobuf *log);
 
+  /*
+   * callback for parsing a read-only buffer into a
+   * configuration database, might be NULL
+   */
+  struct cfg_db *(*parse_const)(const char *src, size_t len, struct autobuf *log);
+
   /* callback for serializing a database into a buffer */
   int (*serialize)(struct autobuf *dst, struct cfg_db *src, struct autobuf *log);
 };
@@ -80,6 +86,8 @@ EXPORT const char *cfg_parser_find(struct cfg_instance *,
 
 EXPORT struct cfg_db *cfg_parser_parse_buffer(struct cfg_instance *,
     const char *parser, void *src, size_t len, struct autobuf *log);
+EXPORT struct cfg_db *cfg_parser_parse_const_buffer(struct cfg_instance *,
+    const char *parser, const void *src, size_t len, struct autobuf *log);
 EXPORT int cfg_parser_serialize_to_buffer(struct cfg_instance *, const char *parser,
     struct autobuf *dst, struct cfg_db *src, struct autobuf *log);
 
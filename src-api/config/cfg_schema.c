@@ -56,6 +56,15 @@
 #include "config/cfg_schema.h"
 #include "config/cfg_validate.h"
 
+static bool _validate_sectiontype(struct cfg_db *db,
+    struct cfg_section_type *section, struct cfg_named_section *named,
+    bool cleanup, bool ignore_unknown_sections, bool error,
+    struct autobuf *out);
+static bool _validate_named_section(struct cfg_db *db,
+    struct cfg_schema_section *schema_section,
+    struct cfg_section_type *section, struct cfg_named_section *named,
+    bool cleanup, bool *error, struct autobuf *out);
+static bool _check_mandatory_sections(struct cfg_db *db, struct autobuf *out);
 static bool _validate_cfg_entry(
     struct cfg_db *db, struct cfg_section_type *section,
     struct cfg_named_section *named, struct cfg_entry *entry,
@@ -69,8 +78,21 @@ static void _handle_named_section_change(struct cfg_schema_section *s_section,
     const char *name, bool startup,
     struct cfg_named_section *pre_defnamed,
     struct cfg_named_section *post_defnamed);
+static void _init_default_sections(
+    struct cfg_section_type *default_section_type,
+    struct cfg_named_section *default_named_section,
+    struct cfg_db *pre_change, struct cfg_db *post_change);
+static void _handle_sectiontype_changes(struct cfg_schema_section *s_section,
+    struct cfg_db *pre_change, struct cfg_db *post_change, bool startup,
+    struct cfg_section_type *default_section_type,
+    struct cfg_named_section *default_named_section);
 static int _handle_db_changes(struct cfg_db *pre_change,
     struct cfg_db *post_change, bool startup);
+static struct cfg_entry *_get_value_entry(struct cfg_named_section *named,
+    const struct cfg_schema_entry *s_entry);
+static size_t _get_bincache_size(const struct cfg_schema_entry *s_entry);
+static int _update_bincache(struct cfg_entry *entry,
+    const struct cfg_schema_entry *s_entry);
 
 const char *CFGLIST_BOOL_TRUE[] = { CFGLIST_BOOL_TRUE_VALUES };
 const char *CFGLIST_BOOL[] = { CFGLIST_BOOL_VALUES };
@@ -107,6 +129,7 @@ cfg_schema_add_section(struct cfg_schema *schema,
   /* hook section into global section tree */
   section->_section_node.key = section->type;
   avl_insert(&schema->sections, &section->_section_node);
+  schema->revision++;
 
   if (section->cb_delta_handler) {
     /* hook callback into global callback handler tree */
@@ -151,6 +174,7 @@ cfg_schema_remove_section(struct cfg_schema *schema, struct cfg_schema_section *
   if (section->_section_node.key) {
     avl_remove(&schema->sections, &section->_section_node);
     section->_section_node.key = NULL;
+    schema->revision++;
 
     for (i=0; i<section->entry_count; i++) {
       avl_remove(&schema->entries, &section->entries[i]._node);
@@ -176,133 +200,67 @@ int
 cfg_schema_validate(struct cfg_db *db,
     bool cleanup, bool ignore_unknown_sections,
     struct autobuf *out) {
-  char section_name[256];
   struct cfg_section_type *section, *section_it;
-  struct cfg_named_section *named, *named_it;
-  struct cfg_entry *entry, *entry_it;
-
-  struct cfg_schema_section *schema_section;
-  struct cfg_schema_section *schema_section_first, *schema_section_last;
-
   bool error = false;
-  bool warning = false;
-  bool hasName = false;
 
   if (db->schema == NULL) {
     return -1;
   }
 
   CFG_FOR_ALL_SECTION_TYPES(db, section, section_it) {
-    /* check for missing schema sections */
-    schema_section_first = avl_find_element(&db->schema->sections, section->type,
-        schema_section_first, _section_node);
+    error = _validate_sectiontype(db, section, NULL,
+        cleanup, ignore_unknown_sections, error, out);
+  }
 
-    if (schema_section_first == NULL) {
-      if (ignore_unknown_sections) {
-        continue;
-      }
+  error |= _check_mandatory_sections(db, out);
+  return error ? -1 : 0;
+}
 
-      cfg_append_printable_line(out,
-          "Cannot find schema for section type '%s'", section->type);
+/**
+ * Validates the named sections of a database recorded in its dirty
+ * tree. Falls back to cfg_schema_validate() if the dirty tree is
+ * incomplete.
+ * @param db pointer to configuration database
+ * @param cleanup if true, bad values will be removed from the database
+ * @param ignore_unknown_sections true if the validation should skip sections
+ *   in the database that have no schema.
+ * @param out autobuffer for validation output
+ * @return 0 if validation found no problems, -1 otherwise
+ */
+int
+cfg_schema_validate_dirty(struct cfg_db *db,
+    bool cleanup, bool ignore_unknown_sections,
+    struct autobuf *out) {
+  struct cfg_db_dirty *dirty, *dirty_it;
+  struct cfg_section_type *section;
+  struct cfg_named_section *named;
+  bool error = false;
 
-      if (cleanup) {
-        cfg_db_remove_sectiontype(db, section->type);
-      }
+  if (db->schema == NULL) {
+    return -1;
+  }
+  if (db->dirty_all) {
+    return cfg_schema_validate(db, cleanup, ignore_unknown_sections, out);
+  }
 
-      error |= true;
+  CFG_FOR_ALL_DIRTY_SECTIONS(db, dirty, dirty_it) {
+    section = cfg_db_find_sectiontype(db, dirty->key.type);
+    if (section == NULL) {
+      /* section type has been removed */
       continue;
     }
 
-    schema_section_last = avl_find_le_element(&db->schema->sections, section->type,
-        schema_section_last, _section_node);
-
-    /* iterate over all schema for a certain section type */
-    avl_for_element_range(schema_section_first, schema_section_last, schema_section, _section_node) {
-      /* check data of named sections in db */
-      CFG_FOR_ALL_SECTION_NAMES(section, named, named_it) {
-        warning = false;
-        hasName = cfg_db_is_named_section(named);
-
-        if (hasName) {
-          if (schema_section->mode == CFG_SSMODE_UNNAMED
-              || schema_section->mode == CFG_SSMODE_UNNAMED_OPTIONAL_STARTUP_TRIGGER) {
-            cfg_append_printable_line(out, "The section type '%s'"
-                " has to be used without a name"
-                " ('%s' was given as a name)", section->type, named->name);
-
-            warning = true;
-          }
-        }
-
-        if (hasName && !cfg_is_allowed_key(named->name, true)) {
-          cfg_append_printable_line(out, "The section name '%s' for"
-              " type '%s' contains illegal characters",
-              named->name, section->type);
-          warning = true;
-        }
-
-        /* test abort condition */
-        if (warning && cleanup) {
-          /* remove bad named section */
-          cfg_db_remove_namedsection(db, section->type, named->name);
-        }
-
-        error |= warning;
-
-        if (warning) {
-          continue;
-        }
-
-        /* initialize section_name field for validate */
-        snprintf(section_name, sizeof(section_name), "'%s%s%s'",
-            section->type, hasName ? "=" : "", hasName ? named->name : "");
-
-        /* check for bad values */
-        CFG_FOR_ALL_ENTRIES(named, entry, entry_it) {
-          warning = _validate_cfg_entry(
-              db, section, named, entry, section_name,
-              cleanup, out);
-          error |= warning;
-        }
-
-        /* check for missing values */
-        warning = _check_missing_entries(schema_section, db, named, section_name, out);
-        error |= warning;
-
-        /* check custom section validation if everything was fine */
-        if (!error && schema_section->cb_validate != NULL) {
-          if (schema_section->cb_validate(section_name, named, out)) {
-            error = true;
-          }
-        }
-      }
-    }
-    if (cleanup && avl_is_empty(&section->names)) {
-      /* if section type is empty, remove it too */
-      cfg_db_remove_sectiontype(db, section->type);
-    }
-  }
-
-  /* search for missing mandatory sections */
-  avl_for_each_element(&db->schema->sections, schema_section, _section_node) {
-    if (schema_section->mode != CFG_SSMODE_NAMED_MANDATORY) {
+    named = cfg_db_get_named_section(section, dirty->key.name);
+    if (named == NULL) {
+      /* named section has been removed */
       continue;
     }
 
-    section = cfg_db_find_sectiontype(db, schema_section->type);
-    if (section == NULL || avl_is_empty(&section->names)) {
-      warning = true;
-    }
-    else {
-      named = avl_first_element(&section->names, named, node);
-      warning = !cfg_db_is_named_section(named) && section->names.count < 2;
-    }
-    if (warning) {
-      cfg_append_printable_line(out, "Missing mandatory section of type '%s'",
-          schema_section->type);
-    }
-    error |= warning;
+    error = _validate_sectiontype(db, section, named,
+        cleanup, ignore_unknown_sections, error, out);
   }
+
+  error |= _check_mandatory_sections(db, out);
   return error ? -1 : 0;
 }
 
@@ -325,6 +283,7 @@ cfg_schema_tobin(void *target, struct cfg_named_section *named,
   char *ptr;
   size_t i;
   const struct const_strarray *value;
+  struct cfg_entry *entry;
 
   ptr = (char *)target;
 
@@ -333,6 +292,14 @@ cfg_schema_tobin(void *target, struct cfg_named_section *named,
       continue;
     }
 
+    /* use cached binary value if possible */
+    entry = named == NULL ? NULL : _get_value_entry(named, &entries[i]);
+    if (entry != NULL && _update_bincache(entry, &entries[i]) == 0) {
+      memcpy(ptr + entries[i].bin_offset,
+          &entry->_bincache.value, entry->_bincache.size);
+      continue;
+    }
+
     value = cfg_schema_tovalue(named, &entries[i]);
     if (entries[i].cb_to_binary(&entries[i], value, ptr + entries[i].bin_offset)) {
       /* error in conversion */
@@ -378,6 +345,75 @@ cfg_schema_handle_db_changes(struct cfg_db *pre_change, struct cfg_db *post_chan
   return _handle_db_changes(pre_change, post_change, false);
 }
 
+/**
+ * Compare two databases with the same schema and call the change
+ * listeners, but only check the named sections recorded in the dirty
+ * tree of a third database. Falls back to cfg_schema_handle_db_changes()
+ * if the dirty tree is incomplete.
+ * @param pre_change database before change
+ * @param post_change database after change
+ * @param changes database that recorded all changes between
+ *   pre_change and post_change in its dirty tree
+ * @return -1 if databases have different schema, 0 otherwise
+ */
+int
+cfg_schema_handle_db_dirty_changes(struct cfg_db *pre_change,
+    struct cfg_db *post_change, struct cfg_db *changes) {
+  struct cfg_section_type default_section_type[2];
+  struct cfg_named_section default_named_section[2];
+  struct cfg_schema_section *s_section;
+  struct cfg_db_dirty *first, *dirty;
+  struct cfg_db_dirty_key key;
+  bool whole_type;
+
+  if (changes->dirty_all) {
+    return _handle_db_changes(pre_change, post_change, false);
+  }
+
+  if (pre_change->schema == NULL || pre_change->schema != post_change->schema) {
+    /* no valid schema found */
+    return -1;
+  }
+
+  _init_default_sections(default_section_type, default_named_section,
+      pre_change, post_change);
+
+  avl_for_each_element(&pre_change->schema->handlers, s_section, _delta_node) {
+    key.type = s_section->type;
+    key.name = NULL;
+
+    /* the unnamed section sorts first within a type */
+    first = avl_find_ge_element(&changes->dirty, &key, first, node);
+    if (first == NULL || cfg_cmp_keys(first->key.type, s_section->type) != 0) {
+      /* no change for this section type */
+      continue;
+    }
+
+    /*
+     * the unnamed section provides the defaults for all named ones
+     * and the default named section depends on all others, so
+     * check the whole section type in these cases
+     */
+    whole_type = first->key.name == NULL
+        || s_section->mode == CFG_SSMODE_NAMED_WITH_DEFAULT;
+
+    if (whole_type) {
+      _handle_sectiontype_changes(s_section, pre_change, post_change, false,
+          default_section_type, default_named_section);
+      continue;
+    }
+
+    avl_for_element_to_last(&changes->dirty, first, dirty, node) {
+      if (cfg_cmp_keys(dirty->key.type, s_section->type) != 0) {
+        break;
+      }
+      _handle_named_section_change(s_section, pre_change, post_change,
+          dirty->key.name, false, NULL, NULL);
+    }
+  }
+  return 0;
+}
+
 /**
  * Handle trigger of delta callbacks on program startup. Call every trigger
  * except for CFG_SSMODE_UNNAMED_OPTIONAL_STARTUP_TRIGGER mode.
@@ -733,9 +769,7 @@ cfg_schema_tobin_acl(const struct cfg_schema_entry *s_entry __attribute__((unuse
 
   ptr = (struct netaddr_acl *)reference;
 
-  free(ptr->accept);
-  free(ptr->reject);
-
+  netaddr_acl_remove(ptr);
   return netaddr_acl_from_strarray(ptr, value);
 }
 
@@ -821,18 +855,36 @@ _handle_db_changes(struct cfg_db *pre_change, struct cfg_db *post_change, bool s
   struct cfg_section_type default_section_type[2];
   struct cfg_named_section default_named_section[2];
   struct cfg_schema_section *s_section;
-  struct cfg_section_type *pre_type, *post_type;
-  struct cfg_named_section *pre_named, *post_named, *named_it;
-  struct cfg_named_section * pre_defnamed, *post_defnamed;
 
   if (pre_change->schema == NULL || pre_change->schema != post_change->schema) {
     /* no valid schema found */
     return -1;
   }
 
-  /* initialize default named section mechanism */
-  memset(default_named_section, 0, sizeof(default_named_section));
-  memset(default_section_type, 0, sizeof(default_section_type));
+  _init_default_sections(default_section_type, default_named_section,
+      pre_change, post_change);
+
+  avl_for_each_element(&pre_change->schema->handlers, s_section, _delta_node) {
+    _handle_sectiontype_changes(s_section, pre_change, post_change, startup,
+        default_section_type, default_named_section);
+  }
+  return 0;
+}
+
+/**
+ * Initialize the dummy section types and named sections used for
+ * sections with a default name.
+ * @param default_section_type array of two section types
+ * @param default_named_section array of two named sections
+ * @param pre_change pre-change database
+ * @param post_change post-change database
+ */
+static void
+_init_default_sections(struct cfg_section_type *default_section_type,
+    struct cfg_named_section *default_named_section,
+    struct cfg_db *pre_change, struct cfg_db *post_change) {
+  memset(default_named_section, 0, sizeof(*default_named_section) * 2);
+  memset(default_section_type, 0, sizeof(*default_section_type) * 2);
 
   avl_init(&default_named_section[0].entries, cfg_avlcmp_keys, false);
   avl_init(&default_named_section[1].entries, cfg_avlcmp_keys, false);
@@ -841,77 +893,279 @@ _handle_db_changes(struct cfg_db *pre_change, struct cfg_db *post_change, bool s
 
   default_section_type[0].db = pre_change;
   default_section_type[1].db = post_change;
+}
 
-  avl_for_each_element(&pre_change->schema->handlers, s_section, _delta_node) {
-    /* get section types in both databases */
-    pre_type = cfg_db_find_sectiontype(pre_change, s_section->type);
-    post_type = cfg_db_find_sectiontype(post_change, s_section->type);
+/**
+ * Compare all named sections of one section type in two databases
+ * and trigger the delta listener of a schema section.
+ * @param s_section pointer to schema section with delta listener
+ * @param pre_change pre-change database
+ * @param post_change post-change database
+ * @param startup if true, also trigger unnamed sections which don't change, but are
+ *   of type CFG_SSMODE_UNNAMED (and not CFG_SSMODE_UNNAMED_OPTIONAL_STARTUP_TRIGGER).
+ * @param default_section_type array of two section types
+ *   initialized by _init_default_sections()
+ * @param default_named_section array of two named sections
+ *   initialized by _init_default_sections()
+ */
+static void
+_handle_sectiontype_changes(struct cfg_schema_section *s_section,
+    struct cfg_db *pre_change, struct cfg_db *post_change, bool startup,
+    struct cfg_section_type *default_section_type,
+    struct cfg_named_section *default_named_section) {
+  struct cfg_section_type *pre_type, *post_type;
+  struct cfg_named_section *pre_named, *post_named, *named_it;
+  struct cfg_named_section * pre_defnamed, *post_defnamed;
 
-    /* prepare for default named section */
-    pre_defnamed = NULL;
-    post_defnamed = NULL;
+  /* get section types in both databases */
+  pre_type = cfg_db_find_sectiontype(pre_change, s_section->type);
+  post_type = cfg_db_find_sectiontype(post_change, s_section->type);
 
-    if (s_section->mode == CFG_SSMODE_NAMED_WITH_DEFAULT) {
-      /* check if we need a default section for pre_change db */
-      if (!startup && _section_needs_default_named_one(pre_type)) {
-        /* initialize dummy section type for pre-change db */
-        default_section_type[0].type = s_section->type;
+  /* prepare for default named section */
+  pre_defnamed = NULL;
+  post_defnamed = NULL;
 
-        /* initialize dummy named section for pre-change */
-        default_named_section[0].name = s_section->def_name;
+  if (s_section->mode == CFG_SSMODE_NAMED_WITH_DEFAULT) {
+    /* check if we need a default section for pre_change db */
+    if (!startup && _section_needs_default_named_one(pre_type)) {
+      /* initialize dummy section type for pre-change db */
+      default_section_type[0].type = s_section->type;
 
-        /* remember decision */
-        pre_defnamed = &default_named_section[0];
-      }
+      /* initialize dummy named section for pre-change */
+      default_named_section[0].name = s_section->def_name;
 
-      /* check if we need a default section for post_change db */
-      if (_section_needs_default_named_one(post_type)) {
-        /* initialize dummy section type for post-change db */
-        default_section_type[1].type = s_section->type;
+      /* remember decision */
+      pre_defnamed = &default_named_section[0];
+    }
 
-        /* initialize dummy named section for post-change */
-        default_named_section[1].name = s_section->def_name;
+    /* check if we need a default section for post_change db */
+    if (_section_needs_default_named_one(post_type)) {
+      /* initialize dummy section type for post-change db */
+      default_section_type[1].type = s_section->type;
 
-        /* remember decision */
-        post_defnamed = &default_named_section[1];
-      }
+      /* initialize dummy named section for post-change */
+      default_named_section[1].name = s_section->def_name;
+
+      /* remember decision */
+      post_defnamed = &default_named_section[1];
+    }
+  }
+
+  if (post_type) {
+    /* handle new named sections and changes */
+    pre_named = NULL;
+    CFG_FOR_ALL_SECTION_NAMES(post_type, post_named, named_it) {
+      _handle_named_section_change(s_section, pre_change, post_change,
+          post_named->name, startup, pre_defnamed, post_defnamed);
     }
+  }
+  if (pre_type) {
+    /* handle removed named sections */
+    post_named = NULL;
+    CFG_FOR_ALL_SECTION_NAMES(pre_type, pre_named, named_it) {
+      if (post_type) {
+        post_named = cfg_db_get_named_section(post_type, pre_named->name);
+      }
 
-    if (post_type) {
-      /* handle new named sections and changes */
-      pre_named = NULL;
-      CFG_FOR_ALL_SECTION_NAMES(post_type, post_named, named_it) {
+      if (!post_named) {
         _handle_named_section_change(s_section, pre_change, post_change,
-            post_named->name, startup, pre_defnamed, post_defnamed);
+            pre_named->name, startup, pre_defnamed, post_defnamed);
       }
     }
-    if (pre_type) {
-      /* handle removed named sections */
-      post_named = NULL;
-      CFG_FOR_ALL_SECTION_NAMES(pre_type, pre_named, named_it) {
-        if (post_type) {
-          post_named = cfg_db_get_named_section(post_type, pre_named->name);
-        }
-
-        if (!post_named) {
-          _handle_named_section_change(s_section, pre_change, post_change,
-              pre_named->name, startup, pre_defnamed, post_defnamed);
-        }
+  }
+  if (startup && s_section->mode == CFG_SSMODE_UNNAMED
+      && pre_type == NULL && post_type == NULL) {
+    /* send change signal on startup for unnamed section */
+    _handle_named_section_change(s_section, pre_change, post_change, NULL, true,
+        pre_defnamed, post_defnamed);
+  }
+  if ((pre_defnamed != NULL) != (post_defnamed != NULL)) {
+    /* status of default named section changed */
+    _handle_named_section_change(s_section, pre_change, post_change,
+        s_section->def_name, true, pre_defnamed, post_defnamed);
+  }
+}
+
+/**
+ * Validates one section type of a database, or a single named
+ * section of it.
+ * @param db pointer to configuration database
+ * @param section pointer to section type
+ * @param named pointer to named section, NULL to validate all
+ *   named sections of the type
+ * @param cleanup if true, bad values will be removed from the database
+ * @param ignore_unknown_sections true if the validation should skip sections
+ *   in the database that have no schema.
+ * @param error true if the validation already found an error
+ * @param out autobuffer for validation output
+ * @return true if an error happened (now or before), false otherwise
+ */
+static bool
+_validate_sectiontype(struct cfg_db *db,
+    struct cfg_section_type *section, struct cfg_named_section *named,
+    bool cleanup, bool ignore_unknown_sections, bool error,
+    struct autobuf *out) {
+  struct cfg_schema_section *schema_section;
+  struct cfg_schema_section *schema_section_first, *schema_section_last;
+  struct cfg_named_section *named_it, *named_ptr;
+
+  /* check for missing schema sections */
+  schema_section_first = avl_find_element(&db->schema->sections, section->type,
+      schema_section_first, _section_node);
+
+  if (schema_section_first == NULL) {
+    if (ignore_unknown_sections) {
+      return error;
+    }
+
+    cfg_append_printable_line(out,
+        "Cannot find schema for section type '%s'", section->type);
+
+    if (cleanup) {
+      cfg_db_remove_sectiontype(db, section->type);
+    }
+    return true;
+  }
+
+  schema_section_last = avl_find_le_element(&db->schema->sections, section->type,
+      schema_section_last, _section_node);
+
+  /* iterate over all schema for a certain section type */
+  avl_for_element_range(schema_section_first, schema_section_last, schema_section, _section_node) {
+    if (named) {
+      if (_validate_named_section(db, schema_section, section, named, cleanup, &error, out)) {
+        /* named section has been removed */
+        break;
       }
+      continue;
     }
-    if (startup && s_section->mode == CFG_SSMODE_UNNAMED
-        && pre_type == NULL && post_type == NULL) {
-      /* send change signal on startup for unnamed section */
-      _handle_named_section_change(s_section, pre_change, post_change, NULL, true,
-          pre_defnamed, post_defnamed);
+
+    /* check data of named sections in db */
+    CFG_FOR_ALL_SECTION_NAMES(section, named_ptr, named_it) {
+      _validate_named_section(db, schema_section, section, named_ptr, cleanup, &error, out);
     }
-    if ((pre_defnamed != NULL) != (post_defnamed != NULL)) {
-      /* status of default named section changed */
-      _handle_named_section_change(s_section, pre_change, post_change,
-          s_section->def_name, true, pre_defnamed, post_defnamed);
+  }
+
+  if (cleanup && avl_is_empty(&section->names)) {
+    /* if section type is empty, remove it too */
+    cfg_db_remove_sectiontype(db, section->type);
+  }
+  return error;
+}
+
+/**
+ * Validates a named section of a database against one schema section
+ * @param db pointer to configuration database
+ * @param schema_section pointer to schema section
+ * @param section pointer to section type
+ * @param named pointer to named section
+ * @param cleanup if true, bad values will be removed from the database
+ * @param error pointer to error flag, will be set to true if
+ *   an error happened
+ * @param out autobuffer for validation output
+ * @return true if the named section was removed, false otherwise
+ */
+static bool
+_validate_named_section(struct cfg_db *db,
+    struct cfg_schema_section *schema_section,
+    struct cfg_section_type *section, struct cfg_named_section *named,
+    bool cleanup, bool *error, struct autobuf *out) {
+  char section_name[256];
+  struct cfg_entry *entry, *entry_it;
+  bool warning = false;
+  bool hasName;
+
+  hasName = cfg_db_is_named_section(named);
+
+  if (hasName) {
+    if (schema_section->mode == CFG_SSMODE_UNNAMED
+        || schema_section->mode == CFG_SSMODE_UNNAMED_OPTIONAL_STARTUP_TRIGGER) {
+      cfg_append_printable_line(out, "The section type '%s'"
+          " has to be used without a name"
+          " ('%s' was given as a name)", section->type, named->name);
+
+      warning = true;
     }
   }
-  return 0;
+
+  if (hasName && !cfg_is_allowed_key(named->name, true)) {
+    cfg_append_printable_line(out, "The section name '%s' for"
+        " type '%s' contains illegal characters",
+        named->name, section->type);
+    warning = true;
+  }
+
+  if (warning) {
+    *error = true;
+
+    /* test abort condition */
+    if (cleanup) {
+      /* remove bad named section */
+      cfg_db_remove_namedsection(db, section->type, named->name);
+      return true;
+    }
+    return false;
+  }
+
+  /* initialize section_name field for validate */
+  snprintf(section_name, sizeof(section_name), "'%s%s%s'",
+      section->type, hasName ? "=" : "", hasName ? named->name : "");
+
+  /* check for bad values */
+  CFG_FOR_ALL_ENTRIES(named, entry, entry_it) {
+    warning = _validate_cfg_entry(
+        db, section, named, entry, section_name,
+        cleanup, out);
+    *error |= warning;
+  }
+
+  /* check for missing values */
+  warning = _check_missing_entries(schema_section, db, named, section_name, out);
+  *error |= warning;
+
+  /* check custom section validation if everything was fine */
+  if (!*error && schema_section->cb_validate != NULL) {
+    if (schema_section->cb_validate(section_name, named, out)) {
+      *error = true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Checks if all mandatory sections of the schema are in a database
+ * @param db pointer to configuration database
+ * @param out autobuffer for validation output
+ * @return true if an error happened, false otherwise
+ */
+static bool
+_check_mandatory_sections(struct cfg_db *db, struct autobuf *out) {
+  struct cfg_schema_section *schema_section;
+  struct cfg_section_type *section;
+  struct cfg_named_section *named;
+  bool warning, error;
+
+  error = false;
+  avl_for_each_element(&db->schema->sections, schema_section, _section_node) {
+    if (schema_section->mode != CFG_SSMODE_NAMED_MANDATORY) {
+      continue;
+    }
+
+    section = cfg_db_find_sectiontype(db, schema_section->type);
+    if (section == NULL || avl_is_empty(&section->names)) {
+      warning = true;
+    }
+    else {
+      named = avl_first_element(&section->names, named, node);
+      warning = !cfg_db_is_named_section(named) && section->names.count < 2;
+    }
+    if (warning) {
+      cfg_append_printable_line(out, "Missing mandatory section of type '%s'",
+          schema_section->type);
+    }
+    error |= warning;
+  }
+  return error;
 }
 
 /**
@@ -966,6 +1220,7 @@ _validate_cfg_entry(struct cfg_db *db, struct cfg_section_type *section,
 
       if ((warning || do_remove) && cleanup) {
         /* illegal entry found, remove it */
+        cfg_db_reset_bincache(entry);
         strarray_remove_ext(&entry->val, ptr1, false);
       }
       else {
@@ -981,6 +1236,10 @@ _validate_cfg_entry(struct cfg_db *db, struct cfg_section_type *section,
       /* remove entry */
       cfg_db_remove_entry(db, section->type, named->name, entry->name);
     }
+    else if (!warning) {
+      /* value is valid, convert it for cfg_schema_tobin() */
+      _update_bincache(entry, schema_entry);
+    }
   }
   return warning;
 }
@@ -1096,3 +1355,87 @@ _handle_named_section_change(struct cfg_schema_section *s_section,
     s_section->cb_delta_handler();
   }
 }
+
+/**
+ * Get the database entry that contains the value for a schema entry,
+ * including the fallback to the unnamed section of the section type.
+ * @param named pointer to named section
+ * @param s_entry pointer to schema entry
+ * @return pointer to database entry, NULL if the schema default is used
+ */
+static struct cfg_entry *
+_get_value_entry(struct cfg_named_section *named,
+    const struct cfg_schema_entry *s_entry) {
+  struct cfg_entry *entry;
+
+  entry = cfg_db_get_entry(named, s_entry->key.entry);
+  if (entry == NULL && named->name != NULL) {
+    entry = cfg_db_find_entry(named->section_type->db,
+        named->section_type->type, NULL, s_entry->key.entry);
+  }
+  return entry;
+}
+
+/**
+ * Get the size of the binary value of a schema entry that can be
+ * stored in the binary cache of a database entry.
+ * @param s_entry pointer to schema entry
+ * @return number of bytes of binary value, 0 if the converter
+ *   cannot be cached because it allocates memory
+ */
+static size_t
+_get_bincache_size(const struct cfg_schema_entry *s_entry) {
+  if (s_entry->cb_to_binary == cfg_schema_tobin_int) {
+    return s_entry->validate_param[2].i16[0];
+  }
+  if (s_entry->cb_to_binary == cfg_schema_tobin_netaddr) {
+    return sizeof(struct netaddr);
+  }
+  if (s_entry->cb_to_binary == cfg_schema_tobin_bool) {
+    return sizeof(bool);
+  }
+  if (s_entry->cb_to_binary == cfg_schema_tobin_choice) {
+    return sizeof(int);
+  }
+  return 0;
+}
+
+/**
+ * Make sure the binary cache of a database entry contains the
+ * value converted by a schema entry.
+ * @param entry pointer to database entry
+ * @param s_entry pointer to schema entry
+ * @return 0 if the binary cache is valid, -1 if the value
+ *   cannot be cached or the conversion failed
+ */
+static int
+_update_bincache(struct cfg_entry *entry,
+    const struct cfg_schema_entry *s_entry) {
+  struct cfg_entry_bincache *cache;
+  size_t size;
+
+  cache = &entry->_bincache;
+  if (cache->cb_to_binary != NULL
+      && cache->cb_to_binary == s_entry->cb_to_binary
+      && memcmp(cache->param, s_entry->validate_param, sizeof(cache->param)) == 0) {
+    /* cache hit */
+    return 0;
+  }
+
+  size = _get_bincache_size(s_entry);
+  if (size == 0 || size > sizeof(cache->value)) {
+    return -1;
+  }
+
+  cfg_db_reset_bincache(entry);
+  memset(&cache->value, 0, sizeof(cache->value));
+  if (s_entry->cb_to_binary(s_entry,
+      (const struct const_strarray *)&entry->val, &cache->value)) {
+    return -1;
+  }
+
+  cache->cb_to_binary = s_entry->cb_to_binary;
+  memcpy(cache->param, s_entry->validate_param, sizeof(cache->param));
+  cache->size = size;
+  return 0;
+}
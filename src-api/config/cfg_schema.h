@@ -183,6 +183,9 @@ struct cfg_schema {
 
   /* tree of delta handlers of this schema */
   struct avl_tree handlers;
+
+  /* incremented every time a section is added to or removed from the schema */
+  uint32_t revision;
 };
 
 enum cfg_schema_section_mode {
@@ -344,6 +347,8 @@ EXPORT void cfg_schema_remove_section(struct cfg_schema *schema, struct cfg_sche
 
 EXPORT int cfg_schema_validate(struct cfg_db *db,
     bool cleanup, bool ignore_unknown_sections, struct autobuf *out);
+EXPORT int cfg_schema_validate_dirty(struct cfg_db *db,
+    bool cleanup, bool ignore_unknown_sections, struct autobuf *out);
 
 EXPORT int cfg_schema_tobin(void *target, struct cfg_named_section *named,
     const struct cfg_schema_entry *entries, size_t count);
@@ -351,6 +356,8 @@ EXPORT const struct const_strarray *cfg_schema_tovalue(struct cfg_named_section
     const struct cfg_schema_entry *entry);
 
 EXPORT int cfg_schema_handle_db_changes(struct cfg_db *pre_change, struct cfg_db *post_change);
+EXPORT int cfg_schema_handle_db_dirty_changes(struct cfg_db *pre_change,
+    struct cfg_db *post_change, struct cfg_db *changes);
 EXPORT int cfg_schema_handle_db_startup_changes(struct cfg_db *db);
 
 EXPORT int cfg_avlcmp_schemaentries(const void *p1, const void *p2);
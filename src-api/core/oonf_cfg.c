@@ -60,6 +60,9 @@ static struct cfg_db *_oonf_work_db = NULL;
 static struct cfg_schema _oonf_schema;
 static bool _first_apply;
 
+/* schema revision of the last applied configuration */
+static uint32_t _schema_revision;
+
 /* remember to trigger reload/commit and the running state */
 static bool _trigger_reload, _trigger_commit;
 static bool _running = true;
@@ -131,6 +134,7 @@ oonf_cfg_init(int argc, char **argv) {
   }
 
   cfg_db_link_schema(_oonf_raw_db, &_oonf_schema);
+  cfg_db_track_changes(_oonf_raw_db, true);
 
   /* initialize global config */
   memset(&config_global, 0, sizeof(config_global));
@@ -306,6 +310,7 @@ int
 oonf_cfg_apply(void) {
   struct cfg_db *old_db;
   struct autobuf log;
+  bool full_check;
   int result;
 
   if (abuf_init(&log)) {
@@ -324,8 +329,16 @@ oonf_cfg_apply(void) {
   }
 
   /*** phase 2: check configuration and apply it ***/
+  /*
+   * only check the sections changed since the last commit, unless
+   * this is the first one or the schema has changed since then
+   */
+  full_check = _first_apply || _schema_revision != _oonf_schema.revision;
+
   /* validate configuration data */
-  if (cfg_schema_validate(_oonf_raw_db, false, true, &log)) {
+  if (full_check
+      ? cfg_schema_validate(_oonf_raw_db, false, true, &log)
+      : cfg_schema_validate_dirty(_oonf_raw_db, false, true, &log)) {
     OONF_WARN(LOG_CONFIG, "Configuration validation failed");
     OONF_WARN_NH(LOG_CONFIG, "%s", abuf_getptr(&log));
     goto apply_failed;
@@ -334,8 +347,16 @@ oonf_cfg_apply(void) {
   /* backup old db */
   old_db = _oonf_work_db;
 
-  /* create new configuration database with correct values */
-  _oonf_work_db = cfg_db_duplicate(_oonf_raw_db);
+  /*
+   * create new configuration database, the section types without
+   * changes are taken over from the old one
+   */
+  if (full_check) {
+    _oonf_work_db = cfg_db_duplicate(_oonf_raw_db);
+  }
+  else {
+    _oonf_work_db = cfg_db_duplicate_dirty(_oonf_raw_db, old_db);
+  }
   if (_oonf_work_db == NULL) {
     OONF_WARN(LOG_CONFIG, "Not enough memory for duplicating work db");
     _oonf_work_db = old_db;
@@ -346,8 +367,20 @@ oonf_cfg_apply(void) {
   /* bind schema */
   cfg_db_link_schema(_oonf_work_db, &_oonf_schema);
 
-  /* remove everything not valid */
-  cfg_schema_validate(_oonf_work_db, true, false, NULL);
+  /*
+   * remove everything not valid from both databases, the raw db is
+   * the working copy of the committed settings afterwards
+   */
+  if (full_check) {
+    cfg_schema_validate(_oonf_work_db, true, false, NULL);
+    cfg_schema_validate(_oonf_raw_db, true, false, NULL);
+  }
+  else {
+    cfg_schema_validate_dirty(_oonf_work_db, true, false, NULL);
+    cfg_schema_validate_dirty(_oonf_raw_db, true, false, NULL);
+  }
+  cfg_db_track_changes(_oonf_work_db, false);
+  cfg_db_clear_dirty(_oonf_work_db);
 
   if (oonf_cfg_update_globalcfg(false)) {
     /* this should not happen at all */
@@ -360,19 +393,21 @@ oonf_cfg_apply(void) {
     cfg_schema_handle_db_startup_changes(_oonf_work_db);
     _first_apply = false;
   }
-  else {
+  else if (full_check) {
     cfg_schema_handle_db_changes(old_db, _oonf_work_db);
   }
+  else {
+    cfg_schema_handle_db_dirty_changes(old_db, _oonf_work_db, _oonf_raw_db);
+  }
 
   /* success */
   result = 0;
   _trigger_reload = false;
   _trigger_commit = false;
 
-  /* now get a new working copy of the committed settings */
-  cfg_db_remove(_oonf_raw_db);
-  _oonf_raw_db = cfg_db_duplicate(_oonf_work_db);
-  cfg_db_link_schema(_oonf_raw_db, &_oonf_schema);
+  /* raw db and work db are the same now */
+  cfg_db_clear_dirty(_oonf_raw_db);
+  _schema_revision = _oonf_schema.revision;
 
 apply_failed:
   if (old_db) {
@@ -402,6 +437,8 @@ oonf_cfg_rollback(void) {
     _oonf_raw_db = db;
     return -1;
   }
+  cfg_db_link_schema(_oonf_raw_db, &_oonf_schema);
+  cfg_db_track_changes(_oonf_raw_db, true);
 
   /* free old db */
   cfg_db_remove(db);
@@ -442,6 +479,11 @@ oonf_cfg_clear_rawdb(void) {
     _oonf_raw_db = db;
     return -1;
   }
+  cfg_db_link_schema(_oonf_raw_db, &_oonf_schema);
+
+  /* everything in the work db has been removed */
+  cfg_db_track_changes(_oonf_raw_db, true);
+  _oonf_raw_db->dirty_all = true;
 
   /* free old db */
   cfg_db_remove(db);
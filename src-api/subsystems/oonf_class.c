@@ -47,6 +47,7 @@
 #include "core/oonf_logging.h"
 #include "core/oonf_subsystem.h"
 #include "subsystems/oonf_class.h"
+#include "subsystems/os_clock.h"
 
 /* prototypes */
 static int _init(void);
@@ -347,17 +348,28 @@ oonf_class_extension_remove(struct oonf_class_extension *ext) {
  * @param c pointer to class
  * @param ptr pointer to object
  * @param evt type of event
+ * @param changes provider specific bitmask of changes for
+ *   OONF_OBJECT_CHANGED events, OONF_CLASS_CHANGE_ALL if unknown
  */
 void
-oonf_class_event(struct oonf_class *c, void *ptr, enum oonf_class_event evt) {
+oonf_class_event_ext(struct oonf_class *c, void *ptr,
+    enum oonf_class_event evt, uint32_t changes) {
   struct oonf_class_extension *ext;
+  uint64_t start, end;
 #ifdef OONF_LOG_DEBUG_INFO
   struct oonf_objectkey_str buf;
 #endif
 
-  OONF_DEBUG(LOG_CLASS, "Fire '%s' event for %s",
-      OONF_CLASS_EVENT_NAME[evt], c->to_keystring(&buf, c, ptr));
+  OONF_DEBUG(LOG_CLASS, "Fire '%s' event for %s (changes 0x%08x)",
+      OONF_CLASS_EVENT_NAME[evt], c->to_keystring(&buf, c, ptr), changes);
   list_for_each_element(&c->_extensions, ext, _node) {
+    if (evt == OONF_OBJECT_CHANGED && ext->change_filter != 0
+        && (ext->change_filter & changes) == 0) {
+      ext->filtered_count++;
+      continue;
+    }
+
+    os_clock_gettime64_usec(&start);
     if (evt == OONF_OBJECT_ADDED && ext->cb_add != NULL) {
       OONF_DEBUG(LOG_CLASS, "Fire listener %s", ext->ext_name);
       ext->cb_add(ptr);
@@ -366,10 +378,21 @@ oonf_class_event(struct oonf_class *c, void *ptr, enum oonf_class_event evt) {
       OONF_DEBUG(LOG_CLASS, "Fire listener %s", ext->ext_name);
       ext->cb_remove(ptr);
     }
+    else if (evt == OONF_OBJECT_CHANGED && ext->cb_change_mask != NULL) {
+      OONF_DEBUG(LOG_CLASS, "Fire listener %s", ext->ext_name);
+      ext->cb_change_mask(ptr, changes);
+    }
     else if (evt == OONF_OBJECT_CHANGED && ext->cb_change != NULL) {
       OONF_DEBUG(LOG_CLASS, "Fire listener %s", ext->ext_name);
       ext->cb_change(ptr);
     }
+    else {
+      continue;
+    }
+    os_clock_gettime64_usec(&end);
+
+    ext->callback_count++;
+    ext->callback_time += end - start;
   }
   OONF_DEBUG(LOG_CLASS, "Fire event finished");
 }
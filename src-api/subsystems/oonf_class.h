@@ -52,6 +52,9 @@ enum oonf_class_event {
   OONF_OBJECT_REMOVED,
 };
 
+/* change bitmask for events without information about the changed data */
+#define OONF_CLASS_CHANGE_ALL (~(uint32_t)0)
+
 struct oonf_objectkey_str {
   char buf[128];
 };
@@ -126,9 +129,30 @@ struct oonf_class_extension {
   /* callback for 'cb_change object' event */
   void (*cb_change)(void *);
 
+  /*
+   * callback for 'cb_change object' event with the bitmask of
+   * changes reported by the provider, used instead of cb_change
+   * if set
+   */
+  void (*cb_change_mask)(void *, uint32_t changes);
+
   /* callback for 'cb_remove object' event */
   void (*cb_remove)(void *);
 
+  /*
+   * bitmask of changes the consumer is interested in, change events
+   * that do not intersect the filter are not delivered. 0 delivers
+   * all change events.
+   */
+  uint32_t change_filter;
+
+  /* number of delivered events and their total runtime in microseconds */
+  uint64_t callback_count;
+  uint64_t callback_time;
+
+  /* number of change events skipped because of the change filter */
+  uint64_t filtered_count;
+
   /* node for hooking the consumer into the provider */
   struct list_entity _node;
 };
@@ -155,7 +179,19 @@ EXPORT void oonf_class_free(struct oonf_class *, void *);
 EXPORT int oonf_class_extension_add(struct oonf_class_extension *);
 EXPORT void oonf_class_extension_remove(struct oonf_class_extension *);
 
-EXPORT void oonf_class_event(struct oonf_class *, void *, enum oonf_class_event);
+EXPORT void oonf_class_event_ext(struct oonf_class *, void *,
+    enum oonf_class_event, uint32_t changes);
+
+/**
+ * Fire an event for a class without information about the changed data
+ * @param c pointer to class
+ * @param ptr pointer to object
+ * @param evt type of event
+ */
+static INLINE void
+oonf_class_event(struct oonf_class *c, void *ptr, enum oonf_class_event evt) {
+  oonf_class_event_ext(c, ptr, evt, OONF_CLASS_CHANGE_ALL);
+}
 
 /**
  * @param ci pointer to class
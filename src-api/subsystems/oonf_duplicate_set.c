@@ -39,9 +39,9 @@
  *
  */
 
-#include "common/avl.h"
 #include "common/avl_comp.h"
 #include "common/common_types.h"
+#include "common/hash_table.h"
 #include "common/netaddr.h"
 #include "rfc5444/rfc5444.h"
 #include "core/oonf_subsystem.h"
@@ -56,6 +56,7 @@ static void _cleanup(void);
 static enum oonf_duplicate_result _test(struct oonf_duplicate_entry *,
     uint16_t seqno, bool set);
 static int _avl_cmp_dupkey(const void *, const void*);
+static uint32_t _hash_dupkey(const void *);
 
 static void _cb_vtime(void *);
 
@@ -112,7 +113,7 @@ _cleanup(void) {
  */
 void
 oonf_duplicate_set_add(struct oonf_duplicate_set *set) {
-  avl_init(&set->_tree, _avl_cmp_dupkey, false);
+  hash_table_init(&set->_table, _hash_dupkey, _avl_cmp_dupkey);
 }
 
 /**
@@ -123,9 +124,10 @@ void
 oonf_duplicate_set_remove(struct oonf_duplicate_set *set) {
   struct oonf_duplicate_entry *entry, *it;
 
-  avl_for_each_element_safe(&set->_tree, entry, _node, it) {
+  hash_table_for_each_element_safe(&set->_table, entry, _node, it) {
     _cb_vtime(entry);
   }
+  hash_table_free(&set->_table);
 }
 
 /**
@@ -156,13 +158,21 @@ oonf_duplicate_entry_add(struct oonf_duplicate_set *set, uint8_t msg_type,
   memcpy(&key.addr, originator, sizeof(*originator));
   key.msg_type = msg_type;
 
-  entry = avl_find_element(&set->_tree, &key, entry, _node);
+  entry = hash_table_find_element(&set->_table, &key, entry, _node);
   if (!entry) {
     entry = oonf_class_malloc(&_dupset_class);
     if (entry == NULL) {
       return OONF_DUPSET_TOO_OLD;
     }
 
+    /* set key and link entry to set */
+    memcpy(&entry->key, &key, sizeof(key));
+    entry->_node.key = &entry->key;
+    if (hash_table_insert(&set->_table, &entry->_node)) {
+      oonf_class_free(&_dupset_class, entry);
+      return OONF_DUPSET_TOO_OLD;
+    }
+
     /* initialize history and current sequence number */
     entry->current = seqno;
     entry->history = 1;
@@ -176,11 +186,6 @@ oonf_duplicate_entry_add(struct oonf_duplicate_set *set, uint8_t msg_type,
 
     oonf_timer_start(&entry->_vtime, vtime);
 
-    /* set key and link entry to set */
-    memcpy(&entry->key, &key, sizeof(key));
-    entry->_node.key = &entry->key;
-    avl_insert(&set->_tree, &entry->_node);
-
     result = OONF_DUPSET_FIRST;
   }
   else {
@@ -223,7 +228,7 @@ oonf_duplicate_test(struct oonf_duplicate_set *set, uint8_t msg_type,
   memcpy(&key.addr, originator, sizeof(*originator));
   key.msg_type = msg_type;
 
-  entry = avl_find_element(&set->_tree, &key, entry, _node);
+  entry = hash_table_find_element(&set->_table, &key, entry, _node);
   if (!entry) {
     result = OONF_DUPSET_FIRST;
   }
@@ -328,6 +333,20 @@ _avl_cmp_dupkey(const void *p1, const void *p2) {
   return avl_comp_netaddr(&k1->addr, &k2->addr);
 }
 
+/**
+ * Hash function for duplicate entry keys
+ * @param p pointer to key
+ * @return hash value
+ */
+static uint32_t
+_hash_dupkey(const void *p) {
+  const struct oonf_duplicate_entry_key *k = p;
+  uint32_t msg_type;
+
+  msg_type = k->msg_type;
+  return hash_table_hash_netaddr(&k->addr) ^ hash_table_hash_uint32(&msg_type);
+}
+
 /**
  * Callback fired when duplicate entry times out
  * @param ptr pointer to duplicate entry
@@ -342,7 +361,7 @@ _cb_vtime(void *ptr) {
   OONF_DEBUG(LOG_DUPLICATE_SET, "Duplicate entry timed out: %s/%u",
       netaddr_to_string(&nbuf, &entry->key.addr), entry->key.msg_type);
   oonf_timer_stop(&entry->_vtime);
-  avl_remove(&entry->set->_tree, &entry->_node);
+  hash_table_remove(&entry->set->_table, &entry->_node);
 
   oonf_class_free(&_dupset_class, entry);
 }
@@ -42,8 +42,8 @@
 #ifndef OONF_DUPLICATE_SET_H_
 #define OONF_DUPLICATE_SET_H_
 
-#include "common/avl.h"
 #include "common/common_types.h"
+#include "common/hash_table.h"
 #include "common/netaddr.h"
 #include "subsystems/oonf_timer.h"
 
@@ -62,7 +62,7 @@ enum oonf_duplicate_result {
 };
 
 struct oonf_duplicate_set {
-  struct avl_tree _tree;
+  struct hash_table _table;
 };
 
 struct oonf_duplicate_entry_key {
@@ -80,7 +80,7 @@ struct oonf_duplicate_entry {
 
   struct oonf_duplicate_set *set;
 
-  struct avl_node _node;
+  struct hash_node _node;
   struct oonf_timer_entry _vtime;
 };
 
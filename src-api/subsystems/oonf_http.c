@@ -52,8 +52,47 @@
 #include "core/oonf_logging.h"
 #include "core/oonf_subsystem.h"
 #include "core/os_core.h"
+#include "subsystems/oonf_class.h"
 #include "subsystems/oonf_http.h"
 #include "subsystems/oonf_stream_socket.h"
+#include "subsystems/os_clock.h"
+
+/* one segment of the URI path in the http routing trie */
+struct _http_path_node {
+  /* node for tree of child segments of the parent */
+  struct avl_node _node;
+
+  /* name of the segment, ':' prefix for a path parameter */
+  char *segment;
+
+  /* parent segment, NULL for the root node */
+  struct _http_path_node *parent;
+
+  /* tree of child segments with fixed names */
+  struct avl_tree children;
+
+  /* child segment that matches any value, NULL if not set */
+  struct _http_path_node *param_child;
+
+  /* handler for the path itself and for everything below it */
+  struct oonf_http_handler *site;
+  struct oonf_http_handler *directory;
+};
+
+/* TCP session with http specific state */
+struct _http_connection {
+  /* stream session, must be the first element */
+  struct oonf_stream_session session;
+
+  /* copy of the http session data of a streaming answer */
+  struct oonf_http_session http;
+
+  /* true if the answer is generated block by block */
+  bool streaming;
+
+  /* true if the streaming answer uses chunked transfer encoding */
+  bool chunked;
+};
 
 /* Http text constants */
 static const char HTTP_VERSION_1_0[] = "HTTP/1.0";
@@ -67,6 +106,8 @@ static const char HTTP_POST[] = "POST";
 
 static const char HTTP_CONTENT_LENGTH[] = "Content-Length";
 
+static const char HTTP_LAST_CHUNK[] = "0\r\n\r\n";
+
 static const char HTTP_RESPONSE_200[] = "OK";
 static const char HTTP_RESPONSE_400[] = "Bad Request";
 static const char HTTP_RESPONSE_401[] = "Unauthorized";
@@ -82,15 +123,25 @@ static int _init(void);
 static void _cleanup(void);
 
 static void _cb_config_changed(void);
+static void _cb_cleanup(struct oonf_stream_session *session);
 static enum oonf_stream_session_state _cb_receive_data(
     struct oonf_stream_session *session);
+static enum oonf_stream_session_state _cb_buffer_underrun(
+    struct oonf_stream_session *session);
 static void _cb_create_error(struct oonf_stream_session *session,
     enum oonf_stream_errors error);
 static bool _auth_okay(struct oonf_http_handler *handler,
     struct oonf_http_session *session);
 static void _create_http_error(struct oonf_stream_session *session,
     enum oonf_http_result error);
-static struct oonf_http_handler *_get_site_handler(const char *uri);
+static struct _http_path_node *_add_path_node(
+    struct _http_path_node *parent, const char *segment);
+static struct _http_path_node *_find_path_node(const char *site);
+static void _remove_path_node(struct _http_path_node *node);
+static enum oonf_stream_session_state _start_http_stream(
+    struct _http_connection *connection, struct oonf_http_session *header);
+static void _stop_http_stream(struct _http_connection *connection);
+static void _create_http_chunk(struct _http_connection *connection);
 static const char *_get_headertype_string(enum oonf_http_result type);
 static void _create_http_header(struct oonf_stream_session *session,
     enum oonf_http_result code, const char *content_type);
@@ -110,6 +161,13 @@ static struct cfg_schema_entry _http_entries[] = {
       bindto_v6, "bindto_v6", "::1", "Bind http ipv6 socket to this address", false, true),
   CFG_MAP_INT32_MINMAX(oonf_stream_managed_config,
       port, "port", "1978", "Network port for http interface", 0, false, 1, 65535),
+  CFG_MAP_INT32_MINMAX(oonf_stream_managed_config,
+      accept_rate, "accept_rate", "10",
+      "Maximum number of new connections per second for http interface, 0 for no limit", 0, false, 0, 65535),
+  CFG_MAP_INT32_MINMAX(oonf_stream_managed_config,
+      accept_burst, "accept_burst", "20",
+      "Maximum number of new connections for http interface accepted at once after an idle period,"
+      " 0 to use accept_rate", 0, false, 0, 65535),
 };
 
 static struct cfg_schema_section _http_section = {
@@ -122,15 +180,32 @@ static struct cfg_schema_section _http_section = {
 };
 
 /* tree of http sites */
-static struct avl_tree _http_site_tree;
+struct avl_tree oonf_http_site_tree;
+
+/* routing trie of http sites, the root represents "/" */
+static struct _http_path_node _http_path_root;
+
+static struct oonf_class _http_path_memcookie = {
+  .name = "http path segment",
+  .size = sizeof(struct _http_path_node),
+};
 
 /* http session handling */
+static struct oonf_class _http_memcookie = {
+  .name = "http session",
+  .size = sizeof(struct _http_connection),
+  .to_keystring = oonf_stream_session_to_keystring,
+};
+
 static struct oonf_stream_managed _http_managed_socket = {
   .config = {
     .session_timeout = 120000, /* 120 seconds */
     .maximum_input_buffer = 65536,
     .allowed_sessions = 3,
+    .memcookie = &_http_memcookie,
+    .cleanup = _cb_cleanup,
     .receive_data = _cb_receive_data,
+    .buffer_underrun = _cb_buffer_underrun,
     .create_error = _cb_create_error,
   },
 };
@@ -149,8 +224,13 @@ struct oonf_subsystem oonf_http_subsystem = {
  */
 static int
 _init(void) {
+  oonf_class_add(&_http_memcookie);
+  oonf_class_add(&_http_path_memcookie);
   oonf_stream_add_managed(&_http_managed_socket);
-  avl_init(&_http_site_tree, avl_comp_strcasecmp, false);
+  avl_init(&oonf_http_site_tree, avl_comp_strcasecmp, false);
+
+  memset(&_http_path_root, 0, sizeof(_http_path_root));
+  avl_init(&_http_path_root.children, avl_comp_strcasecmp, false);
   return 0;
 }
 
@@ -159,7 +239,15 @@ _init(void) {
  */
 void
 _cleanup(void) {
+  struct oonf_http_handler *handler, *it;
+
+  avl_for_each_element_safe(&oonf_http_site_tree, handler, node, it) {
+    oonf_http_remove(handler);
+  }
+
   oonf_stream_remove_managed(&_http_managed_socket, true);
+  oonf_class_remove(&_http_path_memcookie);
+  oonf_class_remove(&_http_memcookie);
 }
 
 /**
@@ -169,11 +257,55 @@ _cleanup(void) {
  */
 void
 oonf_http_add(struct oonf_http_handler *handler) {
+  struct _http_path_node *node, *child;
+  char path[OONF_HTTP_MAX_URI_LENGTH+1];
+  char *segment, *next;
+
   assert(handler->site && handler->site[0] == '/');
 
   handler->directory = handler->site[strlen(handler->site)-1] == '/';
   handler->node.key = handler->site;
-  avl_insert(&_http_site_tree, &handler->node);
+  if (avl_insert(&oonf_http_site_tree, &handler->node)) {
+    OONF_WARN(LOG_HTTP, "HTTP site '%s' is already registered", handler->site);
+    return;
+  }
+
+  /* create all path segments of the site */
+  strscpy(path, handler->site, sizeof(path));
+
+  node = &_http_path_root;
+  for (segment = path; segment != NULL; segment = next) {
+    next = strchr(segment, '/');
+    if (next) {
+      *next++ = 0;
+    }
+
+    if (*segment) {
+      child = _add_path_node(node, segment);
+      if (child == NULL) {
+        break;
+      }
+      node = child;
+    }
+  }
+
+  if (segment != NULL
+      || (handler->directory && node->directory != NULL)
+      || (!handler->directory && node->site != NULL)) {
+    OONF_WARN(LOG_HTTP, "Cannot add HTTP site '%s' to routing trie", handler->site);
+
+    /* remove the nodes that have been created for this site */
+    _remove_path_node(node);
+    avl_remove(&oonf_http_site_tree, &handler->node);
+    return;
+  }
+
+  if (handler->directory) {
+    node->directory = handler;
+  }
+  else {
+    node->site = handler;
+  }
 }
 
 /**
@@ -182,7 +314,91 @@ oonf_http_add(struct oonf_http_handler *handler) {
  */
 void
 oonf_http_remove(struct oonf_http_handler *handler) {
-  avl_remove(&_http_site_tree, &handler->node);
+  struct _http_path_node *node;
+
+  if (!avl_is_node_added(&handler->node)) {
+    return;
+  }
+
+  node = _find_path_node(handler->site);
+  if (node) {
+    if (node->directory == handler) {
+      node->directory = NULL;
+    }
+    if (node->site == handler) {
+      node->site = NULL;
+    }
+    _remove_path_node(node);
+  }
+  avl_remove(&oonf_http_site_tree, &handler->node);
+}
+
+/**
+ * Lookup the http site handler for an URI with a single walk
+ * through the routing trie. A site matches before a directory
+ * with the same path, a directory matches all URIs below it.
+ * Fixed path segments have priority over path parameters.
+ * @param uri pointer to URI, will be modified by this function
+ * @param header pointer to http session to store path parameters
+ * @return http site handler or NULL if none available
+ */
+struct oonf_http_handler *
+oonf_http_get_site_handler(char *uri, struct oonf_http_session *header) {
+  struct _http_path_node *node, *child;
+  struct oonf_http_handler *handler;
+  size_t param_count;
+  char *segment, *next;
+
+  node = &_http_path_root;
+  handler = node->directory;
+  param_count = header->param_count;
+
+  for (segment = uri; segment != NULL; segment = next) {
+    while (*segment == '/') {
+      segment++;
+    }
+
+    if (*segment == 0) {
+      /* URI ends with '/', only directories match */
+      header->param_count = param_count;
+      return handler;
+    }
+
+    next = strchr(segment, '/');
+    if (next) {
+      *next++ = 0;
+    }
+
+    child = avl_find_element(&node->children, segment, child, _node);
+    if (child == NULL && node->param_child != NULL) {
+      child = node->param_child;
+
+      /* remember value of path parameter */
+      if (header->param_count < OONF_HTTP_MAX_PARAMS) {
+        header->param_name[header->param_count] = &child->segment[1];
+        header->param_value[header->param_count] = segment;
+        header->param_count++;
+      }
+    }
+
+    if (child == NULL) {
+      /* longest directory prefix */
+      header->param_count = param_count;
+      return handler;
+    }
+
+    node = child;
+    if (node->directory) {
+      handler = node->directory;
+      param_count = header->param_count;
+    }
+  }
+
+  if (node->site) {
+    return node->site;
+  }
+  header->param_count = param_count;
+  return handler;
 }
 
 /**
@@ -234,6 +450,20 @@ apply_config_failed:
   netaddr_acl_remove(&config.acl);
 }
 
+/**
+ * Cleanup of http session
+ * @param session pointer to tcp session
+ */
+static void
+_cb_cleanup(struct oonf_stream_session *session) {
+  struct _http_connection *connection;
+
+  connection = (struct _http_connection *)session;
+  if (connection->streaming) {
+    _stop_http_stream(connection);
+  }
+}
+
 /**
  * Callback for incoming http data
  * @param session pointer to tcp session
@@ -241,6 +471,7 @@ apply_config_failed:
  */
 static enum oonf_stream_session_state
 _cb_receive_data(struct oonf_stream_session *session) {
+  struct _http_connection *connection;
   struct oonf_http_session header;
   struct oonf_http_handler *handler;
   char uri[OONF_HTTP_MAX_URI_LENGTH+1];
@@ -248,6 +479,13 @@ _cb_receive_data(struct oonf_stream_session *session) {
   char *ptr;
   size_t len;
 
+  connection = (struct _http_connection *)session;
+  if (connection->streaming) {
+    /* request has already been answered, ignore further input */
+    abuf_clear(&session->in);
+    return STREAM_SESSION_ACTIVE;
+  }
+
   /* search for end of http header */
   if ((first_header = strstr(abuf_getptr(&session->in), "\r\n\r\n"))) {
     first_header += 4;
@@ -265,6 +503,7 @@ _cb_receive_data(struct oonf_stream_session *session) {
     _create_http_error(session, HTTP_400_BAD_REQ);
     return STREAM_SESSION_SEND_AND_QUIT;
   }
+  header.remote = &session->remote_address;
 
   if (strcmp(header.http_version, HTTP_VERSION_1_0) != 0
       && strcmp(header.http_version, HTTP_VERSION_1_1) != 0) {
@@ -329,19 +568,23 @@ _cb_receive_data(struct oonf_stream_session *session) {
     return STREAM_SESSION_SEND_AND_QUIT;
   }
 
-  handler = _get_site_handler(uri);
+  handler = oonf_http_get_site_handler(uri, &header);
   if (handler == NULL) {
-    OONF_DEBUG(LOG_HTTP, "No HTTP handler for site: %s", uri);
+    OONF_DEBUG(LOG_HTTP, "No HTTP handler for site: %s", header.request_uri);
     _create_http_error(session, HTTP_404_NOT_FOUND);
     return STREAM_SESSION_SEND_AND_QUIT;
   }
 
+  handler->request_count++;
+
   if (handler->content) {
     abuf_memcpy(&session->out, handler->content, handler->content_size);
     _create_http_header(session, HTTP_200_OK, NULL);
   }
   else {
     enum oonf_http_result result;
+    uint64_t start, end;
+
     /* check acl */
     if (!netaddr_acl_check_accept(&handler->acl, &session->remote_address)) {
       _create_http_error(session, HTTP_403_FORBIDDEN);
@@ -357,7 +600,15 @@ _cb_receive_data(struct oonf_stream_session *session) {
     }
 
     len = abuf_getlen(&session->out);
+    os_clock_gettime64_usec(&start);
     result = handler->content_handler(&session->out, &header);
+    os_clock_gettime64_usec(&end);
+
+    handler->request_time_total += end - start;
+    if (end - start > handler->request_time_max) {
+      handler->request_time_max = end - start;
+    }
+
     if (abuf_has_failed(&session->out)) {
       abuf_setlen(&session->out, len);
       result = HTTP_500_INTERNAL_SERVER_ERROR;
@@ -365,8 +616,15 @@ _cb_receive_data(struct oonf_stream_session *session) {
 
     if (result != HTTP_200_OK) {
       /* create error message */
+      if (header.stop_handler) {
+        header.stop_handler(&header);
+      }
       _create_http_error(session, result);
     }
+    else if (header.stream_handler) {
+      /* content will be generated block by block */
+      return _start_http_stream(connection, &header);
+    }
     else {
       _create_http_header(session, HTTP_200_OK, header.content_type);
     }
@@ -374,6 +632,41 @@ _cb_receive_data(struct oonf_stream_session *session) {
   return STREAM_SESSION_SEND_AND_QUIT;
 }
 
+/**
+ * Callback to generate the next block of a streaming http answer
+ * @param session pointer to tcp session
+ * @return state of tcp session
+ */
+static enum oonf_stream_session_state
+_cb_buffer_underrun(struct oonf_stream_session *session) {
+  struct _http_connection *connection;
+  bool more_data;
+
+  connection = (struct _http_connection *)session;
+  if (!connection->streaming) {
+    return session->state;
+  }
+
+  more_data = connection->http.stream_handler(&session->out, &connection->http);
+  if (abuf_has_failed(&session->out)) {
+    /* header has already been sent, so just close the session */
+    OONF_WARN(LOG_HTTP, "Out of memory while generating http stream");
+    _stop_http_stream(connection);
+    return STREAM_SESSION_CLEANUP;
+  }
+
+  _create_http_chunk(connection);
+  if (more_data) {
+    return STREAM_SESSION_ACTIVE;
+  }
+
+  if (connection->chunked) {
+    abuf_puts(&session->out, HTTP_LAST_CHUNK);
+  }
+  _stop_http_stream(connection);
+  return STREAM_SESSION_SEND_AND_QUIT;
+}
+
 /**
  * Check if an incoming session is authorized to view a http site.
  * @param handler pointer to site handler
@@ -431,43 +724,188 @@ _create_http_error(struct oonf_stream_session *session,
 }
 
 /**
- * Lookup the http site handler for an URI
- * @param uri pointer to URI
- * @return http site handler or NULL if none available
+ * Get the child of a routing trie node for a path segment,
+ * the child will be created if it does not exist.
+ * @param parent pointer to parent node
+ * @param segment name of path segment
+ * @return pointer to child node, NULL if an error happened
  */
-static struct oonf_http_handler *
-_get_site_handler(const char *uri) {
-  struct oonf_http_handler *handler;
-  size_t len;
+static struct _http_path_node *
+_add_path_node(struct _http_path_node *parent, const char *segment) {
+  struct _http_path_node *node;
+
+  if (segment[0] == ':') {
+    node = parent->param_child;
+    if (node != NULL && strcasecmp(node->segment, segment) != 0) {
+      OONF_WARN(LOG_HTTP, "HTTP path parameter '%s' conflicts with '%s'",
+          segment, node->segment);
+      return NULL;
+    }
+  }
+  else {
+    node = avl_find_element(&parent->children, segment, node, _node);
+  }
 
-  /* look for exact match */
-  handler = avl_find_element(&_http_site_tree, uri, handler, node);
-  if (handler) {
-    return handler;
+  if (node) {
+    return node;
   }
 
-  /* look for directory handler with shorter URL */
-  handler = avl_find_le_element(&_http_site_tree, uri, handler, node);
-  if (handler && handler->directory) {
-    len = strlen(handler->site);
+  node = oonf_class_malloc(&_http_path_memcookie);
+  if (node == NULL) {
+    return NULL;
+  }
 
-    /* check if complete handler path (ending with /) matchs uri */
-    if (strncasecmp(handler->site, uri, len) == 0) {
-      return handler;
+  node->segment = strdup(segment);
+  if (node->segment == NULL) {
+    oonf_class_free(&_http_path_memcookie, node);
+    return NULL;
+  }
+
+  node->parent = parent;
+  avl_init(&node->children, avl_comp_strcasecmp, false);
+
+  if (segment[0] == ':') {
+    parent->param_child = node;
+  }
+  else {
+    node->_node.key = node->segment;
+    avl_insert(&parent->children, &node->_node);
+  }
+  return node;
+}
+
+/**
+ * Lookup the routing trie node that represents a site
+ * @param site path of site
+ * @return pointer to trie node, NULL if not found
+ */
+static struct _http_path_node *
+_find_path_node(const char *site) {
+  struct _http_path_node *node;
+  char path[OONF_HTTP_MAX_URI_LENGTH+1];
+  char *segment, *next;
+
+  strscpy(path, site, sizeof(path));
+
+  node = &_http_path_root;
+  for (segment = path; node != NULL && segment != NULL; segment = next) {
+    next = strchr(segment, '/');
+    if (next) {
+      *next++ = 0;
+    }
+
+    if (*segment == ':') {
+      node = node->param_child;
+    }
+    else if (*segment) {
+      node = avl_find_element(&node->children, segment, node, _node);
     }
   }
+  return node;
+}
 
-  /* user might have skipped trailing / for directory */
-  handler = avl_find_ge_element(&_http_site_tree, uri, handler, node);
-  if (handler) {
-    len = strlen(uri);
+/**
+ * Remove a routing trie node and its parents if they are
+ * not used anymore.
+ * @param node pointer to trie node
+ */
+static void
+_remove_path_node(struct _http_path_node *node) {
+  struct _http_path_node *parent;
 
-    if (strncasecmp(handler->site, uri, len) == 0
-        && handler->site[len] == '/' && handler->site[len+1] == 0) {
-      return handler;
+  while (node != &_http_path_root
+      && node->site == NULL && node->directory == NULL
+      && node->param_child == NULL && avl_is_empty(&node->children)) {
+    parent = node->parent;
+
+    if (parent->param_child == node) {
+      parent->param_child = NULL;
+    }
+    else {
+      avl_remove(&parent->children, &node->_node);
     }
+
+    free(node->segment);
+    oonf_class_free(&_http_path_memcookie, node);
+
+    node = parent;
   }
-  return NULL;
+}
+
+/**
+ * Switch a http session into streaming mode. The output of the
+ * content handler becomes the first block of the answer.
+ * @param connection pointer to http connection
+ * @param header pointer to parsed http session
+ * @return state of tcp session
+ */
+static enum oonf_stream_session_state
+_start_http_stream(struct _http_connection *connection,
+    struct oonf_http_session *header) {
+  /* only keep the parts of the session that stay valid */
+  memset(&connection->http, 0, sizeof(connection->http));
+  connection->http.remote = header->remote;
+  connection->http.content_type = header->content_type;
+  connection->http.stream_handler = header->stream_handler;
+  connection->http.stop_handler = header->stop_handler;
+  memcpy(connection->http.stream_data, header->stream_data,
+      sizeof(connection->http.stream_data));
+
+  /* HTTP/1.0 clients get an unframed stream ending with the connection */
+  connection->chunked = strcmp(header->http_version, HTTP_VERSION_1_1) == 0;
+  connection->streaming = true;
+
+  OONF_DEBUG(LOG_HTTP, "Start %s http stream",
+      connection->chunked ? "chunked" : "unframed");
+
+  _create_http_chunk(connection);
+  _create_http_header(&connection->session, HTTP_200_OK, header->content_type);
+
+  /* request is answered, the input buffer is not necessary anymore */
+  abuf_clear(&connection->session.in);
+  return STREAM_SESSION_ACTIVE;
+}
+
+/**
+ * End the streaming mode of a http session
+ * @param connection pointer to http connection
+ */
+static void
+_stop_http_stream(struct _http_connection *connection) {
+  void (*stop_handler)(struct oonf_http_session *);
+
+  connection->streaming = false;
+
+  if (connection->http.stop_handler) {
+    /* make sure stop_handler is not set anymore when it is called */
+    stop_handler = connection->http.stop_handler;
+    connection->http.stop_handler = NULL;
+
+    stop_handler(&connection->http);
+  }
+}
+
+/**
+ * Add chunked transfer encoding framing around the content
+ * of the output buffer.
+ * @param connection pointer to http connection
+ */
+static void
+_create_http_chunk(struct _http_connection *connection) {
+  struct autobuf *out;
+  char chunk_header[20];
+  int len;
+
+  out = &connection->session.out;
+  if (!connection->chunked || abuf_getlen(out) == 0) {
+    /* a chunk with length zero would end the stream */
+    return;
+  }
+
+  len = snprintf(chunk_header, sizeof(chunk_header),
+      "%"PRINTF_SIZE_T_HEX_SPECIFIER"\r\n", abuf_getlen(out));
+  abuf_memcpy_prepend(out, chunk_header, len);
+  abuf_puts(out, "\r\n");
 }
 
 /**
@@ -511,12 +949,16 @@ _get_headertype_string(enum oonf_http_result type) {
 static void
 _create_http_header(struct oonf_stream_session *session,
     enum oonf_http_result code, const char *content_type) {
+  struct _http_connection *connection;
   struct autobuf buf;
   struct timeval currtime;
 
+  connection = (struct _http_connection *)session;
   abuf_init(&buf);
 
-  abuf_appendf(&buf, "%s %d %s\r\n", HTTP_VERSION_1_0, code, _get_headertype_string(code));
+  abuf_appendf(&buf, "%s %d %s\r\n",
+      connection->chunked ? HTTP_VERSION_1_1 : HTTP_VERSION_1_0,
+      code, _get_headertype_string(code));
 
   /* Date */
   os_core_gettimeofday(&currtime);
@@ -536,7 +978,11 @@ _create_http_header(struct oonf_stream_session *session,
   abuf_appendf(&buf, "Content-type: %s\r\n", content_type);
 
   /* Content length */
-  if (abuf_getlen(&session->out) > 0) {
+  if (connection->chunked) {
+    abuf_puts(&buf, "Transfer-Encoding: chunked\r\n");
+  }
+  else if (!connection->streaming && abuf_getlen(&session->out) > 0) {
+    /* unframed streams end when the connection is closed */
     abuf_appendf(&buf, "Content-length: %zu\r\n", abuf_getlen(&session->out));
   }
 
@@ -80,19 +80,42 @@ struct oonf_http_session {
   char *header_value[OONF_HTTP_MAX_HEADERS];
   size_t header_count;
 
-  /* parameter of the URI for GET/POST */
+  /* parameter of the URI for GET/POST and path parameters of the site */
   char *param_name[OONF_HTTP_MAX_PARAMS];
   char *param_value[OONF_HTTP_MAX_PARAMS];
   size_t param_count;
 
   /* content type for answer, NULL means plain/html */
   const char *content_type;
+
+  /*
+   * callback for streaming answers, might be set by the content
+   * handler to generate the answer block by block. It will be called
+   * each time the last block has been sent. It must add data to the
+   * buffer and return true as long as there is more data to come.
+   * Header, parameter and URI pointers are not valid anymore when
+   * this callback is called.
+   */
+  bool (*stream_handler)(struct autobuf *out, struct oonf_http_session *);
+
+  /*
+   * callback to cleanup the data of a streaming answer,
+   * called when the stream has ended or the session was closed.
+   */
+  void (*stop_handler)(struct oonf_http_session *);
+
+  /* custom data for streaming answers */
+  void *stream_data[4];
 };
 
 struct oonf_http_handler {
   struct avl_node node;
 
-  /* path of filename of content */
+  /*
+   * path of filename of content, a path segment starting with ':'
+   * (e.g. "/neighbor/:address") matches every value, which is added
+   * to the request parameters with the segment name (without ':').
+   */
   const char *site;
 
   /* set by oonf_http_add to true if site is a directory */
@@ -108,9 +131,20 @@ struct oonf_http_handler {
   const char *content;
   size_t content_size;
 
-  /* callback for custom generated content (called if content==NULL) */
+  /*
+   * callback for custom generated content (called if content==NULL),
+   * might set the stream_handler of the session to send a large
+   * answer block by block
+   */
   enum oonf_http_result (*content_handler)(
       struct autobuf *out, struct oonf_http_session *);
+
+  /* number of requests for this site */
+  uint64_t request_count;
+
+  /* total and maximum runtime of content_handler in microseconds */
+  uint64_t request_time_total;
+  uint64_t request_time_max;
 };
 
 #define LOG_HTTP oonf_http_subsystem.logging
@@ -119,8 +153,12 @@ EXPORT extern struct oonf_subsystem oonf_http_subsystem;
 EXPORT extern const char *HTTP_CONTENTTYPE_HTML;
 EXPORT extern const char *HTTP_CONTENTTYPE_TEXT;
 
+EXPORT extern struct avl_tree oonf_http_site_tree;
+
 EXPORT void oonf_http_add(struct oonf_http_handler *);
 EXPORT void oonf_http_remove(struct oonf_http_handler *);
+EXPORT struct oonf_http_handler *oonf_http_get_site_handler(
+    char *uri, struct oonf_http_session *session);
 
 EXPORT const char *oonf_http_lookup_value(char **keys, char **values,
     size_t count, const char *key);
@@ -256,6 +256,8 @@ _interface_add(const char *name, bool mesh) {
 
     /* initialize data of interface */
     os_net_update_interface(&interf->data, name);
+
+    oonf_class_event(&_if_class, interf, OONF_OBJECT_ADDED);
   }
 
   /* update reference counters */
@@ -302,6 +304,8 @@ _interface_remove(struct oonf_interface *interf, bool mesh) {
     return;
   }
 
+  oonf_class_event(&_if_class, interf, OONF_OBJECT_REMOVED);
+
   if (interf->data.addresses) {
     free(interf->data.addresses);
   }
@@ -47,14 +47,59 @@
 #include "core/oonf_subsystem.h"
 #include "subsystems/oonf_class.h"
 #include "subsystems/oonf_layer2.h"
+#include "subsystems/oonf_timer.h"
+
+/* originator of layer-2 data and the objects it contributed values to */
+struct _l2origin {
+  /* originator number */
+  uint32_t origin;
+
+  /* lists of _l2origin_ref objects pointing to networks/neighbors */
+  struct list_entity nets;
+  struct list_entity neighbors;
+
+  /* node of originator tree */
+  struct avl_node _node;
+};
+
+/* link between an originator and a layer-2 network or neighbor */
+struct _l2origin_ref {
+  /* originator of data values */
+  struct _l2origin *l2origin;
+
+  /* layer-2 network or neighbor */
+  void *object;
+
+  /* node for the list of the originator */
+  struct list_entity _origin_node;
+
+  /* node for the list of the layer-2 object */
+  struct list_entity _object_node;
+};
 
 /* prototypes */
 static int _init(void);
 static void _cleanup(void);
 
 static bool _commit(struct oonf_layer2_net *l2net, bool commit_change);
+static void _net_changed(struct oonf_layer2_net *l2net);
+static void _neigh_changed(struct oonf_layer2_neigh *l2neigh);
+static void _net_fire_change(struct oonf_layer2_net *l2net);
+static void _neigh_fire_change(struct oonf_layer2_neigh *l2neigh);
+static uint32_t _get_changes(struct oonf_layer2_data *data,
+    struct oonf_layer2_data *last, size_t count);
+static void _cb_transaction_end(void *);
 static void _net_remove(struct oonf_layer2_net *l2net);
 static void _neigh_remove(struct oonf_layer2_neigh *l2neigh);
+static void _update_origins(struct list_entity *refs, void *object,
+    bool neighbor, struct oonf_layer2_data *data, size_t count,
+    struct oonf_layer2_data *defaults, size_t def_count);
+static bool _has_origin(struct oonf_layer2_data *data, size_t count,
+    uint32_t origin);
+static void _add_origins(struct list_entity *refs, void *object,
+    bool neighbor, struct oonf_layer2_data *data, size_t count);
+static struct _l2origin *_get_origin(uint32_t origin);
+static void _free_origin_ref(struct _l2origin_ref *ref);
 
 /* subsystem definition */
 struct oonf_subsystem oonf_layer2_subsystem = {
@@ -91,10 +136,40 @@ static struct oonf_class _l2neighbor_class = {
   .size = sizeof(struct oonf_layer2_neigh),
 };
 
+/* infrastructure for tracking the objects of each originator */
+static struct oonf_class _l2origin_class = {
+  .name = "layer2 origin",
+  .size = sizeof(struct _l2origin),
+};
+static struct oonf_class _l2origin_ref_class = {
+  .name = "layer2 origin reference",
+  .size = sizeof(struct _l2origin_ref),
+};
+
 struct avl_tree oonf_layer2_net_tree;
 
 static uint32_t _next_origin = 0;
 
+/* tree of originators that contributed data values */
+static struct avl_tree _origin_tree;
+
+/* objects with change events waiting for the end of the transaction */
+static struct list_entity _pending_nets;
+static struct list_entity _pending_neighbors;
+
+/* true while changes are collected */
+static bool _transaction_active = false;
+
+/* timer to end the transaction with the next scheduler iteration */
+static struct oonf_timer_info _transaction_timer_info = {
+  .name = "layer2 transaction",
+  .callback = _cb_transaction_end,
+};
+
+static struct oonf_timer_entry _transaction_timer = {
+  .info = &_transaction_timer_info,
+};
+
 /**
  * Subsystem constructor
  * @return always returns 0
@@ -103,8 +178,14 @@ static int
 _init(void) {
   oonf_class_add(&_l2network_class);
   oonf_class_add(&_l2neighbor_class);
+  oonf_class_add(&_l2origin_class);
+  oonf_class_add(&_l2origin_ref_class);
+  oonf_timer_add(&_transaction_timer_info);
 
   avl_init(&oonf_layer2_net_tree, avl_comp_netaddr, false);
+  avl_init(&_origin_tree, avl_comp_uint32, false);
+  list_init_head(&_pending_nets);
+  list_init_head(&_pending_neighbors);
   return 0;
 }
 
@@ -114,11 +195,23 @@ _init(void) {
 static void
 _cleanup(void) {
   struct oonf_layer2_net *l2net, *l2n_it;
+  struct _l2origin *l2origin, *l2o_it;
+
+  oonf_timer_stop(&_transaction_timer);
+  _transaction_active = false;
 
   avl_for_each_element_safe(&oonf_layer2_net_tree, l2net, _node, l2n_it) {
     _net_remove(l2net);
   }
 
+  avl_for_each_element_safe(&_origin_tree, l2origin, _node, l2o_it) {
+    avl_remove(&_origin_tree, &l2origin->_node);
+    oonf_class_free(&_l2origin_class, l2origin);
+  }
+
+  oonf_timer_remove(&_transaction_timer_info);
+  oonf_class_remove(&_l2origin_ref_class);
+  oonf_class_remove(&_l2origin_class);
   oonf_class_remove(&_l2neighbor_class);
   oonf_class_remove(&_l2network_class);
 }
@@ -134,16 +227,62 @@ oonf_layer2_register_origin(void) {
 }
 
 /**
- * Removes all layer2 data associated with this data originator
+ * Removes all layer2 data associated with this data originator.
+ * Only the networks and neighbors the originator contributed
+ * values to are touched.
  * @param origin originator number
  */
 void
 oonf_layer2_cleanup_origin(uint32_t origin) {
-  struct oonf_layer2_net *l2net, *l2net_it;
+  struct _l2origin *l2origin;
+  struct _l2origin_ref *ref, *ref_it;
+  struct oonf_layer2_net *l2net;
+  struct oonf_layer2_neigh *l2neigh;
+  int i;
+
+  l2origin = avl_find_uint32_element(&_origin_tree, &origin, l2origin, _node);
+  if (l2origin == NULL) {
+    return;
+  }
+
+  /* the commits below remove the references of the cleaned objects */
+  list_for_each_element_safe(&l2origin->neighbors, ref, _origin_node, ref_it) {
+    l2neigh = ref->object;
+    l2net = l2neigh->network;
+
+    oonf_layer2_neigh_remove(l2neigh, origin);
+    if (l2net->neighbors.count == 0) {
+      /* remove the network if it is empty now */
+      _commit(l2net, false);
+    }
+  }
+
+  list_for_each_element_safe(&l2origin->nets, ref, _origin_node, ref_it) {
+    l2net = ref->object;
 
-  avl_for_each_element_safe(&oonf_layer2_net_tree, l2net, _node, l2net_it) {
-    oonf_layer2_net_remove(l2net, origin);
+    for (i=0; i<OONF_LAYER2_NET_COUNT; i++) {
+      if (l2net->data[i]._origin == origin) {
+        oonf_layer2_reset_value(&l2net->data[i]);
+      }
+    }
+    for (i=0; i<OONF_LAYER2_NEIGH_COUNT; i++) {
+      if (l2net->neighdata[i]._origin == origin) {
+        oonf_layer2_reset_value(&l2net->neighdata[i]);
+      }
+    }
+    _commit(l2net, false);
+  }
+
+  /* values not reset by a commit */
+  list_for_each_element_safe(&l2origin->nets, ref, _origin_node, ref_it) {
+    _free_origin_ref(ref);
   }
+  list_for_each_element_safe(&l2origin->neighbors, ref, _origin_node, ref_it) {
+    _free_origin_ref(ref);
+  }
+
+  avl_remove(&_origin_tree, &l2origin->_node);
+  oonf_class_free(&_l2origin_class, l2origin);
 }
 
 /**
@@ -171,6 +310,7 @@ oonf_layer2_net_add(struct netaddr *network) {
 
   avl_init(&l2net->neighbors, avl_comp_netaddr, false);
   avl_init(&l2net->_ip_defaults, avl_comp_netaddr, false);
+  list_init_head(&l2net->_origins);
 
   oonf_class_event(&_l2network_class, l2net, OONF_OBJECT_ADDED);
 
@@ -197,6 +337,11 @@ oonf_layer2_net_remove(struct oonf_layer2_net *l2net, uint32_t origin) {
       oonf_layer2_reset_value(&l2net->data[i]);
     }
   }
+  for (i=0; i<OONF_LAYER2_NEIGH_COUNT; i++) {
+    if (l2net->neighdata[i]._origin == origin) {
+      oonf_layer2_reset_value(&l2net->neighdata[i]);
+    }
+  }
   _commit(l2net, false);
 }
 
@@ -242,6 +387,7 @@ oonf_layer2_neigh_add(struct oonf_layer2_net *l2net,
   l2neigh->network = l2net;
 
   avl_insert(&l2net->neighbors, &l2neigh->_node);
+  list_init_head(&l2neigh->_origins);
 
   if (netaddr_get_address_family(neigh) == AF_MAC48
       || netaddr_get_address_family(neigh) == AF_EUI64) {
@@ -282,9 +428,9 @@ bool
 oonf_layer2_neigh_commit(struct oonf_layer2_neigh *l2neigh) {
   size_t i;
 
-  for (i=0; i<OONF_LAYER2_NET_COUNT; i++) {
+  for (i=0; i<OONF_LAYER2_NEIGH_COUNT; i++) {
     if (oonf_layer2_has_value(&l2neigh->data[i])) {
-      oonf_class_event(&_l2neighbor_class, l2neigh, OONF_OBJECT_CHANGED);
+      _neigh_changed(l2neigh);
       return false;
     }
   }
@@ -293,6 +439,52 @@ oonf_layer2_neigh_commit(struct oonf_layer2_neigh *l2neigh) {
   return true;
 }
 
+/**
+ * Start collecting layer2 changes. Until the end of the current
+ * scheduler iteration all commits of an object will be coalesced
+ * into a single change event with the combined change bitmasks.
+ * Added and removed objects are still reported directly.
+ */
+void
+oonf_layer2_transaction_begin(void) {
+  if (_transaction_active) {
+    return;
+  }
+
+  _transaction_active = true;
+
+  /* timers fire at the begin of the next scheduler iteration */
+  oonf_timer_set(&_transaction_timer, 1);
+}
+
+/**
+ * Deliver all change events collected by the running transaction
+ * and end it.
+ */
+void
+oonf_layer2_transaction_flush(void) {
+  struct oonf_layer2_net *l2net;
+  struct oonf_layer2_neigh *l2neigh;
+
+  oonf_timer_stop(&_transaction_timer);
+  _transaction_active = false;
+
+  /* callbacks might commit or remove other objects */
+  while (!list_is_empty(&_pending_nets)) {
+    l2net = list_first_element(&_pending_nets, l2net, _pending_node);
+    list_remove(&l2net->_pending_node);
+
+    _net_fire_change(l2net);
+  }
+
+  while (!list_is_empty(&_pending_neighbors)) {
+    l2neigh = list_first_element(&_pending_neighbors, l2neigh, _pending_node);
+    list_remove(&l2neigh->_pending_node);
+
+    _neigh_fire_change(l2neigh);
+  }
+}
+
 /**
  * Get neighbor specific data, either from neighbor or from the networks default
  * @param l2net_addr network mac address
@@ -342,14 +534,14 @@ _commit(struct oonf_layer2_net *l2net, bool commit_change) {
   size_t i;
 
   if (l2net->neighbors.count > 0) {
-    oonf_class_event(&_l2network_class, l2net, OONF_OBJECT_CHANGED);
+    _net_changed(l2net);
     return false;
   }
 
   for (i=0; i<OONF_LAYER2_NET_COUNT; i++) {
     if (oonf_layer2_has_value(&l2net->data[i])) {
       if (commit_change) {
-        oonf_class_event(&_l2network_class, l2net, OONF_OBJECT_CHANGED);
+        _net_changed(l2net);
       }
       return false;
     }
@@ -359,6 +551,124 @@ _commit(struct oonf_layer2_net *l2net, bool commit_change) {
   return true;
 }
 
+/**
+ * Update the change bitmasks of a layer-2 network and trigger
+ * its change event, either directly or at the end of the transaction
+ * @param l2net layer-2 network object
+ */
+static void
+_net_changed(struct oonf_layer2_net *l2net) {
+  uint32_t changes, neighdata_changes;
+
+  changes = _get_changes(l2net->data, l2net->_last_data, OONF_LAYER2_NET_COUNT);
+  neighdata_changes = _get_changes(
+      l2net->neighdata, l2net->_last_neighdata, OONF_LAYER2_NEIGH_COUNT);
+  if (changes || neighdata_changes) {
+    _update_origins(&l2net->_origins, l2net, false,
+        l2net->data, OONF_LAYER2_NET_COUNT,
+        l2net->neighdata, OONF_LAYER2_NEIGH_COUNT);
+  }
+
+  l2net->changed |= changes;
+  l2net->neighdata_changed |= neighdata_changes;
+
+  if (_transaction_active) {
+    if (!list_is_node_added(&l2net->_pending_node)) {
+      list_add_tail(&_pending_nets, &l2net->_pending_node);
+    }
+    return;
+  }
+
+  _net_fire_change(l2net);
+}
+
+/**
+ * Fire the change event of a layer-2 network with its change bitmasks
+ * @param l2net layer-2 network object
+ */
+static void
+_net_fire_change(struct oonf_layer2_net *l2net) {
+  oonf_class_event_ext(&_l2network_class, l2net, OONF_OBJECT_CHANGED,
+      l2net->changed | (l2net->neighdata_changed << OONF_LAYER2_NET_NEIGHDATA_SHIFT));
+  l2net->changed = 0;
+  l2net->neighdata_changed = 0;
+}
+
+/**
+ * Update the change bitmask of a layer-2 neighbor and trigger
+ * its change event, either directly or at the end of the transaction
+ * @param l2neigh layer-2 neighbor object
+ */
+static void
+_neigh_changed(struct oonf_layer2_neigh *l2neigh) {
+  uint32_t changes;
+
+  changes = _get_changes(l2neigh->data, l2neigh->_last_data, OONF_LAYER2_NEIGH_COUNT);
+  if (changes) {
+    _update_origins(&l2neigh->_origins, l2neigh, true,
+        l2neigh->data, OONF_LAYER2_NEIGH_COUNT, NULL, 0);
+  }
+
+  l2neigh->changed |= changes;
+
+  if (_transaction_active) {
+    if (!list_is_node_added(&l2neigh->_pending_node)) {
+      list_add_tail(&_pending_neighbors, &l2neigh->_pending_node);
+    }
+    return;
+  }
+
+  _neigh_fire_change(l2neigh);
+}
+
+/**
+ * Fire the change event of a layer-2 neighbor with its change bitmask
+ * @param l2neigh layer-2 neighbor object
+ */
+static void
+_neigh_fire_change(struct oonf_layer2_neigh *l2neigh) {
+  oonf_class_event_ext(&_l2neighbor_class, l2neigh, OONF_OBJECT_CHANGED,
+      l2neigh->changed);
+  l2neigh->changed = 0;
+}
+
+/**
+ * Compare layer-2 data with the values of the last commit
+ * and remember the current values.
+ * @param data array of current layer-2 data
+ * @param last array of layer-2 data of the last commit
+ * @param count number of elements in both arrays
+ * @return bitmask of changed indices
+ */
+static uint32_t
+_get_changes(struct oonf_layer2_data *data,
+    struct oonf_layer2_data *last, size_t count) {
+  uint32_t changes;
+  size_t i;
+
+  changes = 0;
+  for (i=0; i<count; i++) {
+    if (data[i]._has_value != last[i]._has_value
+        || (data[i]._has_value
+            && (data[i]._value != last[i]._value || data[i]._origin != last[i]._origin))) {
+      changes |= (1u << i);
+    }
+  }
+
+  memcpy(last, data, sizeof(*data) * count);
+  return changes;
+}
+
+/**
+ * Callback to end the layer2 transaction with the next
+ * scheduler iteration
+ * @param ptr unused
+ */
+static void
+_cb_transaction_end(void *ptr __attribute__((unused))) {
+  oonf_layer2_transaction_flush();
+}
+
 /**
  * Removes a layer-2 addr object from the database.
  * @param l2net layer-2 addr object
@@ -366,6 +676,7 @@ _commit(struct oonf_layer2_net *l2net, bool commit_change) {
 static void
 _net_remove(struct oonf_layer2_net *l2net) {
   struct oonf_layer2_neigh *l2neigh, *l2n_it;
+  struct _l2origin_ref *ref, *ref_it;
 
   /* free all embedded neighbors */
   avl_for_each_element_safe(&l2net->neighbors, l2neigh, _node, l2n_it) {
@@ -374,6 +685,13 @@ _net_remove(struct oonf_layer2_net *l2net) {
 
   oonf_class_event(&_l2network_class, l2net, OONF_OBJECT_REMOVED);
 
+  if (list_is_node_added(&l2net->_pending_node)) {
+    list_remove(&l2net->_pending_node);
+  }
+  list_for_each_element_safe(&l2net->_origins, ref, _object_node, ref_it) {
+    _free_origin_ref(ref);
+  }
+
   /* free addr */
   avl_remove(&oonf_layer2_net_tree, &l2net->_node);
   oonf_class_free(&_l2network_class, l2net);
@@ -386,10 +704,18 @@ _net_remove(struct oonf_layer2_net *l2net) {
 static void
 _neigh_remove(struct oonf_layer2_neigh *l2neigh) {
   struct oonf_layer2_neigh *neigh, *n_it;
+  struct _l2origin_ref *ref, *ref_it;
 
   /* inform user that mac entry will be removed */
   oonf_class_event(&_l2neighbor_class, l2neigh, OONF_OBJECT_REMOVED);
 
+  if (list_is_node_added(&l2neigh->_pending_node)) {
+    list_remove(&l2neigh->_pending_node);
+  }
+  list_for_each_element_safe(&l2neigh->_origins, ref, _object_node, ref_it) {
+    _free_origin_ref(ref);
+  }
+
   /* remove all connected IP defaults */
   list_for_each_element_safe(&l2neigh->_neigh_ring, neigh, _neigh_ring, n_it) {
     list_remove(&neigh->_neigh_ring);
@@ -399,3 +725,144 @@ _neigh_remove(struct oonf_layer2_neigh *l2neigh) {
   avl_remove(&l2neigh->network->neighbors, &l2neigh->_node);
   oonf_class_free(&_l2neighbor_class, l2neigh);
 }
+
+/**
+ * Update the references between a layer-2 object and the
+ * originators of its data values
+ * @param refs list of originator references of the object
+ * @param object pointer to layer-2 network or neighbor
+ * @param neighbor true if object is a neighbor, false for a network
+ * @param data array of layer-2 data of the object
+ * @param count number of elements in the data array
+ * @param defaults array of neighbor defaults of a network, NULL for a neighbor
+ * @param def_count number of elements in the defaults array
+ */
+static void
+_update_origins(struct list_entity *refs, void *object,
+    bool neighbor, struct oonf_layer2_data *data, size_t count,
+    struct oonf_layer2_data *defaults, size_t def_count) {
+  struct _l2origin_ref *ref, *ref_it;
+  uint32_t origin;
+
+  /* remove originators that do not provide a value anymore */
+  list_for_each_element_safe(refs, ref, _object_node, ref_it) {
+    origin = ref->l2origin->origin;
+    if (!_has_origin(data, count, origin)
+        && !_has_origin(defaults, def_count, origin)) {
+      _free_origin_ref(ref);
+    }
+  }
+
+  /* add new originators */
+  _add_origins(refs, object, neighbor, data, count);
+  _add_origins(refs, object, neighbor, defaults, def_count);
+}
+
+/**
+ * Check if an originator provides a value in an array of layer-2 data
+ * @param data array of layer-2 data
+ * @param count number of elements in the data array
+ * @param origin originator number
+ * @return true if one of the values belongs to the originator
+ */
+static bool
+_has_origin(struct oonf_layer2_data *data, size_t count, uint32_t origin) {
+  size_t i;
+
+  for (i=0; i<count; i++) {
+    if (data[i]._has_value && data[i]._origin == origin) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Add references for all originators of an array of layer-2 data
+ * that are not yet linked to the object
+ * @param refs list of originator references of the object
+ * @param object pointer to layer-2 network or neighbor
+ * @param neighbor true if object is a neighbor, false for a network
+ * @param data array of layer-2 data
+ * @param count number of elements in the data array
+ */
+static void
+_add_origins(struct list_entity *refs, void *object,
+    bool neighbor, struct oonf_layer2_data *data, size_t count) {
+  struct _l2origin_ref *ref;
+  struct _l2origin *l2origin;
+  size_t i;
+  bool found;
+
+  for (i=0; i<count; i++) {
+    if (!data[i]._has_value) {
+      continue;
+    }
+
+    found = false;
+    list_for_each_element(refs, ref, _object_node) {
+      if (ref->l2origin->origin == data[i]._origin) {
+        found = true;
+        break;
+      }
+    }
+    if (found) {
+      continue;
+    }
+
+    l2origin = _get_origin(data[i]._origin);
+    if (l2origin == NULL) {
+      return;
+    }
+
+    ref = oonf_class_malloc(&_l2origin_ref_class);
+    if (ref == NULL) {
+      return;
+    }
+
+    ref->l2origin = l2origin;
+    ref->object = object;
+    list_add_tail(refs, &ref->_object_node);
+    list_add_tail(neighbor ? &l2origin->neighbors : &l2origin->nets,
+        &ref->_origin_node);
+  }
+}
+
+/**
+ * Get the tracking object of a data originator, create it if necessary
+ * @param origin originator number
+ * @return pointer to originator object, NULL if out of memory
+ */
+static struct _l2origin *
+_get_origin(uint32_t origin) {
+  struct _l2origin *l2origin;
+
+  l2origin = avl_find_uint32_element(&_origin_tree, &origin, l2origin, _node);
+  if (l2origin) {
+    return l2origin;
+  }
+
+  l2origin = oonf_class_malloc(&_l2origin_class);
+  if (l2origin == NULL) {
+    return NULL;
+  }
+
+  l2origin->origin = origin;
+  list_init_head(&l2origin->nets);
+  list_init_head(&l2origin->neighbors);
+
+  l2origin->_node.key = &l2origin->origin;
+  avl_insert(&_origin_tree, &l2origin->_node);
+  return l2origin;
+}
+
+/**
+ * Unlink and free an originator reference
+ * @param ref pointer to originator reference
+ */
+static void
+_free_origin_ref(struct _l2origin_ref *ref) {
+  list_remove(&ref->_origin_node);
+  list_remove(&ref->_object_node);
+  oonf_class_free(&_l2origin_ref_class, ref);
+}
@@ -44,12 +44,20 @@
 
 #include "common/avl.h"
 #include "common/common_types.h"
+#include "common/list.h"
 #include "core/oonf_subsystem.h"
 #include "subsystems/oonf_timer.h"
 
 #define LAYER2_CLASS_NEIGHBOR  "layer2_neighbor"
 #define LAYER2_CLASS_NETWORK   "layer2_network"
 
+/*
+ * change events of layer-2 networks report the changed data indices
+ * in the lower bits and the changed neighdata indices shifted by
+ * this offset
+ */
+#define OONF_LAYER2_NET_NEIGHDATA_SHIFT 16
+
 #define OONF_LAYER2_NET_MAX_BITRATE_KEY  "max_bitrate"
 #define OONF_LAYER2_NET_FREQUENCY_KEY    "frequency"
 
@@ -115,6 +123,24 @@ struct oonf_layer2_net {
 
   struct oonf_layer2_data data[OONF_LAYER2_NET_COUNT];
   struct oonf_layer2_data neighdata[OONF_LAYER2_NEIGH_COUNT];
+
+  /*
+   * bitmasks (1 << index) of the data and neighdata entries that
+   * changed since the last change event, valid during the
+   * OONF_OBJECT_CHANGED callbacks
+   */
+  uint32_t changed;
+  uint32_t neighdata_changed;
+
+  /* values of the last commit */
+  struct oonf_layer2_data _last_data[OONF_LAYER2_NET_COUNT];
+  struct oonf_layer2_data _last_neighdata[OONF_LAYER2_NEIGH_COUNT];
+
+  /* node for list of networks with a pending change event */
+  struct list_entity _pending_node;
+
+  /* list of originators that contributed to the data values */
+  struct list_entity _origins;
 };
 
 struct oonf_layer2_neigh {
@@ -128,6 +154,21 @@ struct oonf_layer2_neigh {
   uint64_t last_seen;
 
   struct oonf_layer2_data data[OONF_LAYER2_NEIGH_COUNT];
+
+  /*
+   * bitmask (1 << index) of the data entries that changed since the
+   * last change event, valid during the OONF_OBJECT_CHANGED callbacks
+   */
+  uint32_t changed;
+
+  /* values of the last commit */
+  struct oonf_layer2_data _last_data[OONF_LAYER2_NEIGH_COUNT];
+
+  /* node for list of neighbors with a pending change event */
+  struct list_entity _pending_node;
+
+  /* list of originators that contributed to the data values */
+  struct list_entity _origins;
 };
 
 struct oonf_layer2_metadata {
@@ -159,6 +200,9 @@ EXPORT void oonf_layer2_neigh_remove(
     struct oonf_layer2_neigh *l2neigh, uint32_t origin);
 EXPORT bool oonf_layer2_neigh_commit(struct oonf_layer2_neigh *l2neigh);
 
+EXPORT void oonf_layer2_transaction_begin(void);
+EXPORT void oonf_layer2_transaction_flush(void);
+
 EXPORT const struct oonf_layer2_data *oonf_layer2_neigh_query(
     const struct netaddr *l2net, const struct netaddr *l2neigh,
     enum oonf_layer2_neighbor_index idx);
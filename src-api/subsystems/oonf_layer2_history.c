@@ -0,0 +1,236 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2013, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+#include <string.h>
+
+#include "common/common_types.h"
+#include "common/avl.h"
+#include "core/oonf_logging.h"
+#include "subsystems/oonf_class.h"
+#include "subsystems/oonf_clock.h"
+#include "subsystems/oonf_layer2.h"
+#include "subsystems/oonf_layer2_history.h"
+
+/* prototypes */
+static void _reset_histories(void);
+static void _cb_neigh_changed(void *ptr);
+static void _update_min_max(struct oonf_layer2_history *history);
+
+/* extension of the layer-2 neighbors for the history rings */
+static struct oonf_class_extension _history_extension = {
+  .ext_name = "layer2 history",
+  .class_name = LAYER2_CLASS_NEIGHBOR,
+  .size = sizeof(struct oonf_layer2_history) * OONF_LAYER2_NEIGH_COUNT,
+  .cb_change = _cb_neigh_changed,
+};
+
+/* number of users of the layer-2 history */
+static int _history_users = 0;
+
+/**
+ * Request the history of the layer-2 neighbor values. Because it
+ * extends the neighbor objects, the history must be requested the
+ * first time before the first neighbor is created (normally during
+ * initialization).
+ * @return -1 if an error happened, 0 otherwise
+ */
+int
+oonf_layer2_history_add(void) {
+  if (!oonf_class_is_extension_registered(&_history_extension)) {
+    if (oonf_class_extension_add(&_history_extension)) {
+      OONF_WARN(LOG_LAYER2, "Cannot activate layer2 neighbor history");
+      return -1;
+    }
+  }
+  else if (_history_users == 0) {
+    /* history was inactive, drop the samples from before */
+    _reset_histories();
+  }
+  _history_users++;
+  return 0;
+}
+
+/**
+ * Release the history of the layer-2 neighbor values. The memory
+ * of the history stays part of the neighbor objects, so the history
+ * can be activated again while neighbors exist.
+ */
+void
+oonf_layer2_history_remove(void) {
+  if (_history_users > 0) {
+    _history_users--;
+  }
+}
+
+/**
+ * @param l2neigh pointer to layer-2 neighbor
+ * @param idx data index
+ * @return pointer to the history of the value, NULL if the
+ *   history is not active
+ */
+struct oonf_layer2_history *
+oonf_layer2_history_get(struct oonf_layer2_neigh *l2neigh,
+    enum oonf_layer2_neighbor_index idx) {
+  struct oonf_layer2_history *history;
+
+  if (_history_users == 0) {
+    return NULL;
+  }
+
+  history = oonf_class_get_extension(&_history_extension, l2neigh);
+  return &history[idx];
+}
+
+/**
+ * Add a sample to a history ring and update the statistics
+ * @param history pointer to layer-2 history
+ * @param timestamp time of the sample
+ * @param value value of the sample
+ */
+void
+oonf_layer2_history_append(struct oonf_layer2_history *history,
+    uint64_t timestamp, int64_t value) {
+  struct oonf_layer2_sample *sample;
+  int64_t overwritten;
+  bool full;
+
+  sample = &history->samples[history->_next];
+  full = history->count == OONF_LAYER2_HISTORY_SIZE;
+  overwritten = sample->value;
+
+  sample->timestamp = timestamp;
+  sample->value = value;
+  history->_next = (history->_next + 1) % OONF_LAYER2_HISTORY_SIZE;
+
+  if (history->count == 0) {
+    history->count = 1;
+    history->ewma = value;
+    history->_ewma_scaled = value * (1 << OONF_LAYER2_HISTORY_EWMA_SHIFT);
+    history->min = value;
+    history->max = value;
+    return;
+  }
+
+  if (!full) {
+    history->count++;
+  }
+
+  /* keep the fraction bits to prevent rounding errors from piling up */
+  history->_ewma_scaled += value - history->ewma;
+  history->ewma = history->_ewma_scaled / (1 << OONF_LAYER2_HISTORY_EWMA_SHIFT);
+
+  if (full && (overwritten == history->min || overwritten == history->max)) {
+    /* the old extreme value left the ring */
+    _update_min_max(history);
+  }
+  else if (value < history->min) {
+    history->min = value;
+  }
+  else if (value > history->max) {
+    history->max = value;
+  }
+}
+
+/**
+ * Clear the history of all existing layer-2 neighbors
+ */
+static void
+_reset_histories(void) {
+  struct oonf_layer2_net *l2net;
+  struct oonf_layer2_neigh *l2neigh;
+
+  avl_for_each_element(&oonf_layer2_net_tree, l2net, _node) {
+    avl_for_each_element(&l2net->neighbors, l2neigh, _node) {
+      memset(oonf_class_get_extension(&_history_extension, l2neigh), 0,
+          _history_extension.size);
+    }
+  }
+}
+
+/**
+ * Callback for committed layer-2 neighbors, adds all current values
+ * to their history
+ * @param ptr pointer to layer-2 neighbor
+ */
+static void
+_cb_neigh_changed(void *ptr) {
+  struct oonf_layer2_neigh *l2neigh;
+  struct oonf_layer2_history *history;
+  uint64_t now;
+  int i;
+
+  if (_history_users == 0) {
+    return;
+  }
+
+  l2neigh = ptr;
+  history = oonf_class_get_extension(&_history_extension, l2neigh);
+  now = oonf_clock_getNow();
+
+  for (i=0; i<OONF_LAYER2_NEIGH_COUNT; i++) {
+    if (oonf_layer2_has_value(&l2neigh->data[i])) {
+      oonf_layer2_history_append(&history[i], now,
+          oonf_layer2_get_value(&l2neigh->data[i]));
+    }
+  }
+}
+
+/**
+ * Recalculate minimum and maximum of the samples of a history ring
+ * @param history pointer to layer-2 history
+ */
+static void
+_update_min_max(struct oonf_layer2_history *history) {
+  size_t i;
+
+  history->min = history->samples[0].value;
+  history->max = history->samples[0].value;
+
+  for (i=1; i<history->count; i++) {
+    if (history->samples[i].value < history->min) {
+      history->min = history->samples[i].value;
+    }
+    if (history->samples[i].value > history->max) {
+      history->max = history->samples[i].value;
+    }
+  }
+}
@@ -0,0 +1,113 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2013, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+#ifndef OONF_LAYER2_HISTORY_H_
+#define OONF_LAYER2_HISTORY_H_
+
+#include "common/common_types.h"
+#include "subsystems/oonf_layer2.h"
+
+/* number of samples stored for each value of a layer-2 neighbor */
+#define OONF_LAYER2_HISTORY_SIZE 8
+
+/* weight of a new sample in the moving average is 1/2^shift */
+#define OONF_LAYER2_HISTORY_EWMA_SHIFT 3
+
+/*
+ * one committed value of a layer-2 neighbor. Each change event of a
+ * neighbor (every commit, or once per layer-2 transaction) adds a
+ * sample for all values of the neighbor, changed or not, so the
+ * ring stays a regular time series.
+ */
+struct oonf_layer2_sample {
+  /* time when the value was committed */
+  uint64_t timestamp;
+
+  /* value of the layer-2 data */
+  int64_t value;
+};
+
+/* history of the values of one layer-2 neighbor data index */
+struct oonf_layer2_history {
+  /* ring buffer of the last samples */
+  struct oonf_layer2_sample samples[OONF_LAYER2_HISTORY_SIZE];
+
+  /* number of valid samples in the ring */
+  uint8_t count;
+
+  /* exponentially weighted moving average of all samples */
+  int64_t ewma;
+
+  /* minimum and maximum of the samples in the ring */
+  int64_t min, max;
+
+  /* position of the next sample in the ring */
+  uint8_t _next;
+
+  /* moving average multiplied by 2^OONF_LAYER2_HISTORY_EWMA_SHIFT */
+  int64_t _ewma_scaled;
+};
+
+EXPORT int oonf_layer2_history_add(void);
+EXPORT void oonf_layer2_history_remove(void);
+
+EXPORT struct oonf_layer2_history *oonf_layer2_history_get(
+    struct oonf_layer2_neigh *, enum oonf_layer2_neighbor_index);
+EXPORT void oonf_layer2_history_append(struct oonf_layer2_history *,
+    uint64_t timestamp, int64_t value);
+
+/**
+ * @param history pointer to layer-2 history
+ * @param age age of the sample, 0 is the newest one
+ * @return pointer to sample, NULL if there is no sample of this age
+ */
+static INLINE const struct oonf_layer2_sample *
+oonf_layer2_history_get_sample(const struct oonf_layer2_history *history,
+    size_t age) {
+  if (age >= history->count) {
+    return NULL;
+  }
+  return &history->samples[(history->_next + OONF_LAYER2_HISTORY_SIZE - 1 - age)
+                           % OONF_LAYER2_HISTORY_SIZE];
+}
+
+#endif /* OONF_LAYER2_HISTORY_H_ */
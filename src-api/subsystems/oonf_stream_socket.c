@@ -49,8 +49,10 @@
 #include "core/oonf_logging.h"
 #include "core/oonf_subsystem.h"
 #include "subsystems/oonf_class.h"
+#include "subsystems/oonf_clock.h"
 #include "subsystems/oonf_socket.h"
 #include "subsystems/oonf_timer.h"
+#include "subsystems/os_clock.h"
 #include "subsystems/os_net.h"
 #include "subsystems/oonf_stream_socket.h"
 
@@ -61,9 +63,13 @@ static void _cleanup(void);
 static int _apply_managed_socket(struct oonf_stream_managed *managed,
     struct oonf_stream_socket *stream, struct netaddr *bindto, uint16_t port);
 static void _cb_parse_request(int fd, void *data, bool, bool);
+static bool _check_accept_rate(struct oonf_stream_socket *comport);
 static struct oonf_stream_session *_create_session(
     struct oonf_stream_socket *stream_socket, int sock, struct netaddr *remote_addr);
 static void _cb_parse_connection(int fd, void *data, bool r,bool w);
+static enum oonf_stream_session_state _call_session_handler(
+    struct oonf_stream_session *session,
+    enum oonf_stream_session_state (*handler)(struct oonf_stream_session *));
 
 static void _cb_timeout_handler(void *);
 
@@ -73,7 +79,8 @@ struct list_entity oonf_stream_head;
 /* server socket */
 static struct oonf_class _connection_cookie = {
   .name = "stream socket connection",
-  .size = sizeof(struct oonf_stream_session)
+  .size = sizeof(struct oonf_stream_session),
+  .to_keystring = oonf_stream_session_to_keystring,
 };
 
 static struct oonf_timer_info _connection_timeout = {
@@ -349,6 +356,9 @@ oonf_stream_apply_managed(struct oonf_stream_managed *managed,
     struct oonf_stream_managed_config *config) {
   netaddr_acl_copy(&managed->acl, &config->acl);
 
+  managed->config.accept_rate = config->accept_rate;
+  managed->config.accept_burst = config->accept_burst;
+
   if (_apply_managed_socket(managed,
       &managed->socket_v4, &config->bindto_v4, config->port)) {
     return -1;
@@ -404,7 +414,9 @@ _apply_managed_socket(struct oonf_stream_managed *managed,
 
   if (list_is_node_added(&stream->scheduler_entry._node)) {
     if (memcmp(&sock, &stream->local_socket, sizeof(sock)) == 0) {
-      /* nothing changed */
+      /* same socket, only update the accept rate limit */
+      stream->config.accept_rate = managed->config.accept_rate;
+      stream->config.accept_burst = managed->config.accept_burst;
       return 0;
     }
 
@@ -460,13 +472,67 @@ _cb_parse_request(int fd, void *data, bool event_read,
       OONF_DEBUG(LOG_STREAM, "Access from %s to socket %s blocked because of ACL",
           netaddr_to_string(&buf1, &remote_addr),
           netaddr_socket_to_string(&buf2, &comport->local_socket));
+      comport->rejected_acl++;
       close(sock);
       return;
     }
   }
+
+  if (!_check_accept_rate(comport)) {
+    OONF_DEBUG(LOG_STREAM, "Access from %s to socket %s blocked because of accept rate",
+        netaddr_to_string(&buf1, &remote_addr),
+        netaddr_socket_to_string(&buf2, &comport->local_socket));
+    comport->rejected_rate++;
+    close(sock);
+    return;
+  }
+
+  comport->accepted++;
   _create_session(comport, sock, &remote_addr);
 }
 
+/**
+ * Check the token bucket of the accept rate limiter of a stream
+ * socket and consume a token for a new connection.
+ * @param comport pointer to stream socket
+ * @return true if the connection can be accepted, false otherwise
+ */
+static bool
+_check_accept_rate(struct oonf_stream_socket *comport) {
+  uint64_t now, burst;
+
+  if (comport->config.accept_rate == 0) {
+    return true;
+  }
+
+  burst = comport->config.accept_burst;
+  if (burst == 0) {
+    burst = comport->config.accept_rate;
+  }
+  burst *= 1000;
+
+  now = oonf_clock_getNow();
+  if (comport->_accept_timestamp == 0) {
+    /* first connection, start with a full bucket */
+    comport->_accept_tokens = burst;
+  }
+  else {
+    /* milliseconds times connections per second is 1/1000 connections */
+    comport->_accept_tokens +=
+        (now - comport->_accept_timestamp) * comport->config.accept_rate;
+    if (comport->_accept_tokens > burst) {
+      comport->_accept_tokens = burst;
+    }
+  }
+  comport->_accept_timestamp = now;
+
+  if (comport->_accept_tokens < 1000) {
+    return false;
+  }
+  comport->_accept_tokens -= 1000;
+  return true;
+}
+
 /**
  * Configure a TCP session socket
  * @param stream_socket pointer to stream socket
@@ -521,6 +587,7 @@ _create_session(struct oonf_stream_socket *stream_socket,
     session->state = STREAM_SESSION_ACTIVE;
   } else {
     /* too many sessions */
+    stream_socket->rejected_sessions++;
     if (stream_socket->config.create_error) {
       stream_socket->config.create_error(session, STREAM_SERVICE_UNAVAILABLE);
     }
@@ -618,6 +685,8 @@ _cb_parse_connection(int fd, void *data, bool event_read, bool event_write) {
     len = os_net_recvfrom(fd, buffer, sizeof(buffer), NULL, 0);
     if (len > 0) {
       OONF_DEBUG(LOG_STREAM, "  recv returned %d\n", len);
+      session->bytes_in += len;
+      s_sock->bytes_in += len;
       if (abuf_memcpy(&session->in, buffer, len)) {
         /* out of memory */
         OONF_WARN(LOG_STREAM, "Out of memory for comport session input buffer");
@@ -646,7 +715,7 @@ _cb_parse_connection(int fd, void *data, bool event_read, bool event_write) {
 
   if (session->state == STREAM_SESSION_ACTIVE && s_sock->config.receive_data != NULL
       && (abuf_getlen(&session->in) > 0 || session->send_first)) {
-    session->state = s_sock->config.receive_data(session);
+    session->state = _call_session_handler(session, s_sock->config.receive_data);
     session->send_first = false;
   }
 
@@ -657,6 +726,8 @@ _cb_parse_connection(int fd, void *data, bool event_read, bool event_write) {
 
       if (len > 0) {
         OONF_DEBUG(LOG_STREAM, "  send returned %d\n", len);
+        session->bytes_out += len;
+        s_sock->bytes_out += len;
         abuf_pull(&session->out, len);
         oonf_stream_set_timeout(session, s_sock->config.session_timeout);
       } else if (len < 0 && errno != EINTR && errno != EAGAIN && errno
@@ -671,6 +742,12 @@ _cb_parse_connection(int fd, void *data, bool event_read, bool event_write) {
     }
   }
 
+  /* ask session user for the next block of output */
+  if (session->state == STREAM_SESSION_ACTIVE && event_write
+      && abuf_getlen(&session->out) == 0 && s_sock->config.buffer_underrun != NULL) {
+    session->state = _call_session_handler(session, s_sock->config.buffer_underrun);
+  }
+
   if (abuf_getlen(&session->out) == 0) {
     /* nothing to send anymore */
     OONF_DEBUG(LOG_STREAM, "  deactivating output in scheduler\n");
@@ -697,3 +774,58 @@ _cb_parse_connection(int fd, void *data, bool event_read, bool event_write) {
   }
   return;
 }
+
+/**
+ * Call a callback of the session user and account its runtime
+ * to the session and the stream socket
+ * @param session pointer to stream session
+ * @param handler pointer to callback
+ * @return new state of the session
+ */
+static enum oonf_stream_session_state
+_call_session_handler(struct oonf_stream_session *session,
+    enum oonf_stream_session_state (*handler)(struct oonf_stream_session *)) {
+  enum oonf_stream_session_state state;
+  uint64_t start, end;
+
+  os_clock_gettime64_usec(&start);
+  state = handler(session);
+  os_clock_gettime64_usec(&end);
+
+  session->callback_count++;
+  session->callback_time += end - start;
+
+  session->comport->callback_count++;
+  session->comport->callback_time += end - start;
+  return state;
+}
+
+/**
+ * Converts a stream session into a human readable key consisting of
+ * the remote address and the local socket. The statistics of the
+ * session are not part of the key because they change during its
+ * lifetime, they are displayed by "resources stream" of the
+ * remotecontrol plugin. Can be used as to_keystring callback for
+ * all classes used as stream socket memcookie.
+ * @param buf buffer for key
+ * @param class pointer to class of session
+ * @param ptr pointer to stream session
+ * @return pointer to buffer
+ */
+const char *
+oonf_stream_session_to_keystring(struct oonf_objectkey_str *buf,
+    struct oonf_class *class __attribute__((unused)), void *ptr) {
+  struct oonf_stream_session *session = ptr;
+  struct netaddr_str nbuf1, nbuf2;
+
+  if (session->comport == NULL) {
+    snprintf(buf->buf, sizeof(*buf), "%s",
+        netaddr_to_string(&nbuf1, &session->remote_address));
+    return buf->buf;
+  }
+
+  snprintf(buf->buf, sizeof(*buf), "%s->%s",
+      netaddr_to_string(&nbuf1, &session->remote_address),
+      netaddr_socket_to_string(&nbuf2, &session->comport->local_socket));
+  return buf->buf;
+}
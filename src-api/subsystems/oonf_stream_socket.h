@@ -113,6 +113,17 @@ struct oonf_stream_session {
   bool removed;
 
   enum oonf_stream_session_state state;
+
+  /* number of bytes received from and sent to the peer (R) */
+  uint64_t bytes_in;
+  uint64_t bytes_out;
+
+  /*
+   * number of calls and total runtime (in microseconds) of the
+   * receive_data and buffer_underrun callbacks for this session (R)
+   */
+  uint64_t callback_count;
+  uint64_t callback_time;
 };
 
 struct oonf_stream_config {
@@ -140,6 +151,19 @@ struct oonf_stream_config {
   /* only clients that match the acl (if set) can connect */
   struct netaddr_acl *acl;
 
+  /*
+   * maximum number of incoming connections per second, 0 if there
+   * is no limit. Connections above the limit are closed directly
+   * after they have been accepted.
+   */
+  uint32_t accept_rate;
+
+  /*
+   * maximum number of incoming connections that can be accepted
+   * at once after an idle period (default accept_rate)
+   */
+  uint32_t accept_burst;
+
   /* Called when a new session is created */
   int (*init)(struct oonf_stream_session *);
 
@@ -156,6 +180,13 @@ struct oonf_stream_config {
    * Called when new data will be available in the input buffer
    */
   enum oonf_stream_session_state (*receive_data)(struct oonf_stream_session *);
+
+  /*
+   * Called when the output buffer of an active session has been
+   * completely sent. Allows the user to generate large answers
+   * block by block instead of putting them into memory at once.
+   */
+  enum oonf_stream_session_state (*buffer_underrun)(struct oonf_stream_session *);
 };
 
 /*
@@ -173,6 +204,27 @@ struct oonf_stream_socket {
 
   struct oonf_stream_config config;
 
+  /* number of incoming connections that have been accepted */
+  uint64_t accepted;
+
+  /*
+   * number of incoming connections that have been rejected because
+   * of the ACL, the accept rate limit or the session limit
+   */
+  uint64_t rejected_acl;
+  uint64_t rejected_rate;
+  uint64_t rejected_sessions;
+
+  /* sum of the statistics of all sessions of this socket */
+  uint64_t bytes_in;
+  uint64_t bytes_out;
+  uint64_t callback_count;
+  uint64_t callback_time;
+
+  /* token bucket of the accept rate limiter (in 1/1000 connections) */
+  uint64_t _accept_tokens;
+  uint64_t _accept_timestamp;
+
   bool busy;
   bool remove;
   bool remove_when_finished;
@@ -191,11 +243,17 @@ struct oonf_stream_managed_config {
   struct netaddr bindto_v4;
   struct netaddr bindto_v6;
   int32_t port;
+
+  /* accept rate limit, see struct oonf_stream_config */
+  int32_t accept_rate;
+  int32_t accept_burst;
 };
 
 #define LOG_STREAM oonf_stream_socket_subsystem.logging
 EXPORT extern struct oonf_subsystem oonf_stream_socket_subsystem;
 
+EXPORT extern struct list_entity oonf_stream_head;
+
 EXPORT int oonf_stream_add(struct oonf_stream_socket *,
     const union netaddr_socket *local);
 EXPORT void oonf_stream_remove(struct oonf_stream_socket *, bool force);
@@ -212,4 +270,7 @@ EXPORT int oonf_stream_apply_managed(struct oonf_stream_managed *,
     struct oonf_stream_managed_config *);
 EXPORT void oonf_stream_remove_managed(struct oonf_stream_managed *, bool force);
 
+EXPORT const char *oonf_stream_session_to_keystring(
+    struct oonf_objectkey_str *, struct oonf_class *, void *);
+
 #endif /* OONF_STREAM_SOCKET_H_ */
@@ -53,6 +53,7 @@
 #include "subsystems/oonf_stream_socket.h"
 #include "subsystems/oonf_telnet.h"
 #include "subsystems/oonf_timer.h"
+#include "subsystems/os_clock.h"
 
 /* static function prototypes */
 static int _init(void);
@@ -66,6 +67,12 @@ static void _cb_telnet_create_error(struct oonf_stream_session *,
     enum oonf_stream_errors);
 static enum oonf_stream_session_state _cb_telnet_receive_data(
     struct oonf_stream_session *);
+static enum oonf_stream_session_state _cb_telnet_buffer_underrun(
+    struct oonf_stream_session *);
+static enum oonf_stream_session_state _handle_input(
+    struct oonf_telnet_session *telnet_session, bool processed_command);
+static enum oonf_stream_session_state _execute_commands(
+    struct oonf_telnet_session *telnet_session, char *cmd);
 static enum oonf_telnet_result _telnet_handle_command(
     struct oonf_telnet_data *);
 static struct oonf_telnet_command *_check_telnet_command(
@@ -78,6 +85,7 @@ static enum oonf_telnet_result _cb_telnet_help(struct oonf_telnet_data *data);
 static enum oonf_telnet_result _cb_telnet_echo(struct oonf_telnet_data *data);
 static enum oonf_telnet_result _cb_telnet_repeat(struct oonf_telnet_data *data);
 static enum oonf_telnet_result _cb_telnet_timeout(struct oonf_telnet_data *data);
+static enum oonf_telnet_result _cb_telnet_time(struct oonf_telnet_data *data);
 static enum oonf_telnet_result _cb_telnet_version(struct oonf_telnet_data *data);
 
 /* configuration of telnet server */
@@ -90,6 +98,13 @@ static struct cfg_schema_entry _telnet_entries[] = {
       bindto_v6, "bindto_v6", "::1", "Bind telnet ipv6 socket to this address", false, true),
   CFG_MAP_INT32_MINMAX(oonf_stream_managed_config,
       port, "port", "2006", "Network port for telnet interface", 0, false, 1, 65535),
+  CFG_MAP_INT32_MINMAX(oonf_stream_managed_config,
+      accept_rate, "accept_rate", "10",
+      "Maximum number of new connections per second for telnet interface, 0 for no limit", 0, false, 0, 65535),
+  CFG_MAP_INT32_MINMAX(oonf_stream_managed_config,
+      accept_burst, "accept_burst", "20",
+      "Maximum number of new connections for telnet interface accepted at once after an idle period,"
+      " 0 to use accept_rate", 0, false, 0, 65535),
 };
 
 static struct cfg_schema_section _telnet_section = {
@@ -112,6 +127,8 @@ static struct oonf_telnet_command _builtin[] = {
       "repeat <seconds> <command>: Repeats a telnet command every X seconds"),
   TELNET_CMD("timeout", _cb_telnet_timeout,
       "timeout <seconds> :Sets telnet session timeout"),
+  TELNET_CMD("time", _cb_telnet_time,
+      "time <command>: Executes a telnet command and displays its runtime"),
   TELNET_CMD("version", _cb_telnet_version, "Displays version of the program"),
 
 };
@@ -128,6 +145,7 @@ struct oonf_subsystem oonf_telnet_subsystem = {
 static struct oonf_class _telnet_memcookie = {
   .name = "telnet session",
   .size = sizeof(struct oonf_telnet_session),
+  .to_keystring = oonf_stream_session_to_keystring,
 };
 static struct oonf_timer_info _telnet_repeat_timerinfo = {
   .name = "txt repeat timer",
@@ -144,6 +162,7 @@ static struct oonf_stream_managed _telnet_managed = {
     .init = _cb_telnet_init,
     .cleanup = _cb_telnet_cleanup,
     .receive_data = _cb_telnet_receive_data,
+    .buffer_underrun = _cb_telnet_buffer_underrun,
     .create_error = _cb_telnet_create_error,
   },
 };
@@ -240,6 +259,150 @@ oonf_telnet_execute(const char *cmd, const char *para,
   return result;
 }
 
+/**
+ * Execute a telnet command and generate typed records instead
+ * of text output. The output of commands without a binary handler
+ * will be wrapped into TELNET_RECORD_TEXT entries.
+ * @param cmd pointer to name of command
+ * @param para pointer to parameter string
+ * @param out buffer for output of command
+ * @param remote pointer to address which triggers the execution
+ * @return result of telnet command
+ */
+enum oonf_telnet_result
+oonf_telnet_execute_binary(const char *cmd, const char *para,
+    struct autobuf *out, struct netaddr *remote) {
+  struct oonf_telnet_data data;
+  enum oonf_telnet_result result;
+
+  memset(&data, 0, sizeof(data));
+  data.command = cmd;
+  data.parameter = para;
+  data.out = out;
+  data.remote = remote;
+  data.binary = true;
+
+  result = _telnet_handle_command(&data);
+  oonf_telnet_stop(&data);
+  return result;
+}
+
+/**
+ * Call the text handler of a telnet command and wrap its output
+ * into typed TELNET_RECORD_TEXT entries. Binary handlers can use
+ * this for subcommands that have no typed output.
+ * @param cmd pointer to telnet command
+ * @param data pointer to telnet data
+ * @return telnet result code
+ */
+enum oonf_telnet_result
+oonf_telnet_execute_text_as_binary(struct oonf_telnet_command *cmd,
+    struct oonf_telnet_data *data) {
+  enum oonf_telnet_result result;
+  struct autobuf text, *out;
+  size_t offset, length;
+
+  if (abuf_init(&text)) {
+    return TELNET_RESULT_INTERNAL_ERROR;
+  }
+
+  out = data->out;
+  data->out = &text;
+  result = cmd->handler(data);
+  data->out = out;
+
+  for (offset = 0; offset < abuf_getlen(&text); offset += length) {
+    length = abuf_getlen(&text) - offset;
+    if (length > TELNET_RECORD_MAX_VALUE) {
+      length = TELNET_RECORD_MAX_VALUE;
+    }
+
+    oonf_telnet_record_add(data, TELNET_RECORD_TEXT, NULL,
+        abuf_getptr(&text) + offset, length);
+  }
+
+  abuf_free(&text);
+  return result;
+}
+
+/**
+ * Add an entry to the typed output of a telnet command
+ * @param data pointer to telnet data
+ * @param type type of entry
+ * @param key name of the entry, NULL if no name
+ * @param value pointer to binary value, NULL if no value
+ * @param length length of the value
+ * @return -1 if an error happened, 0 otherwise
+ */
+int
+oonf_telnet_record_add(struct oonf_telnet_data *data,
+    enum oonf_telnet_record_type type, const char *key,
+    const void *value, size_t length) {
+  size_t key_length;
+
+  key_length = key == NULL ? 0 : strlen(key);
+  if (key_length > 255 || length > TELNET_RECORD_MAX_VALUE) {
+    return -1;
+  }
+
+  abuf_append_uint8(data->out, type);
+  abuf_append_uint8(data->out, key_length);
+  abuf_append_uint16(data->out, htons(length));
+  if (key_length) {
+    abuf_memcpy(data->out, key, key_length);
+  }
+  if (length) {
+    abuf_memcpy(data->out, value, length);
+  }
+  return abuf_has_failed(data->out) ? -1 : 0;
+}
+
+/**
+ * Add a signed 64 bit integer to the current typed output record
+ * @param data pointer to telnet data
+ * @param key name of the value
+ * @param value integer value
+ * @return -1 if an error happened, 0 otherwise
+ */
+int
+oonf_telnet_record_int64(struct oonf_telnet_data *data,
+    const char *key, int64_t value) {
+  uint8_t buffer[8];
+  uint64_t v;
+  int i;
+
+  v = (uint64_t)value;
+  for (i=7; i>=0; i--) {
+    buffer[i] = v & 0xff;
+    v >>= 8;
+  }
+  return oonf_telnet_record_add(data, TELNET_RECORD_INT64,
+      key, buffer, sizeof(buffer));
+}
+
+/**
+ * Add a network address to the current typed output record
+ * @param data pointer to telnet data
+ * @param key name of the value
+ * @param addr pointer to address
+ * @return -1 if an error happened, 0 otherwise
+ */
+int
+oonf_telnet_record_netaddr(struct oonf_telnet_data *data,
+    const char *key, const struct netaddr *addr) {
+  uint8_t buffer[2 + 16];
+  size_t length;
+
+  length = netaddr_get_binlength(addr);
+
+  buffer[0] = netaddr_get_address_family(addr);
+  buffer[1] = netaddr_get_prefix_length(addr);
+  memcpy(&buffer[2], netaddr_get_binptr(addr), length);
+
+  return oonf_telnet_record_add(data, TELNET_RECORD_NETADDR,
+      key, buffer, 2 + length);
+}
+
 /**
  * Handler for configuration changes
  */
@@ -286,7 +449,7 @@ _cb_telnet_init(struct oonf_stream_session *session) {
 
   list_init_head(&telnet_session->data.cleanup_list);
 
-  return 0;
+  return abuf_init(&telnet_session->_cmdline);
 }
 
 /**
@@ -312,6 +475,8 @@ _cb_telnet_cleanup(struct oonf_stream_session *session) {
     /* after this command the handler pointer might not be valid anymore */
     handler->cleanup_handler(handler);
   }
+
+  abuf_free(&telnet_session->_cmdline);
 }
 
 /**
@@ -364,22 +529,73 @@ _call_stop_handler(struct oonf_telnet_data *data) {
  */
 static enum oonf_stream_session_state
 _cb_telnet_receive_data(struct oonf_stream_session *session) {
-  static const char defaultCommand[] = "/link/neigh/topology/hna/mid/routes";
-  static char tmpbuf[128];
+  struct oonf_telnet_session *telnet_session;
+
+  /* get telnet session pointer */
+  telnet_session = (struct oonf_telnet_session *)session;
 
+  if (telnet_session->_next_command) {
+    /* wait until the output of the current line has been sent */
+    return STREAM_SESSION_ACTIVE;
+  }
+  return _handle_input(telnet_session, false);
+}
+
+/**
+ * Handler for an empty output buffer of a telnet session,
+ * continues a paused command line.
+ * @param session pointer to TCP session
+ * @return TCP session state
+ */
+static enum oonf_stream_session_state
+_cb_telnet_buffer_underrun(struct oonf_stream_session *session) {
   struct oonf_telnet_session *telnet_session;
-  enum oonf_telnet_result cmd_result;
-  char *eol;
-  int len;
-  bool processedCommand = false, chainCommands = false;
+  enum oonf_stream_session_state state;
 
   /* get telnet session pointer */
   telnet_session = (struct oonf_telnet_session *)session;
 
+  if (telnet_session->_next_command == NULL) {
+    return session->state;
+  }
+
+  OONF_DEBUG(LOG_TELNET, "Resume telnet command line at '%s'",
+      telnet_session->_next_command);
+
+  state = _execute_commands(telnet_session, telnet_session->_next_command);
+  if (state != STREAM_SESSION_ACTIVE || telnet_session->_next_command) {
+    return state;
+  }
+
+  if (abuf_getptr(&session->in)[0] == '/') {
+    /* end of multiple command line */
+    return STREAM_SESSION_SEND_AND_QUIT;
+  }
+
+  /* continue with the rest of the input */
+  return _handle_input(telnet_session, true);
+}
+
+/**
+ * Process all complete lines in the input buffer of a telnet session
+ * @param telnet_session pointer to telnet session
+ * @param processed_command true if a command has already been processed
+ *   and the prompt has to be printed
+ * @return TCP session state
+ */
+static enum oonf_stream_session_state
+_handle_input(struct oonf_telnet_session *telnet_session,
+    bool processed_command) {
+  static const char defaultCommand[] = "/link/neigh/topology/hna/mid/routes";
+
+  struct oonf_stream_session *session;
+  enum oonf_stream_session_state state;
+  char *eol, *cmd;
+
+  session = &telnet_session->session;
+
   /* loop over input */
   while (abuf_getlen(&session->in) > 0) {
-    char *para = NULL, *cmd = NULL, *next = NULL;
-
     /* search for end of line */
     eol = memchr(abuf_getptr(&session->in), '\n', abuf_getlen(&session->in));
 
@@ -395,79 +611,42 @@ _cb_telnet_receive_data(struct oonf_stream_session *session) {
 
     /* handle line */
     OONF_DEBUG(LOG_TELNET, "Interactive console: %s\n", abuf_getptr(&session->in));
-    cmd = abuf_getptr(&session->in);
-    processedCommand = true;
+    processed_command = true;
+
+    /* copy line, it must stay valid if the execution is paused */
+    abuf_clear(&telnet_session->_cmdline);
+    if (strcmp(abuf_getptr(&session->in), "/") == 0) {
+      /* apply default command */
+      abuf_puts(&telnet_session->_cmdline, defaultCommand);
+    }
+    else {
+      abuf_puts(&telnet_session->_cmdline, abuf_getptr(&session->in));
+    }
+
+    /* remove line from input buffer */
+    abuf_pull(&session->in, eol - abuf_getptr(&session->in));
 
-    /* apply default command */
-    if (strcmp(cmd, "/") == 0) {
-      strcpy(tmpbuf, defaultCommand);
-      cmd = tmpbuf;
+    if (abuf_has_failed(&telnet_session->_cmdline)) {
+      abuf_puts(&session->out, "Error, out of memory for command line\n");
+      continue;
     }
 
-    if (cmd[0] == '/') {
+    cmd = abuf_getptr(&telnet_session->_cmdline);
+    telnet_session->_chain_commands = cmd[0] == '/';
+    if (telnet_session->_chain_commands) {
       cmd++;
-      chainCommands = true;
     }
-    while (cmd) {
-      len = abuf_getlen(&session->out);
-
-      /* handle difference between multicommand and singlecommand mode */
-      if (chainCommands) {
-        next = strchr(cmd, '/');
-        if (next) {
-          *next++ = 0;
-        }
-      }
-      para = strchr(cmd, ' ');
-      if (para != NULL) {
-        *para++ = 0;
-      }
 
-      /* if we are doing continous output, stop it ! */
-      _call_stop_handler(&telnet_session->data);
-
-      if (strlen(cmd) != 0) {
-        OONF_DEBUG(LOG_TELNET, "Processing telnet command: '%s' '%s'",
-            cmd, para);
-
-        telnet_session->data.command = cmd;
-        telnet_session->data.parameter = para;
-
-        cmd_result = _telnet_handle_command(&telnet_session->data);
-        if (abuf_has_failed(telnet_session->data.out)) {
-          cmd_result = TELNET_RESULT_INTERNAL_ERROR;
-        }
-
-        switch (cmd_result) {
-          case TELNET_RESULT_ACTIVE:
-            break;
-          case TELNET_RESULT_CONTINOUS:
-            telnet_session->data.show_echo = false;
-            break;
-          case _TELNET_RESULT_UNKNOWN_COMMAND:
-            abuf_setlen(&session->out, len);
-            abuf_appendf(&session->out, "Error, unknown command '%s'\n", cmd);
-            break;
-          case TELNET_RESULT_QUIT:
-            return STREAM_SESSION_SEND_AND_QUIT;
-          case TELNET_RESULT_INTERNAL_ERROR:
-          default:
-            /* reset stream */
-            abuf_setlen(&session->out, len);
-            abuf_appendf(&session->out,
-                "Error in autobuffer during command '%s'.\n", cmd);
-            break;
-        }
-        /* put an empty line behind each command */
-        if (telnet_session->data.show_echo) {
-          abuf_puts(&session->out, "\n");
-        }
-      }
-      cmd = next;
+    state = _execute_commands(telnet_session, cmd);
+    if (state != STREAM_SESSION_ACTIVE) {
+      return state;
     }
 
-    /* remove line from input buffer */
-    abuf_pull(&session->in, eol - abuf_getptr(&session->in));
+    if (telnet_session->_next_command) {
+      /* output buffer is full, continue when it has been sent */
+      oonf_stream_set_timeout(session, telnet_session->data.timeout_value);
+      return STREAM_SESSION_ACTIVE;
+    }
 
     if (abuf_getptr(&session->in)[0] == '/') {
       /* end of multiple command line */
@@ -479,7 +658,7 @@ _cb_telnet_receive_data(struct oonf_stream_session *session) {
   oonf_stream_set_timeout(session, telnet_session->data.timeout_value);
 
   /* print prompt */
-  if (processedCommand && session->state == STREAM_SESSION_ACTIVE
+  if (processed_command && session->state == STREAM_SESSION_ACTIVE
       && telnet_session->data.show_echo) {
     abuf_puts(&session->out, "> ");
   }
@@ -487,6 +666,90 @@ _cb_telnet_receive_data(struct oonf_stream_session *session) {
   return STREAM_SESSION_ACTIVE;
 }
 
+/**
+ * Execute the commands of a command line until the end of the line
+ * or until the output buffer is above the watermark.
+ * @param telnet_session pointer to telnet session
+ * @param cmd pointer to first command to execute
+ * @return TCP session state
+ */
+static enum oonf_stream_session_state
+_execute_commands(struct oonf_telnet_session *telnet_session, char *cmd) {
+  struct oonf_stream_session *session;
+  enum oonf_telnet_result cmd_result;
+  char *para, *next;
+  size_t len;
+
+  session = &telnet_session->session;
+  telnet_session->_next_command = NULL;
+
+  while (cmd) {
+    if (abuf_getlen(&session->out) > TELNET_OUTPUT_WATERMARK) {
+      /* pause until client has received the output */
+      telnet_session->_next_command = cmd;
+      return STREAM_SESSION_ACTIVE;
+    }
+
+    len = abuf_getlen(&session->out);
+    next = NULL;
+
+    /* handle difference between multicommand and singlecommand mode */
+    if (telnet_session->_chain_commands) {
+      next = strchr(cmd, '/');
+      if (next) {
+        *next++ = 0;
+      }
+    }
+    para = strchr(cmd, ' ');
+    if (para != NULL) {
+      *para++ = 0;
+    }
+
+    /* if we are doing continous output, stop it ! */
+    _call_stop_handler(&telnet_session->data);
+
+    if (strlen(cmd) != 0) {
+      OONF_DEBUG(LOG_TELNET, "Processing telnet command: '%s' '%s'",
+          cmd, para);
+
+      telnet_session->data.command = cmd;
+      telnet_session->data.parameter = para;
+
+      cmd_result = _telnet_handle_command(&telnet_session->data);
+      if (abuf_has_failed(telnet_session->data.out)) {
+        cmd_result = TELNET_RESULT_INTERNAL_ERROR;
+      }
+
+      switch (cmd_result) {
+        case TELNET_RESULT_ACTIVE:
+          break;
+        case TELNET_RESULT_CONTINOUS:
+          telnet_session->data.show_echo = false;
+          break;
+        case _TELNET_RESULT_UNKNOWN_COMMAND:
+          abuf_setlen(&session->out, len);
+          abuf_appendf(&session->out, "Error, unknown command '%s'\n", cmd);
+          break;
+        case TELNET_RESULT_QUIT:
+          return STREAM_SESSION_SEND_AND_QUIT;
+        case TELNET_RESULT_INTERNAL_ERROR:
+        default:
+          /* reset stream */
+          abuf_setlen(&session->out, len);
+          abuf_appendf(&session->out,
+              "Error in autobuffer during command '%s'.\n", cmd);
+          break;
+      }
+      /* put an empty line behind each command */
+      if (telnet_session->data.show_echo) {
+        abuf_puts(&session->out, "\n");
+      }
+    }
+    cmd = next;
+  }
+  return STREAM_SESSION_ACTIVE;
+}
+
 /**
  * Helper function to call telnet command handler
  * @param data pointer to telnet data
@@ -495,6 +758,8 @@ _cb_telnet_receive_data(struct oonf_stream_session *session) {
 static enum oonf_telnet_result
 _telnet_handle_command(struct oonf_telnet_data *data) {
   struct oonf_telnet_command *cmd;
+  enum oonf_telnet_result result;
+  uint64_t start, end;
 #ifdef OONF_LOG_INFO
   struct netaddr_str buf;
 #endif
@@ -506,7 +771,23 @@ _telnet_handle_command(struct oonf_telnet_data *data) {
   OONF_INFO(LOG_TELNET, "Executing command from %s: %s %s",
       netaddr_to_string(&buf, data->remote), data->command,
       data->parameter == NULL ? "" : data->parameter);
-  return cmd->handler(data);
+
+  os_clock_gettime64_usec(&start);
+  if (!data->binary) {
+    result = cmd->handler(data);
+  }
+  else if (cmd->binary_handler) {
+    result = cmd->binary_handler(data);
+  }
+  else {
+    result = oonf_telnet_execute_text_as_binary(cmd, data);
+  }
+  os_clock_gettime64_usec(&end);
+
+  data->runtime = end - start;
+  OONF_DEBUG(LOG_TELNET, "Command '%s' finished after %"PRIu64" microseconds",
+      cmd->command, data->runtime);
+  return result;
 }
 
 /**
@@ -654,6 +935,13 @@ _cb_telnet_repeat_timer(void *ptr) {
   struct oonf_telnet_data *telnet_data = ptr;
   struct oonf_telnet_session *session;
 
+  if (oonf_telnet_is_output_congested(telnet_data)) {
+    /* client does not keep up with the output, skip this interval */
+    OONF_DEBUG(LOG_TELNET, "Skip repeated command '%s', output buffer is full",
+        (const char *)telnet_data->stop_data[1]);
+    return;
+  }
+
   /* set command/parameter with repeat settings */
   telnet_data->command = telnet_data->stop_data[1];
   telnet_data->parameter = telnet_data->stop_data[2];
@@ -729,6 +1017,57 @@ _cb_telnet_repeat(struct oonf_telnet_data *data) {
   return TELNET_RESULT_CONTINOUS;
 }
 
+/**
+ * Telnet command 'time'
+ * @param data pointer to telnet data
+ * @return telnet command result
+ */
+static enum oonf_telnet_result
+_cb_telnet_time(struct oonf_telnet_data *data) {
+  enum oonf_telnet_result result;
+  const char *orig_command, *orig_parameter;
+  char *cmd, *ptr;
+
+  if (data->parameter == NULL || data->parameter[0] == 0) {
+    abuf_puts(data->out, "Missing command for time\n");
+    return TELNET_RESULT_ACTIVE;
+  }
+
+  cmd = strdup(data->parameter);
+  if (cmd == NULL) {
+    return TELNET_RESULT_INTERNAL_ERROR;
+  }
+
+  orig_command = data->command;
+  orig_parameter = data->parameter;
+
+  /* split command/parameter */
+  data->command = cmd;
+  data->parameter = NULL;
+
+  ptr = strchr(cmd, ' ');
+  if (ptr != NULL) {
+    *ptr++ = 0;
+    data->parameter = ptr;
+  }
+
+  result = _telnet_handle_command(data);
+  if (result == _TELNET_RESULT_UNKNOWN_COMMAND) {
+    abuf_appendf(data->out, "Error, unknown command '%s'\n", cmd);
+    result = TELNET_RESULT_ACTIVE;
+  }
+  else if (result == TELNET_RESULT_ACTIVE) {
+    abuf_appendf(data->out, "Command '%s' took %"PRIu64".%03"PRIu64" ms\n",
+        cmd, data->runtime / 1000, data->runtime % 1000);
+  }
+
+  data->command = orig_command;
+  data->parameter = orig_parameter;
+
+  free(cmd);
+  return result;
+}
+
 /**
  * Telnet command 'version'
  * @param data pointer to telnet data
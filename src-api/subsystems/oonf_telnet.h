@@ -48,18 +48,14 @@
 #include "common/netaddr.h"
 #include "common/netaddr_acl.h"
 #include "subsystems/oonf_stream_socket.h"
+#include "subsystems/oonf_telnet_proto.h"
 
-enum oonf_telnet_result {
-  TELNET_RESULT_ACTIVE,
-  TELNET_RESULT_CONTINOUS,
-  TELNET_RESULT_INTERNAL_ERROR,
-  TELNET_RESULT_QUIT,
-
+enum {
   /*
-   * this one is used internally for the telnet API,
-   * it should not be returned by a command handler
+   * size of the output buffer (in bytes) that pauses the generation
+   * of further telnet output until the client has received it
    */
-  _TELNET_RESULT_UNKNOWN_COMMAND,
+  TELNET_OUTPUT_WATERMARK = 65536,
 };
 
 /*
@@ -100,6 +96,12 @@ struct oonf_telnet_data {
   /* millisecond timeout between commands */
   uint32_t timeout_value;
 
+  /* runtime of the last executed command in microseconds */
+  uint64_t runtime;
+
+  /* true if the command should generate typed records instead of text */
+  bool binary;
+
   /* callback and data to stop a continous output txt command */
   void (*stop_handler)(struct oonf_telnet_data *);
   void *stop_data[4];
@@ -113,6 +115,18 @@ struct oonf_telnet_data {
 struct oonf_telnet_session {
   struct oonf_stream_session session;
   struct oonf_telnet_data data;
+
+  /* copy of the command line that is currently executed */
+  struct autobuf _cmdline;
+
+  /*
+   * next command of the current line, set if the execution has been
+   * paused until the output buffer is empty. NULL otherwise.
+   */
+  char *_next_command;
+
+  /* true if the current line contains a chain of commands */
+  bool _chain_commands;
 };
 
 typedef enum oonf_telnet_result (*oonf_telnethandler)
@@ -141,6 +155,12 @@ struct oonf_telnet_command {
   /* handler for help text */
   oonf_telnethandler help_handler;
 
+  /*
+   * handler for typed output (see oonf_telnet_record_*), NULL if the
+   * command only generates text output
+   */
+  oonf_telnethandler binary_handler;
+
   /* node for tree of telnet commands */
   struct avl_node _node;
 };
@@ -148,7 +168,7 @@ struct oonf_telnet_command {
 #define LOG_TELNET oonf_telnet_subsystem.logging
 EXPORT extern struct oonf_subsystem oonf_telnet_subsystem;
 
-EXPORT struct avl_tree oonf_telnet_cmd_tree;
+EXPORT extern struct avl_tree oonf_telnet_cmd_tree;
 
 EXPORT int oonf_telnet_add(struct oonf_telnet_command *command);
 EXPORT void oonf_telnet_remove(struct oonf_telnet_command *command);
@@ -158,6 +178,19 @@ EXPORT void oonf_telnet_stop(struct oonf_telnet_data *data);
 EXPORT enum oonf_telnet_result oonf_telnet_execute(
     const char *cmd, const char *para,
     struct autobuf *out, struct netaddr *remote);
+EXPORT enum oonf_telnet_result oonf_telnet_execute_binary(
+    const char *cmd, const char *para,
+    struct autobuf *out, struct netaddr *remote);
+EXPORT enum oonf_telnet_result oonf_telnet_execute_text_as_binary(
+    struct oonf_telnet_command *cmd, struct oonf_telnet_data *data);
+
+EXPORT int oonf_telnet_record_add(struct oonf_telnet_data *data,
+    enum oonf_telnet_record_type type, const char *key,
+    const void *value, size_t length);
+EXPORT int oonf_telnet_record_int64(struct oonf_telnet_data *data,
+    const char *key, int64_t value);
+EXPORT int oonf_telnet_record_netaddr(struct oonf_telnet_data *data,
+    const char *key, const struct netaddr *addr);
 
 /**
  * Add a cleanup handler to a telnet session
@@ -180,6 +213,53 @@ oonf_telnet_remove_cleanup(struct oonf_telnet_cleanup *cleanup) {
   list_remove(&cleanup->node);
 }
 
+/**
+ * Start a new typed output record
+ * @param data pointer to telnet data
+ * @param name name of the record
+ * @return -1 if an error happened, 0 otherwise
+ */
+static INLINE int
+oonf_telnet_record_start(struct oonf_telnet_data *data, const char *name) {
+  return oonf_telnet_record_add(data, TELNET_RECORD_START, name, NULL, 0);
+}
+
+/**
+ * Ends the current typed output record
+ * @param data pointer to telnet data
+ * @return -1 if an error happened, 0 otherwise
+ */
+static INLINE int
+oonf_telnet_record_end(struct oonf_telnet_data *data) {
+  return oonf_telnet_record_add(data, TELNET_RECORD_END, NULL, NULL, 0);
+}
+
+/**
+ * Add a string value to the current typed output record
+ * @param data pointer to telnet data
+ * @param key name of the value
+ * @param value null terminated string
+ * @return -1 if an error happened, 0 otherwise
+ */
+static INLINE int
+oonf_telnet_record_string(struct oonf_telnet_data *data,
+    const char *key, const char *value) {
+  return oonf_telnet_record_add(data, TELNET_RECORD_STRING,
+      key, value, strlen(value));
+}
+
+/**
+ * Check if the client of a telnet session does not keep up with
+ * the generated output. Commands with continous output should not
+ * generate more output while this is the case.
+ * @param data pointer to telnet data
+ * @return true if output buffer is above the watermark
+ */
+static INLINE bool
+oonf_telnet_is_output_congested(struct oonf_telnet_data *data) {
+  return abuf_getlen(data->out) > TELNET_OUTPUT_WATERMARK;
+}
+
 /**
  * Flushs the output stream of a telnet session. This will be only
  * necessary for continous output.
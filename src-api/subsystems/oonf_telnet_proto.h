@@ -0,0 +1,94 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2013, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+#ifndef OONF_TELNET_PROTO_H_
+#define OONF_TELNET_PROTO_H_
+
+#include "common/common_types.h"
+
+enum oonf_telnet_result {
+  TELNET_RESULT_ACTIVE,
+  TELNET_RESULT_CONTINOUS,
+  TELNET_RESULT_INTERNAL_ERROR,
+  TELNET_RESULT_QUIT,
+
+  /*
+   * this one is used internally for the telnet API,
+   * it should not be returned by a command handler
+   */
+  _TELNET_RESULT_UNKNOWN_COMMAND,
+};
+
+/*
+ * types of the entries of the typed (binary) output of a telnet
+ * command. Each entry consists of the type (8 bit), the length
+ * of the key (8 bit), the length of the value (16 bit, network
+ * byte order), the key and the value.
+ */
+enum oonf_telnet_record_type {
+  /* begin of a record, the key contains the name of the record */
+  TELNET_RECORD_START   = 1,
+
+  /* end of the current record, no key and value */
+  TELNET_RECORD_END     = 2,
+
+  /* string value (not null terminated) */
+  TELNET_RECORD_STRING  = 3,
+
+  /* signed 64 bit integer in network byte order */
+  TELNET_RECORD_INT64   = 4,
+
+  /* address family, prefix length and binary address */
+  TELNET_RECORD_NETADDR = 5,
+
+  /* block of text output of a command without binary handler */
+  TELNET_RECORD_TEXT    = 6,
+};
+
+enum {
+  /* length of the header of a typed output entry */
+  TELNET_RECORD_HEADER_SIZE = 4,
+
+  /* maximum length of the value of a typed output entry */
+  TELNET_RECORD_MAX_VALUE = 65535,
+};
+
+#endif /* OONF_TELNET_PROTO_H_ */
@@ -65,5 +65,6 @@ EXPORT extern struct oonf_subsystem oonf_os_clock_subsystem;
 
 /* prototypes for all os_system functions */
 EXPORT int os_clock_gettime64(uint64_t *t64);
+EXPORT int os_clock_gettime64_usec(uint64_t *t64);
 
 #endif /* OS_CLOCK_H_ */
@@ -121,3 +121,35 @@ os_clock_gettime64(uint64_t *t64) {
   *t64 = 1000ull * tv.tv_sec + tv.tv_usec/ 1000;
   return 0;
 }
+
+/**
+ * Reads the current time as a monotonic timestamp with
+ * microsecond resolution, useful to measure the runtime
+ * of short operations.
+ * @param t64 pointer to timestamp
+ * @return 0 if valid timestamp was read, negative otherwise
+ */
+int
+os_clock_gettime64_usec(uint64_t *t64) {
+  struct timeval tv;
+  int error;
+
+#if defined(CLOCK_MONOTONIC_RAW) || defined (CLOCK_MONOTONIC)
+  if (_clock_source) {
+    struct timespec ts;
+
+    if ((error = clock_gettime(_clock_source, &ts)) != 0) {
+      return error;
+    }
+
+    *t64 = 1000000ull * ts.tv_sec + ts.tv_nsec / 1000;
+    return 0;
+  }
+#endif
+  if ((error = gettimeofday(&tv, NULL)) != 0) {
+    return error;
+  }
+
+  *t64 = 1000000ull * tv.tv_sec + tv.tv_usec;
+  return 0;
+}
@@ -45,8 +45,14 @@
 /* and now the rest of the includes */
 #include <linux/netlink.h>
 #include <linux/rtnetlink.h>
+#include <errno.h>
+#include <stdlib.h>
 
 #include "common/common_types.h"
+#include "common/avl.h"
+#include "common/avl_comp.h"
+#include "common/container_of.h"
+#include "common/hash_table.h"
 #include "core/oonf_subsystem.h"
 #include "subsystems/os_routing.h"
 #include "subsystems/os_system.h"
@@ -55,15 +61,39 @@
 static int _init(void);
 static void _cleanup(void);
 
+static int _create_route_msg(struct nlmsghdr *msg, struct os_route *route,
+    bool set, bool del_similar);
 static int _routing_set(struct nlmsghdr *msg, struct os_route *route,
     unsigned char rt_type, unsigned char rt_scope);
 
 static void _routing_finished(struct os_route *route, int error);
+static int _feedback_add(struct os_route *route, uint32_t seq);
+static struct os_route *_feedback_get(uint32_t seq);
+static bool _batch_feedback(uint32_t seq, int error);
+static void _batch_interrupt(struct os_route_batch *batch);
+static void _batch_finished(struct os_route_batch *batch);
 static void _cb_rtnetlink_message(struct nlmsghdr *);
 static void _cb_rtnetlink_error(uint32_t seq, int error);
 static void _cb_rtnetlink_done(uint32_t seq);
 static void _cb_rtnetlink_timeout(void);
 
+static int _routing_parse_nlmsg(struct os_route *route, struct nlmsghdr *msg);
+static int _avl_comp_mirror_route(const void *k1, const void *k2);
+static int _get_route_metric(const struct os_route *route);
+static bool _is_route_unchanged(struct os_route *current, struct os_route *desired);
+static bool _match_mirror(struct os_route_mirror *mirror, struct os_route *route);
+static void _mirror_update(struct os_route_mirror *mirror,
+    struct os_route *route, bool add);
+static void _mirror_clear(struct os_route_mirror *mirror);
+static void _mirror_requeue_dump(uint32_t seq);
+static void _mirror_send_dump(void);
+static void _cb_mirror_sync_finished(struct os_route_batch *, size_t error_count);
+static void _cb_mirror_message(struct nlmsghdr *);
+static void _cb_mirror_error(uint32_t seq, int error);
+static void _cb_mirror_done(uint32_t seq);
+static void _cb_mirror_timeout(void);
+static void _cb_mirror_overflow(void);
+
 /* netlink socket for route set/get commands */
 struct os_system_netlink _rtnetlink_socket = {
   .cb_message = _cb_rtnetlink_message,
@@ -71,7 +101,43 @@ struct os_system_netlink _rtnetlink_socket = {
   .cb_done = _cb_rtnetlink_done,
   .cb_timeout = _cb_rtnetlink_timeout,
 };
-struct list_entity _rtnetlink_feedback;
+/*
+ * routes waiting for netlink feedback, key is the netlink sequence
+ * number. The table grows with the outstanding requests and releases
+ * its memory when the last one has been answered.
+ */
+static struct hash_table _rtnetlink_feedback;
+
+/* number of route requests (including batched routes) without feedback */
+static size_t _outstanding_requests;
+
+/* list of committed route batches waiting for feedback */
+static struct list_entity _rtnetlink_batches;
+
+/*
+ * netlink socket for route mirrors, used for the route dumps and
+ * the routing multicast events so both arrive in kernel order
+ */
+static struct os_system_netlink _rtnetlink_mirror_socket = {
+  .cb_message = _cb_mirror_message,
+  .cb_error = _cb_mirror_error,
+  .cb_done = _cb_mirror_done,
+  .cb_timeout = _cb_mirror_timeout,
+  .cb_overflow = _cb_mirror_overflow,
+};
+
+static const uint32_t _rtnetlink_mirror_mcast[] = {
+  RTNLGRP_IPV4_ROUTE, RTNLGRP_IPV6_ROUTE
+};
+
+/* list of active route mirrors */
+static struct list_entity _route_mirrors;
+
+/*
+ * sequence number of the running route dump, 0 if none. The kernel
+ * only allows one dump per socket, so the mirrors dump one by one.
+ */
+static uint32_t _mirror_dump_seq;
 
 /* subsystem definition */
 struct oonf_subsystem oonf_os_routing_subsystem = {
@@ -101,7 +167,9 @@ _init(void) {
   if (os_system_netlink_add(&_rtnetlink_socket, NETLINK_ROUTE)) {
     return -1;
   }
-  list_init_head(&_rtnetlink_feedback);
+  hash_table_init(&_rtnetlink_feedback, hash_table_hash_uint32, avl_comp_uint32);
+  list_init_head(&_rtnetlink_batches);
+  list_init_head(&_route_mirrors);
   return 0;
 }
 
@@ -111,10 +179,20 @@ _init(void) {
 static void
 _cleanup(void) {
   struct os_route *rt, *rt_it;
+  struct os_route_batch *batch, *batch_it;
+  struct os_route_mirror *mirror, *mirror_it;
 
-  list_for_each_element_safe(&_rtnetlink_feedback, rt, _internal._node, rt_it) {
+  list_for_each_element_safe(&_route_mirrors, mirror, _internal._node, mirror_it) {
+    os_routing_mirror_remove(mirror);
+  }
+
+  hash_table_for_each_element_safe(&_rtnetlink_feedback, rt, _internal._node, rt_it) {
     _routing_finished(rt, 1);
   }
+  hash_table_free(&_rtnetlink_feedback);
+  list_for_each_element_safe(&_rtnetlink_batches, batch, _internal._node, batch_it) {
+    _batch_interrupt(batch);
+  }
 
   os_system_netlink_remove(&_rtnetlink_socket);
 }
@@ -133,70 +211,316 @@ int
 os_routing_set(struct os_route *route, bool set, bool del_similar) {
   uint8_t buffer[UIO_MAXIOV];
   struct nlmsghdr *msg;
-  unsigned char scope;
-  struct os_route os_rt;
   int seq;
-#ifdef OONF_LOG_DEBUG_INFO
-  struct os_route_str rbuf;
-#endif
 
   memset(buffer, 0, sizeof(buffer));
 
-  /* copy route settings */
-  memcpy(&os_rt, route, sizeof(os_rt));
-
   /* get pointers for netlink message */
   msg = (void *)&buffer[0];
 
-  msg->nlmsg_flags = NLM_F_REQUEST;
+  if (_create_route_msg(msg, route, set, del_similar)) {
+    return -1;
+  }
 
-  /* set length of netlink message with rtmsg payload */
-  msg->nlmsg_len = NLMSG_LENGTH(sizeof(struct rtmsg));
+  /* the kernel will process the request once it is sent */
+  if (route->cb_finished && hash_table_reserve(&_rtnetlink_feedback)) {
+    OONF_WARN(LOG_OS_ROUTING, "Cannot track feedback for route request");
+    return -1;
+  }
 
-  /* normally all routing operations are UNIVERSE scope */
-  scope = RT_SCOPE_UNIVERSE;
+  /* cannot fail */
+  seq = os_system_netlink_send(&_rtnetlink_socket, msg);
 
-  if (set) {
-    msg->nlmsg_flags |= NLM_F_CREATE | NLM_F_REPLACE;
-    msg->nlmsg_type = RTM_NEWROUTE;
-  } else {
-    msg->nlmsg_type = RTM_DELROUTE;
+  if (route->cb_finished) {
+    return _feedback_add(route, seq);
+  }
+  return 0;
+}
 
-    os_rt.protocol = 0;
-    netaddr_invalidate(&os_rt.src);
+/**
+ * Start a new batch of route changes
+ * @param batch pointer to batch, cb_finished must be set
+ * @return -1 if an error happened, 0 otherwise
+ */
+int
+os_routing_batch_begin(struct os_route_batch *batch) {
+  batch->routes = NULL;
+  batch->route_count = 0;
+  batch->error_count = 0;
 
-    if (del_similar) {
-      /* no interface necessary */
-      os_rt.if_index = 0;
+  memset(&batch->_internal, 0, sizeof(batch->_internal));
+  return abuf_init(&batch->_internal._messages);
+}
 
-      /* as wildcard for fuzzy deletion */
-      scope = RT_SCOPE_NOWHERE;
+/**
+ * Add a route change to a batch. The change will not be sent to the
+ * kernel before the batch is committed.
+ * @param batch pointer to batch
+ * @param route data of route to be set/removed, must stay valid until
+ *   the batch is finished
+ * @param set true if route should be set, false if it should be removed
+ * @param del_similar true if similar routes that block this one should be
+ *   removed.
+ * @return -1 if an error happened, 0 otherwise
+ */
+int
+os_routing_batch_add(struct os_route_batch *batch,
+    struct os_route *route, bool set, bool del_similar) {
+  uint8_t buffer[UIO_MAXIOV];
+  struct nlmsghdr *msg;
+  struct os_route **routes;
+  size_t size;
+
+  if (batch->route_count == batch->_internal._routes_size) {
+    size = batch->_internal._routes_size == 0 ? 16 : batch->_internal._routes_size * 2;
+
+    routes = realloc(batch->routes, size * sizeof(*routes));
+    if (routes == NULL) {
+      OONF_WARN(LOG_OS_ROUTING, "Not enough memory for route batch");
+      return -1;
     }
+    batch->routes = routes;
+    batch->_internal._routes_size = size;
   }
 
-  if (netaddr_get_address_family(&os_rt.gw) == AF_UNSPEC
-      && netaddr_get_prefix_length(&os_rt.dst) == netaddr_get_maxprefix(&os_rt.dst)) {
-    /* use destination as gateway, to 'force' linux kernel to do proper source address selection */
-    os_rt.gw = os_rt.dst;
-  }
+  memset(buffer, 0, sizeof(buffer));
+  msg = (void *)&buffer[0];
 
-  OONF_DEBUG(LOG_OS_ROUTING, "%sset route: %s", set ? "" : "re",
-      os_routing_to_string(&rbuf, &os_rt));
+  if (_create_route_msg(msg, route, set, del_similar)) {
+    return -1;
+  }
 
-  if (_routing_set(msg, &os_rt, RTN_UNICAST, scope)) {
+  /* keep messages aligned, the buffer has to be parsed again by commit */
+  if (abuf_memcpy(&batch->_internal._messages, msg, NLMSG_ALIGN(msg->nlmsg_len))) {
+    OONF_WARN(LOG_OS_ROUTING, "Not enough memory for route batch");
     return -1;
   }
 
-  /* cannot fail */
-  seq = os_system_netlink_send(&_rtnetlink_socket, msg);
+  route->batch_result = EINPROGRESS;
+  batch->routes[batch->route_count++] = route;
+  return 0;
+}
 
-  if (route->cb_finished) {
-    list_add_tail(&_rtnetlink_feedback, &route->_internal._node);
-    route->_internal.nl_seq = seq;
+/**
+ * Send all route changes of a batch to the kernel. The changes will
+ * get consecutive netlink sequence numbers, so the feedback can
+ * be mapped to the routes directly.
+ * @param batch pointer to batch
+ * @return -1 if an error happened, 0 otherwise
+ */
+int
+os_routing_batch_commit(struct os_route_batch *batch) {
+  struct nlmsghdr *msg;
+  size_t offset;
+  int seq;
+
+  if (batch->route_count == 0) {
+    _batch_finished(batch);
+    return 0;
+  }
+
+  for (offset = 0; offset < abuf_getlen(&batch->_internal._messages);
+      offset += NLMSG_ALIGN(msg->nlmsg_len)) {
+    msg = (void *)(abuf_getptr(&batch->_internal._messages) + offset);
+
+    /* cannot fail */
+    seq = os_system_netlink_send(&_rtnetlink_socket, msg);
+    if (offset == 0) {
+      batch->_internal.nl_seq = seq;
+    }
+  }
+
+  OONF_DEBUG(LOG_OS_ROUTING, "Committed batch of %"PRINTF_SIZE_T_SPECIFIER
+      " routes (%"PRINTF_SIZE_T_SPECIFIER" bytes)",
+      batch->route_count, abuf_getlen(&batch->_internal._messages));
+
+  abuf_free(&batch->_internal._messages);
+
+  batch->_internal._pending = batch->route_count;
+  _outstanding_requests += batch->route_count;
+  list_add_tail(&_rtnetlink_batches, &batch->_internal._node);
+  return 0;
+}
+
+/**
+ * Stop processing of a route batch. All routes without feedback
+ * will be marked with an error and the callback of the batch will
+ * be called.
+ * @param batch pointer to batch
+ */
+void
+os_routing_batch_interrupt(struct os_route_batch *batch) {
+  _batch_interrupt(batch);
+}
+
+/**
+ * Start mirroring the kernel routes of a routing table and protocol.
+ * The mirror will request a dump of the kernel routes and keeps
+ * its tree up to date with the routing events of the kernel.
+ * @param mirror pointer to initialized route mirror
+ * @return -1 if an error happened, 0 otherwise
+ */
+int
+os_routing_mirror_add(struct os_route_mirror *mirror) {
+  if (list_is_empty(&_route_mirrors)) {
+    if (os_system_netlink_add(&_rtnetlink_mirror_socket, NETLINK_ROUTE)) {
+      return -1;
+    }
+    if (os_system_netlink_add_mc(&_rtnetlink_mirror_socket,
+        _rtnetlink_mirror_mcast, ARRAYSIZE(_rtnetlink_mirror_mcast))) {
+      os_system_netlink_remove(&_rtnetlink_mirror_socket);
+      return -1;
+    }
   }
+
+  avl_init(&mirror->routes, _avl_comp_mirror_route, false);
+  mirror->initialized = false;
+  mirror->_sync_running = false;
+  mirror->_removed_routes = NULL;
+  mirror->_internal.nl_seq = 0;
+  mirror->_internal.dump_pending = true;
+  list_add_tail(&_route_mirrors, &mirror->_internal._node);
+
+  /* request a dump of the routes of the mirror */
+  _mirror_send_dump();
   return 0;
 }
 
+/**
+ * Stop mirroring the kernel routes. A running sync will be
+ * interrupted.
+ * @param mirror pointer to route mirror
+ */
+void
+os_routing_mirror_remove(struct os_route_mirror *mirror) {
+  if (!list_is_node_added(&mirror->_internal._node)) {
+    return;
+  }
+
+  if (mirror->_sync_running) {
+    os_routing_batch_interrupt(&mirror->_batch);
+  }
+
+  _mirror_clear(mirror);
+  list_remove(&mirror->_internal._node);
+
+  if (list_is_empty(&_route_mirrors)) {
+    os_system_netlink_remove(&_rtnetlink_mirror_socket);
+    _mirror_dump_seq = 0;
+  }
+}
+
+/**
+ * Bring the kernel routes of a mirror into the desired state. Only
+ * routes that are missing or different in the kernel will be set,
+ * mirrored routes that are not part of the desired set will be removed.
+ * All changes are sent to the kernel as one batch, the mirror itself
+ * is updated by the routing events of the kernel.
+ * @param mirror pointer to initialized route mirror
+ * @param desired array of pointers to routes, they must stay
+ *   valid until the cb_sync_finished callback has been called.
+ *   Unspecified tables and protocols are set to the ones of the mirror.
+ * @param count number of routes in desired array
+ * @return -1 if an error happened, 0 otherwise
+ */
+int
+os_routing_mirror_sync(struct os_route_mirror *mirror,
+    struct os_route **desired, size_t count) {
+  struct os_route_mirror_entry *entry;
+  struct os_route *route;
+  size_t removed, i;
+
+  if (!mirror->initialized || mirror->_sync_running) {
+    return -1;
+  }
+
+  mirror->sync_set = 0;
+  mirror->sync_removed = 0;
+  mirror->sync_unchanged = 0;
+
+  mirror->_batch.cb_finished = _cb_mirror_sync_finished;
+  if (os_routing_batch_begin(&mirror->_batch)) {
+    return -1;
+  }
+  mirror->_sync_running = true;
+
+  avl_for_each_element(&mirror->routes, entry, _node) {
+    entry->_desired = false;
+  }
+
+  for (i=0; i<count; i++) {
+    route = desired[i];
+
+    if (route->table == RT_TABLE_UNSPEC) {
+      route->table = mirror->table;
+    }
+    if (route->protocol == RTPROT_UNSPEC) {
+      route->protocol = mirror->protocol;
+    }
+
+    entry = avl_find_element(&mirror->routes, route, entry, _node);
+    if (entry) {
+      entry->_desired = true;
+
+      if (_is_route_unchanged(&entry->route, route)) {
+        mirror->sync_unchanged++;
+        continue;
+      }
+    }
+
+    if (os_routing_batch_add(&mirror->_batch, route, true, false)) {
+      goto mirror_sync_fail;
+    }
+    mirror->sync_set++;
+  }
+
+  /* copy the routes to remove, the mirror entries vanish with the kernel events */
+  removed = 0;
+  avl_for_each_element(&mirror->routes, entry, _node) {
+    if (!entry->_desired) {
+      removed++;
+    }
+  }
+
+  if (removed > 0) {
+    mirror->_removed_routes = calloc(removed, sizeof(struct os_route));
+    if (mirror->_removed_routes == NULL) {
+      OONF_WARN(LOG_OS_ROUTING, "Not enough memory for route mirror sync");
+      goto mirror_sync_fail;
+    }
+
+    avl_for_each_element(&mirror->routes, entry, _node) {
+      if (entry->_desired) {
+        continue;
+      }
+
+      route = &mirror->_removed_routes[mirror->sync_removed++];
+      memcpy(route, &entry->route, sizeof(*route));
+
+      if (os_routing_batch_add(&mirror->_batch, route, false, false)) {
+        goto mirror_sync_fail;
+      }
+    }
+  }
+
+  OONF_DEBUG(LOG_OS_ROUTING, "Sync route mirror (table %u, protocol %u):"
+      " %"PRINTF_SIZE_T_SPECIFIER" set, %"PRINTF_SIZE_T_SPECIFIER" removed,"
+      " %"PRINTF_SIZE_T_SPECIFIER" unchanged", mirror->table, mirror->protocol,
+      mirror->sync_set, mirror->sync_removed, mirror->sync_unchanged);
+
+  return os_routing_batch_commit(&mirror->_batch);
+
+mirror_sync_fail:
+  /* nothing has been sent, drop the batch without callback */
+  mirror->_batch.cb_finished = NULL;
+  os_routing_batch_interrupt(&mirror->_batch);
+
+  free(mirror->_removed_routes);
+  mirror->_removed_routes = NULL;
+  mirror->_sync_running = false;
+  return -1;
+}
+
 /**
  * Request all routing dataof a certain address family
  * @param route pointer to routing filter
@@ -224,14 +548,18 @@ os_routing_query(struct os_route *route) {
   msg->nlmsg_type = RTM_GETROUTE;
   rt_gen->rtgen_family = route->family;
 
+  /* the kernel will process the request once it is sent */
+  if (hash_table_reserve(&_rtnetlink_feedback)) {
+    OONF_WARN(LOG_OS_ROUTING, "Cannot track feedback for route query");
+    return -1;
+  }
+
   seq = os_system_netlink_send(&_rtnetlink_socket, msg);
   if (seq < 0) {
     return -1;
   }
 
-  list_add_tail(&_rtnetlink_feedback, &route->_internal._node);
-  route->_internal.nl_seq = seq;
-  return 0;
+  return _feedback_add(route, seq);
 }
 
 /**
@@ -243,6 +571,15 @@ os_routing_interrupt(struct os_route *route) {
   _routing_finished(route, -1);
 }
 
+/**
+ * @return number of route requests (including routes of committed
+ *   batches) that are still waiting for kernel feedback
+ */
+size_t
+os_routing_get_outstanding_requests(void) {
+  return _outstanding_requests;
+}
+
 /**
  * Stop processing of a routing command and set error code
  * for callback
@@ -251,9 +588,10 @@ os_routing_interrupt(struct os_route *route) {
  */
 static void
 _routing_finished(struct os_route *route, int error) {
-  if (list_is_node_added(&route->_internal._node)) {
+  if (hash_table_is_node_added(&route->_internal._node)) {
     /* remove first to prevent any kind of recursive cleanup */
-    list_remove(&route->_internal._node);
+    hash_table_remove(&_rtnetlink_feedback, &route->_internal._node);
+    _outstanding_requests--;
 
     if (route->cb_finished) {
       route->cb_finished(route, error);
@@ -261,6 +599,174 @@ _routing_finished(struct os_route *route, int error) {
   }
 }
 
+/**
+ * Add a route to the hash of requests waiting for netlink feedback.
+ * The hash table must have been reserved before the request was sent.
+ * @param route pointer to route
+ * @param seq netlink sequence number of the request
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_feedback_add(struct os_route *route, uint32_t seq) {
+  route->_internal.nl_seq = seq;
+  route->_internal._node.key = &route->_internal.nl_seq;
+  if (hash_table_insert(&_rtnetlink_feedback, &route->_internal._node)) {
+    OONF_WARN(LOG_OS_ROUTING, "Cannot track feedback for netlink request %u", seq);
+    return -1;
+  }
+  _outstanding_requests++;
+  return 0;
+}
+
+/**
+ * Lookup a route waiting for netlink feedback
+ * @param seq netlink sequence number
+ * @return pointer to route, NULL if not found
+ */
+static struct os_route *
+_feedback_get(uint32_t seq) {
+  struct os_route *route;
+
+  return hash_table_find_element(&_rtnetlink_feedback, &seq, route, _internal._node);
+}
+
+/**
+ * Map netlink feedback to a route of a committed batch
+ * @param seq sequence number of feedback
+ * @param error error code, 0 if no error
+ * @return true if the feedback belonged to a batch, false otherwise
+ */
+static bool
+_batch_feedback(uint32_t seq, int error) {
+  struct os_route_batch *batch;
+  struct os_route *route;
+  size_t idx;
+
+  list_for_each_element(&_rtnetlink_batches, batch, _internal._node) {
+    idx = (seq - batch->_internal.nl_seq) & INT32_MAX;
+    if (idx >= batch->route_count) {
+      continue;
+    }
+
+    route = batch->routes[idx];
+    if (route->batch_result == EINPROGRESS) {
+      _outstanding_requests--;
+      route->batch_result = error;
+      if (error) {
+        batch->error_count++;
+      }
+      if (--batch->_internal._pending == 0) {
+        _batch_finished(batch);
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+/**
+ * Mark all routes of a batch without feedback as failed and
+ * finish the batch
+ * @param batch pointer to batch
+ */
+static void
+_batch_interrupt(struct os_route_batch *batch) {
+  size_t i;
+
+  for (i=0; i<batch->route_count; i++) {
+    if (batch->routes[i]->batch_result == EINPROGRESS) {
+      batch->routes[i]->batch_result = -1;
+      batch->error_count++;
+    }
+  }
+  if (list_is_node_added(&batch->_internal._node)) {
+    _outstanding_requests -= batch->_internal._pending;
+  }
+  _batch_finished(batch);
+}
+
+/**
+ * Remove a batch from the feedback list, call its callback
+ * and free the allocated memory
+ * @param batch pointer to batch
+ */
+static void
+_batch_finished(struct os_route_batch *batch) {
+  struct os_route **routes;
+
+  if (list_is_node_added(&batch->_internal._node)) {
+    list_remove(&batch->_internal._node);
+  }
+  abuf_free(&batch->_internal._messages);
+
+  /* the callback might reuse the batch, so remember the array */
+  routes = batch->routes;
+
+  if (batch->cb_finished) {
+    batch->cb_finished(batch, batch->error_count);
+  }
+  free(routes);
+}
+
+/**
+ * Create a netlink message to set or remove a route
+ * @param msg pointer to zeroed netlink message buffer
+ * @param route data of route to be set/removed
+ * @param set true if route should be set, false if it should be removed
+ * @param del_similar true if similar routes that block this one should be
+ *   removed.
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_create_route_msg(struct nlmsghdr *msg, struct os_route *route,
+    bool set, bool del_similar) {
+  unsigned char scope;
+  struct os_route os_rt;
+#ifdef OONF_LOG_DEBUG_INFO
+  struct os_route_str rbuf;
+#endif
+
+  /* copy route settings */
+  memcpy(&os_rt, route, sizeof(os_rt));
+
+  msg->nlmsg_flags = NLM_F_REQUEST;
+
+  /* set length of netlink message with rtmsg payload */
+  msg->nlmsg_len = NLMSG_LENGTH(sizeof(struct rtmsg));
+
+  /* normally all routing operations are UNIVERSE scope */
+  scope = RT_SCOPE_UNIVERSE;
+
+  if (set) {
+    msg->nlmsg_flags |= NLM_F_CREATE | NLM_F_REPLACE;
+    msg->nlmsg_type = RTM_NEWROUTE;
+  } else {
+    msg->nlmsg_type = RTM_DELROUTE;
+
+    os_rt.protocol = 0;
+    netaddr_invalidate(&os_rt.src);
+
+    if (del_similar) {
+      /* no interface necessary */
+      os_rt.if_index = 0;
+
+      /* as wildcard for fuzzy deletion */
+      scope = RT_SCOPE_NOWHERE;
+    }
+  }
+
+  if (netaddr_get_address_family(&os_rt.gw) == AF_UNSPEC
+      && netaddr_get_prefix_length(&os_rt.dst) == netaddr_get_maxprefix(&os_rt.dst)) {
+    /* use destination as gateway, to 'force' linux kernel to do proper source address selection */
+    os_rt.gw = os_rt.dst;
+  }
+
+  OONF_DEBUG(LOG_OS_ROUTING, "%sset route: %s", set ? "" : "re",
+      os_routing_to_string(&rbuf, &os_rt));
+
+  return _routing_set(msg, &os_rt, RTN_UNICAST, scope);
+}
+
 /**
  * Initiatize the an netlink routing message
  * @param msg pointer to netlink message header
@@ -381,6 +887,12 @@ _routing_parse_nlmsg(struct os_route *route, struct nlmsghdr *msg) {
         netaddr_from_binary_prefix(&route->src, RTA_DATA(rt_attr), RTA_PAYLOAD(rt_attr),
             rt_msg->rtm_family, rt_msg->rtm_src_len);
         break;
+      case RTA_PREFSRC:
+        if (netaddr_get_address_family(&route->src) == AF_UNSPEC) {
+          netaddr_from_binary(&route->src, RTA_DATA(rt_attr), RTA_PAYLOAD(rt_attr),
+              rt_msg->rtm_family);
+        }
+        break;
       case RTA_GATEWAY:
         netaddr_from_binary(&route->gw, RTA_DATA(rt_attr), RTA_PAYLOAD(rt_attr), rt_msg->rtm_family);
         break;
@@ -462,14 +974,9 @@ _cb_rtnetlink_message(struct nlmsghdr *msg) {
     return;
   }
 
-  list_for_each_element(&_rtnetlink_feedback, filter, _internal._node) {
-    OONF_DEBUG_NH(LOG_OS_ROUTING, "  Compare with seq: %d", filter->_internal.nl_seq);
-    if (msg->nlmsg_seq == filter->_internal.nl_seq) {
-      if (filter->cb_get != NULL && _match_routes(filter, &rt)) {
-        filter->cb_get(filter, &rt);
-      }
-      break;
-    }
+  filter = _feedback_get(msg->nlmsg_seq);
+  if (filter != NULL && filter->cb_get != NULL && _match_routes(filter, &rt)) {
+    filter->cb_get(filter, &rt);
   }
 }
 
@@ -487,11 +994,13 @@ _cb_rtnetlink_error(uint32_t seq, int error) {
   /* transform into errno number */
   error = -error;
 
-  list_for_each_element(&_rtnetlink_feedback, route, _internal._node) {
-    if (seq == route->_internal.nl_seq) {
-      _routing_finished(route, error);
-      break;
-    }
+  if (_batch_feedback(seq, error)) {
+    return;
+  }
+
+  route = _feedback_get(seq);
+  if (route) {
+    _routing_finished(route, error);
   }
 }
 
@@ -501,10 +1010,15 @@ _cb_rtnetlink_error(uint32_t seq, int error) {
 static void
 _cb_rtnetlink_timeout(void) {
   struct os_route *route, *rt_it;
+  struct os_route_batch *batch, *batch_it;
 
   OONF_DEBUG(LOG_OS_ROUTING, "Got timeout");
 
-  list_for_each_element_safe(&_rtnetlink_feedback, route, _internal._node, rt_it) {
+  list_for_each_element_safe(&_rtnetlink_batches, batch, _internal._node, batch_it) {
+    _batch_interrupt(batch);
+  }
+
+  hash_table_for_each_element_safe(&_rtnetlink_feedback, route, _internal._node, rt_it) {
     _routing_finished(route, -1);
   }
 }
@@ -519,10 +1033,338 @@ _cb_rtnetlink_done(uint32_t seq) {
 
   OONF_DEBUG(LOG_OS_ROUTING, "Got done: %u", seq);
 
-  list_for_each_element(&_rtnetlink_feedback, route, _internal._node) {
-    if (seq == route->_internal.nl_seq) {
-      _routing_finished(route, 0);
+  route = _feedback_get(seq);
+  if (route) {
+    _routing_finished(route, 0);
+  }
+}
+
+/**
+ * AVL comparator for mirrored routes, the kernel identifies
+ * routes of a table by their destination and metric.
+ * @param k1 pointer to first route
+ * @param k2 pointer to second route
+ * @return >0 if k1>k2, <0 if k1<k2, 0 otherwise
+ */
+static int
+_avl_comp_mirror_route(const void *k1, const void *k2) {
+  const struct os_route *rt1 = k1;
+  const struct os_route *rt2 = k2;
+  int result, metric1, metric2;
+
+  result = netaddr_cmp(&rt1->dst, &rt2->dst);
+  if (result) {
+    return result;
+  }
+
+  metric1 = _get_route_metric(rt1);
+  metric2 = _get_route_metric(rt2);
+  if (metric1 > metric2) {
+    return 1;
+  }
+  if (metric1 < metric2) {
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * @param route pointer to route
+ * @return metric the kernel uses for the route
+ */
+static int
+_get_route_metric(const struct os_route *route) {
+  if (route->metric != -1) {
+    return route->metric;
+  }
+  return netaddr_get_address_family(&route->dst) == AF_INET6 ? 1024 : 0;
+}
+
+/**
+ * Check if a kernel route already has the desired settings
+ * @param current pointer to kernel route
+ * @param desired pointer to desired route with the same key
+ * @return true if the kernel route does not need to be set
+ */
+static bool
+_is_route_unchanged(struct os_route *current, struct os_route *desired) {
+  const struct netaddr *gw;
+
+  /* host routes without gateway are set with the destination as gateway */
+  gw = &desired->gw;
+  if (netaddr_get_address_family(gw) == AF_UNSPEC
+      && netaddr_get_prefix_length(&desired->dst) == netaddr_get_maxprefix(&desired->dst)) {
+    gw = &desired->dst;
+  }
+
+  if (netaddr_get_address_family(gw) != AF_UNSPEC
+      && netaddr_cmp(gw, &current->gw) != 0) {
+    return false;
+  }
+  if (netaddr_get_address_family(&desired->src) != AF_UNSPEC
+      && netaddr_cmp(&desired->src, &current->src) != 0) {
+    return false;
+  }
+  return desired->if_index == 0 || desired->if_index == current->if_index;
+}
+
+/**
+ * Check if a kernel route belongs to a route mirror
+ * @param mirror pointer to route mirror
+ * @param route pointer to kernel route
+ * @return true if route belongs to the mirror
+ */
+static bool
+_match_mirror(struct os_route_mirror *mirror, struct os_route *route) {
+  if (mirror->family != AF_UNSPEC && mirror->family != route->family) {
+    return false;
+  }
+  if (mirror->table != route->table) {
+    return false;
+  }
+  return mirror->protocol == RTPROT_UNSPEC || mirror->protocol == route->protocol;
+}
+
+/**
+ * Add, update or remove a route of a mirror
+ * @param mirror pointer to route mirror
+ * @param route pointer to kernel route
+ * @param add true if route has been added or changed, false if removed
+ */
+static void
+_mirror_update(struct os_route_mirror *mirror, struct os_route *route, bool add) {
+  struct os_route_mirror_entry *entry;
+
+  entry = avl_find_element(&mirror->routes, route, entry, _node);
+  if (!add) {
+    if (entry) {
+      avl_remove(&mirror->routes, &entry->_node);
+      free(entry);
+    }
+    return;
+  }
+
+  if (entry == NULL) {
+    entry = calloc(1, sizeof(*entry));
+    if (entry == NULL) {
+      OONF_WARN(LOG_OS_ROUTING, "Not enough memory for mirrored route");
+      return;
+    }
+
+    entry->_node.key = &entry->route;
+    memcpy(&entry->route, route, sizeof(*route));
+    avl_insert(&mirror->routes, &entry->_node);
+  }
+  else {
+    memcpy(&entry->route, route, sizeof(*route));
+  }
+}
+
+/**
+ * Remove all routes of a mirror
+ * @param mirror pointer to route mirror
+ */
+static void
+_mirror_clear(struct os_route_mirror *mirror) {
+  struct os_route_mirror_entry *entry, *entry_it;
+
+  avl_for_each_element_safe(&mirror->routes, entry, _node, entry_it) {
+    avl_remove(&mirror->routes, &entry->_node);
+    free(entry);
+  }
+}
+
+/**
+ * Put all mirrors waiting for a route dump back into the queue
+ * @param seq sequence number of the dump, 0 for all mirrors
+ */
+static void
+_mirror_requeue_dump(uint32_t seq) {
+  struct os_route_mirror *mirror;
+
+  list_for_each_element(&_route_mirrors, mirror, _internal._node) {
+    if (seq == 0 || mirror->_internal.nl_seq == seq) {
+      mirror->_internal.nl_seq = 0;
+      mirror->_internal.dump_pending = true;
+    }
+  }
+}
+
+/**
+ * Request the next queued route dump if no dump is running. All
+ * queued mirrors of the same address family share the dump.
+ */
+static void
+_mirror_send_dump(void) {
+  uint8_t buffer[UIO_MAXIOV];
+  struct os_route_mirror *mirror, *first;
+  struct nlmsghdr *msg;
+  struct rtgenmsg *rt_gen;
+
+  if (_mirror_dump_seq != 0) {
+    return;
+  }
+
+  first = NULL;
+  list_for_each_element(&_route_mirrors, mirror, _internal._node) {
+    if (mirror->_internal.dump_pending) {
+      first = mirror;
       break;
     }
   }
+  if (first == NULL) {
+    return;
+  }
+
+  memset(buffer, 0, sizeof(buffer));
+
+  msg = (void *)&buffer[0];
+  rt_gen = NLMSG_DATA(msg);
+
+  msg->nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  msg->nlmsg_len = NLMSG_LENGTH(sizeof(*rt_gen));
+  msg->nlmsg_type = RTM_GETROUTE;
+  rt_gen->rtgen_family = first->family;
+
+  _mirror_dump_seq = os_system_netlink_send(&_rtnetlink_mirror_socket, msg);
+
+  list_for_each_element(&_route_mirrors, mirror, _internal._node) {
+    if (mirror->_internal.dump_pending && mirror->family == first->family) {
+      mirror->_internal.dump_pending = false;
+      mirror->_internal.nl_seq = _mirror_dump_seq;
+    }
+  }
+}
+
+/**
+ * Callback when the route batch of a mirror sync is finished
+ * @param batch pointer to route batch
+ * @param error_count number of routes with an error
+ */
+static void
+_cb_mirror_sync_finished(struct os_route_batch *batch, size_t error_count) {
+  struct os_route_mirror *mirror;
+
+  mirror = container_of(batch, struct os_route_mirror, _batch);
+
+  free(mirror->_removed_routes);
+  mirror->_removed_routes = NULL;
+  mirror->_sync_running = false;
+
+  if (mirror->cb_sync_finished) {
+    mirror->cb_sync_finished(mirror, error_count);
+  }
+}
+
+/**
+ * Handle route dumps and routing events for the route mirrors
+ * @param msg pointer to netlink message
+ */
+static void
+_cb_mirror_message(struct nlmsghdr *msg) {
+  struct os_route_mirror *mirror;
+  struct os_route rt;
+
+  if (msg->nlmsg_type != RTM_NEWROUTE && msg->nlmsg_type != RTM_DELROUTE) {
+    return;
+  }
+
+  if (_routing_parse_nlmsg(&rt, msg)) {
+    /* not an IPv4 or IPv6 route */
+    return;
+  }
+
+  list_for_each_element(&_route_mirrors, mirror, _internal._node) {
+    if (_match_mirror(mirror, &rt)) {
+      _mirror_update(mirror, &rt, msg->nlmsg_type == RTM_NEWROUTE);
+    }
+  }
+}
+
+/**
+ * Handle errors of the route dumps of the route mirrors
+ * @param seq netlink sequence number
+ * @param error netlink error code
+ */
+static void
+_cb_mirror_error(uint32_t seq, int error) {
+  if (error == 0 || seq != _mirror_dump_seq) {
+    return;
+  }
+
+  OONF_WARN(LOG_OS_ROUTING, "Route mirror dump %u failed: %s (%d)",
+      seq, strerror(-error), -error);
+
+  /* try again */
+  _mirror_dump_seq = 0;
+  _mirror_requeue_dump(seq);
+  _mirror_send_dump();
+}
+
+/**
+ * Handle the end of the route dump of a route mirror
+ * @param seq netlink sequence number
+ */
+static void
+_cb_mirror_done(uint32_t seq) {
+  struct os_route_mirror *mirror, *mirror_it;
+
+  if (seq != _mirror_dump_seq) {
+    return;
+  }
+  _mirror_dump_seq = 0;
+
+  list_for_each_element_safe(&_route_mirrors, mirror, _internal._node, mirror_it) {
+    if (mirror->_internal.nl_seq == seq) {
+      mirror->_internal.nl_seq = 0;
+      mirror->initialized = true;
+
+      if (mirror->cb_initialized) {
+        mirror->cb_initialized(mirror);
+      }
+    }
+  }
+
+  _mirror_send_dump();
+}
+
+/**
+ * Handle timeout of the route dumps of the route mirrors
+ */
+static void
+_cb_mirror_timeout(void) {
+  uint32_t seq;
+
+  if (_mirror_dump_seq == 0) {
+    return;
+  }
+
+  OONF_WARN(LOG_OS_ROUTING, "Timeout of route mirror dump");
+
+  /* try again */
+  seq = _mirror_dump_seq;
+  _mirror_dump_seq = 0;
+  _mirror_requeue_dump(seq);
+  _mirror_send_dump();
+}
+
+/**
+ * Handle lost routing events of the route mirrors by dumping
+ * all mirrored routes again
+ */
+static void
+_cb_mirror_overflow(void) {
+  struct os_route_mirror *mirror;
+
+  OONF_WARN(LOG_OS_ROUTING, "Lost routing events, dumping mirrored routes again");
+
+  list_for_each_element(&_route_mirrors, mirror, _internal._node) {
+    _mirror_clear(mirror);
+    mirror->initialized = false;
+  }
+
+  /* a running dump might have lost messages too */
+  _mirror_dump_seq = 0;
+  _mirror_requeue_dump(0);
+  _mirror_send_dump();
 }
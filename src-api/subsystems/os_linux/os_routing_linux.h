@@ -43,11 +43,41 @@
 #define OS_ROUTING_LINUX_H_
 
 #include "common/common_types.h"
+#include "common/autobuf.h"
+#include "common/hash_table.h"
 #include "common/list.h"
 
 struct os_route_internal {
+  struct hash_node _node;
+
+  uint32_t nl_seq;
+};
+
+struct os_route_batch_internal {
+  /* node for list of committed batches */
   struct list_entity _node;
 
+  /* netlink messages of the batch, sent by commit */
+  struct autobuf _messages;
+
+  /* allocated length of the route array of the batch */
+  size_t _routes_size;
+
+  /* number of routes without feedback */
+  size_t _pending;
+
+  /* sequence number of the first message of the batch */
   uint32_t nl_seq;
 };
+
+struct os_route_mirror_internal {
+  /* node for list of route mirrors */
+  struct list_entity _node;
+
+  /* sequence number of the running route dump, 0 if none */
+  uint32_t nl_seq;
+
+  /* true if the mirror waits for its turn to dump the kernel routes */
+  bool dump_pending;
+};
 #endif /* OS_ROUTING_LINUX_H_ */
@@ -67,11 +67,26 @@
 
 #define OS_SYSTEM_NETLINK_TIMEOUT 100
 
+/*
+ * maximum number of bytes sent to the kernel with a single sendmsg()
+ * call, larger queues are split at message boundaries and sent with
+ * the next write events to give the kernel feedback a chance to be
+ * read in between.
+ */
+#define OS_SYSTEM_NETLINK_MAX_SEND 65536
+
+/*
+ * initial size of the netlink input buffer, large enough for
+ * the biggest datagrams of kernel dumps (32 kByte)
+ */
+#define OS_SYSTEM_NETLINK_RECV_BUFFER 65536
+
 /* prototypes */
 static int _init(void);
 static void _cleanup(void);
 
 static void _cb_handle_netlink_timeout(void *);
+static void _handle_netlink_messages(struct os_system_netlink *, size_t len);
 static void _netlink_handler(int fd, void *data,
     bool event_read, bool event_write);
 static void _cb_rtnetlink_message(struct nlmsghdr *hdr);
@@ -106,6 +121,9 @@ static struct nlmsghdr _netlink_hdr_done = {
   .nlmsg_type = NLMSG_DONE
 };
 
+/* zero bytes to align netlink messages in the output buffer */
+static const uint8_t _netlink_padding[NLMSG_ALIGNTO] = { 0 };
+
 static struct iovec _netlink_send_iov[2] = {
     { NULL, 0 },
     { &_netlink_hdr_done, sizeof(_netlink_hdr_done) },
@@ -269,12 +287,12 @@ os_system_netlink_add(struct os_system_netlink *nl, int protocol) {
     goto os_add_netlink_fail;
   }
 
-  nl->in = calloc(1, getpagesize());
+  nl->in = calloc(1, OS_SYSTEM_NETLINK_RECV_BUFFER);
   if (nl->in == NULL) {
     OONF_WARN(LOG_OS_SYSTEM, "Not enough memory for netlink input buffer");
     goto os_add_netlink_fail;
   }
-  nl->in_len = getpagesize();
+  nl->in_len = OS_SYSTEM_NETLINK_RECV_BUFFER;
 
   memset(&addr, 0, sizeof(addr));
   addr.nl_family = AF_NETLINK;
@@ -338,6 +356,12 @@ os_system_netlink_send(struct os_system_netlink *nl,
 
   abuf_memcpy(&nl->out, nl_hdr, nl_hdr->nlmsg_len);
 
+  /* the kernel expects multiple messages to be aligned */
+  if (NLMSG_ALIGN(nl_hdr->nlmsg_len) > nl_hdr->nlmsg_len) {
+    abuf_memcpy(&nl->out, _netlink_padding,
+        NLMSG_ALIGN(nl_hdr->nlmsg_len) - nl_hdr->nlmsg_len);
+  }
+
   /* trigger write */
   oonf_socket_set_write(&nl->socket, true);
   return _seq_used;
@@ -502,21 +526,42 @@ _cb_handle_netlink_timeout(void *ptr) {
 }
 
 /**
- * Send all netlink messages in the outgoing queue to the kernel
+ * Send netlink messages in the outgoing queue to the kernel. Sends
+ * up to OS_SYSTEM_NETLINK_MAX_SEND bytes of complete messages at once.
  * @param nl pointer to netlink handler
  */
 static void
 _flush_netlink_buffer(struct os_system_netlink *nl) {
+  struct nlmsghdr *nh;
+  size_t len, msg_len;
   ssize_t ret;
 
   /* start feedback timer */
   oonf_timer_set(&nl->timeout, OS_SYSTEM_NETLINK_TIMEOUT);
 
+  /* collect complete messages up to the maximum send size */
+  len = 0;
+  while (len < abuf_getlen(&nl->out)) {
+    nh = (struct nlmsghdr *)(abuf_getptr(&nl->out) + len);
+    msg_len = NLMSG_ALIGN(nh->nlmsg_len);
+
+    if (len > 0 && len + msg_len > OS_SYSTEM_NETLINK_MAX_SEND) {
+      break;
+    }
+    len += msg_len;
+  }
+  if (len > abuf_getlen(&nl->out)) {
+    len = abuf_getlen(&nl->out);
+  }
+
   /* send outgoing message */
   _netlink_send_iov[0].iov_base = abuf_getptr(&nl->out);
-  _netlink_send_iov[0].iov_len = abuf_getlen(&nl->out);
+  _netlink_send_iov[0].iov_len = len;
+
+  ret = sendmsg(nl->socket.fd, &_netlink_send_msg, 0);
+  nl->syscalls_send++;
 
-  if ((ret = sendmsg(nl->socket.fd, &_netlink_send_msg, 0)) <= 0) {
+  if (ret <= 0) {
     OONF_WARN(LOG_OS_SYSTEM,
         "Cannot send data to netlink socket (%d: %s)",
         errno, strerror(errno));
@@ -524,9 +569,12 @@ _flush_netlink_buffer(struct os_system_netlink *nl) {
   else {
     OONF_DEBUG(LOG_OS_SYSTEM, "Sent %zd/%zu bytes for netlink seqno: %d",
         ret, abuf_getlen(&nl->out), _seq_used);
-    abuf_clear(&nl->out);
+    abuf_pull(&nl->out, len);
+    nl->bytes_sent += ret;
 
-    oonf_socket_set_write(&nl->socket, false);
+    if (abuf_getlen(&nl->out) == 0) {
+      oonf_socket_set_write(&nl->socket, false);
+    }
 
     nl->msg_in_transit++;
   }
@@ -548,7 +596,8 @@ _netlink_job_finished(struct os_system_netlink *nl) {
 }
 
 /**
- * Handler for incoming netlink messages
+ * Handler for incoming netlink messages. Reads all datagrams that
+ * are waiting in the socket until it would block.
  * @param fd
  * @param data
  * @param event_read
@@ -557,10 +606,9 @@ _netlink_job_finished(struct os_system_netlink *nl) {
 static void
 _netlink_handler(int fd, void *data, bool event_read, bool event_write) {
   struct os_system_netlink *nl;
-  struct nlmsghdr *nh;
   ssize_t ret;
-  size_t len;
-  int flags;
+  void *ptr;
+  size_t size;
 
   nl = data;
   if (event_write) {
@@ -571,51 +619,97 @@ _netlink_handler(int fd, void *data, bool event_read, bool event_write) {
     return;
   }
 
-  /* handle incoming messages */
-  _netlink_rcv_msg.msg_flags = 0;
-  flags = MSG_PEEK;
+  while (true) {
+    _netlink_rcv_msg.msg_flags = 0;
+    _netlink_rcv_iov.iov_base = nl->in;
+    _netlink_rcv_iov.iov_len = nl->in_len;
+
+    /*
+     * peek first, MSG_TRUNC lets the kernel report the real length
+     * of the datagram while it stays in the queue
+     */
+    ret = recvmsg(fd, &_netlink_rcv_msg, MSG_DONTWAIT | MSG_PEEK | MSG_TRUNC);
+    nl->syscalls_recv++;
+
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == ENOBUFS) {
+        /* kernel dropped messages, the socket stays readable */
+        OONF_WARN(LOG_OS_SYSTEM, "Netlink receive buffer overflow");
+        if (nl->cb_overflow) {
+          nl->cb_overflow();
+        }
+        continue;
+      }
+      /* EWOULDBLOCK is the same value as EAGAIN on linux */
+      if (errno != EAGAIN) {
+        OONF_WARN(LOG_OS_SYSTEM,"netlink recvmsg error: %s (%d)\n",
+            strerror(errno), errno);
+      }
+      return;
+    }
+    if (ret == 0) {
+      return;
+    }
 
-netlink_rcv_retry:
-  _netlink_rcv_iov.iov_base = nl->in;
-  _netlink_rcv_iov.iov_len = nl->in_len;
+    /* not enough buffer space ? */
+    if ((_netlink_rcv_msg.msg_flags & MSG_TRUNC) != 0 || nl->in_len < (size_t)ret) {
+      OONF_DEBUG(LOG_OS_SYSTEM, "Netlink message of %"PRINTF_SSIZE_T_SPECIFIER
+          " bytes does not fit, increasing input buffer", ret);
+
+      size = nl->in_len;
+      while (size < (size_t)ret) {
+        size *= 2;
+      }
+      ptr = realloc(nl->in, size);
+      if (ptr) {
+        /* peek again with the larger buffer */
+        nl->in = ptr;
+        nl->in_len = size;
+        continue;
+      }
+
+      /* drop the datagram, otherwise the socket stays readable forever */
+      OONF_WARN(LOG_OS_SYSTEM, "Not enough memory to increase netlink input buffer");
+      _netlink_rcv_iov.iov_len = 0;
+      if (recvmsg(fd, &_netlink_rcv_msg, MSG_DONTWAIT) >= 0) {
+        nl->truncated++;
+      }
+      nl->syscalls_recv++;
+
+      if (nl->cb_overflow) {
+        nl->cb_overflow();
+      }
+      continue;
+    }
 
-  if ((ret = recvmsg(fd, &_netlink_rcv_msg, MSG_DONTWAIT | flags)) < 0) {
-    if (errno != EAGAIN) {
-      OONF_WARN(LOG_OS_SYSTEM,"netlink recvmsg error: %s (%d)\n",
-          strerror(errno), errno);
+    /* remove the datagram from the queue, it has been copied already */
+    _netlink_rcv_iov.iov_len = 0;
+    nl->syscalls_recv++;
+    if (recvmsg(fd, &_netlink_rcv_msg, MSG_DONTWAIT) < 0) {
+      /* the datagram is still in the queue, peek again */
+      continue;
     }
-    return;
-  }
+    nl->bytes_received += ret;
 
-  /* not enough buffer space ? */
-  if (nl->in_len < (size_t)ret || (_netlink_rcv_msg.msg_flags & MSG_TRUNC) != 0) {
-    void *ptr;
-    size_t size;
+    OONF_DEBUG(LOG_OS_SYSTEM, "Got netlink message of %"
+        PRINTF_SSIZE_T_SPECIFIER" bytes", ret);
 
-    size = nl->in_len;
-    while (size < (size_t)ret) {
-      size += getpagesize();
-    }
-    ptr = realloc(nl->in, size);
-    if (!ptr) {
-      OONF_WARN(LOG_OS_SYSTEM, "Not enough memory to increase netlink input buffer");
-      return;
-    }
-    nl->in = ptr;
-    nl->in_len = size;
-    goto netlink_rcv_retry;
-  }
-  if (flags) {
-    /* it worked, not remove the message from the queue */
-    flags = 0;
-    goto netlink_rcv_retry;
+    _handle_netlink_messages(nl, (size_t)ret);
   }
+}
 
-  OONF_DEBUG(LOG_OS_SYSTEM, "Got netlink message of %"
-      PRINTF_SSIZE_T_SPECIFIER" bytes", ret);
+/**
+ * Loop through all netlink messages of a received datagram
+ * @param nl pointer to netlink handler
+ * @param len length of datagram in input buffer
+ */
+static void
+_handle_netlink_messages(struct os_system_netlink *nl, size_t len) {
+  struct nlmsghdr *nh;
 
-  /* loop through netlink headers */
-  len = (size_t) ret;
   for (nh = nl->in; NLMSG_OK (nh, len); nh = NLMSG_NEXT (nh, len)) {
     OONF_DEBUG(LOG_OS_SYSTEM,
         "Netlink message received: type %d\n", nh->nlmsg_type);
@@ -639,6 +733,10 @@ netlink_rcv_retry:
         break;
 
       default:
+        if (nh->nlmsg_seq != 0 && nl->msg_in_transit > 0) {
+          /* answer in progress (e.g. a long dump), restart feedback timer */
+          oonf_timer_set(&nl->timeout, OS_SYSTEM_NETLINK_TIMEOUT);
+        }
         if (nl->cb_message) {
           nl->cb_message(nh);
         }
@@ -63,11 +63,28 @@ struct os_system_netlink {
 
   int msg_in_transit;
 
+  /* number of sendmsg()/recvmsg() calls of this socket */
+  uint64_t syscalls_send;
+  uint64_t syscalls_recv;
+
+  /* number of bytes sent and received */
+  uint64_t bytes_sent;
+  uint64_t bytes_received;
+
+  /* number of datagrams dropped because the input buffer could not grow */
+  uint64_t truncated;
+
   void (*cb_message)(struct nlmsghdr *hdr);
   void (*cb_error)(uint32_t seq, int error);
   void (*cb_timeout)(void);
   void (*cb_done)(uint32_t seq);
 
+  /*
+   * called when the kernel dropped messages because the receive buffer
+   * was full or a datagram was dropped because it did not fit
+   */
+  void (*cb_overflow)(void);
+
   struct oonf_timer_entry timeout;
 };
 
@@ -46,6 +46,7 @@
 #include <sys/time.h>
 
 #include "common/common_types.h"
+#include "common/avl.h"
 #include "common/list.h"
 #include "common/netaddr.h"
 #include "subsystems/oonf_interface.h"
@@ -114,6 +115,87 @@ struct os_route {
 
   /* callback for os_routing_query() */
   void (*cb_get)(struct os_route *filter, struct os_route *route);
+
+  /* result of the route in a batch (errno number, 0 if successful) */
+  int batch_result;
+};
+
+/*
+ * transaction of multiple route changes that are sent to the kernel
+ * together and have a common feedback callback. The cb_finished
+ * callbacks of the single routes are not used for batched routes.
+ */
+struct os_route_batch {
+  /*
+   * callback when all routes of the batch have been processed,
+   * the result of each route is stored in its batch_result field
+   */
+  void (*cb_finished)(struct os_route_batch *, size_t error_count);
+
+  /* routes of the batch, must stay valid until the batch is finished */
+  struct os_route **routes;
+  size_t route_count;
+
+  /* number of routes with an error */
+  size_t error_count;
+
+  /* os specific internal data */
+  struct os_route_batch_internal _internal;
+};
+
+/* kernel route stored in a route mirror */
+struct os_route_mirror_entry {
+  /* copy of the kernel route */
+  struct os_route route;
+
+  /* true if the route is part of the desired set of the running sync */
+  bool _desired;
+
+  /* node for tree of mirrored routes */
+  struct avl_node _node;
+};
+
+/*
+ * in-memory copy of the kernel routes of one routing table and
+ * protocol, kept up to date with the routing multicast events
+ * of the kernel
+ */
+struct os_route_mirror {
+  /* address family (AF_UNSPEC for IPv4 and IPv6) */
+  unsigned char family;
+
+  /* routing table and protocol (RTPROT_UNSPEC for all) of the mirror */
+  unsigned char table, protocol;
+
+  /*
+   * callback when the dump of the kernel routes is finished, called
+   * again after a new dump because the kernel dropped routing events
+   */
+  void (*cb_initialized)(struct os_route_mirror *);
+
+  /* callback when all changes of a sync have been processed */
+  void (*cb_sync_finished)(struct os_route_mirror *, size_t error_count);
+
+  /* true if the dump of the kernel routes is finished */
+  bool initialized;
+
+  /* tree of os_route_mirror_entry objects, key is destination and metric */
+  struct avl_tree routes;
+
+  /* number of routes set, removed and left unchanged by the last sync */
+  size_t sync_set, sync_removed, sync_unchanged;
+
+  /* true while a sync is waiting for kernel feedback */
+  bool _sync_running;
+
+  /* route changes of the running sync */
+  struct os_route_batch _batch;
+
+  /* copies of the routes removed by the running sync */
+  struct os_route *_removed_routes;
+
+  /* os specific internal data */
+  struct os_route_mirror_internal _internal;
 };
 
 #define LOG_OS_ROUTING oonf_os_routing_subsystem.logging
@@ -124,6 +206,18 @@ EXPORT extern const struct os_route OS_ROUTE_WILDCARD;
 EXPORT int os_routing_set(struct os_route *, bool set, bool del_similar);
 EXPORT int os_routing_query(struct os_route *);
 EXPORT void os_routing_interrupt(struct os_route *);
+EXPORT size_t os_routing_get_outstanding_requests(void);
+
+EXPORT int os_routing_batch_begin(struct os_route_batch *);
+EXPORT int os_routing_batch_add(struct os_route_batch *,
+    struct os_route *, bool set, bool del_similar);
+EXPORT int os_routing_batch_commit(struct os_route_batch *);
+EXPORT void os_routing_batch_interrupt(struct os_route_batch *);
+
+EXPORT int os_routing_mirror_add(struct os_route_mirror *);
+EXPORT void os_routing_mirror_remove(struct os_route_mirror *);
+EXPORT int os_routing_mirror_sync(struct os_route_mirror *,
+    struct os_route **desired, size_t count);
 
 EXPORT const char *os_routing_to_string(
     struct os_route_str *buf, struct os_route *route);
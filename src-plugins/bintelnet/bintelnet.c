@@ -0,0 +1,259 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2013, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+#include <arpa/inet.h>
+
+#include "common/common_types.h"
+#include "common/autobuf.h"
+#include "common/netaddr.h"
+#include "common/netaddr_acl.h"
+#include "config/cfg_schema.h"
+#include "core/oonf_logging.h"
+#include "core/oonf_plugins.h"
+#include "core/oonf_subsystem.h"
+#include "subsystems/oonf_stream_socket.h"
+#include "subsystems/oonf_telnet.h"
+
+#include "bintelnet/bintelnet.h"
+
+/* prototypes */
+static int _init(void);
+static void _cleanup(void);
+
+static enum oonf_stream_session_state _cb_receive_data(
+    struct oonf_stream_session *);
+static enum oonf_stream_session_state _handle_requests(
+    struct oonf_stream_session *);
+static void _handle_request(struct oonf_stream_session *, char *cmdline);
+
+static void _cb_config_changed(void);
+
+/* configuration */
+static struct cfg_schema_entry _bintelnet_entries[] = {
+  CFG_MAP_ACL_V46(oonf_stream_managed_config,
+      acl, "acl", "127.0.0.1", "Access control list for binary telnet interface"),
+  CFG_MAP_NETADDR_V4(oonf_stream_managed_config,
+      bindto_v4, "bindto_v4", "127.0.0.1", "Bind binary telnet ipv4 socket to this address", false, true),
+  CFG_MAP_NETADDR_V6(oonf_stream_managed_config,
+      bindto_v6, "bindto_v6", "::1", "Bind binary telnet ipv6 socket to this address", false, true),
+  CFG_MAP_INT32_MINMAX(oonf_stream_managed_config,
+      port, "port", "2007", "Network port for binary telnet interface", 0, false, 1, 65535),
+  CFG_MAP_INT32_MINMAX(oonf_stream_managed_config,
+      accept_rate, "accept_rate", "10",
+      "Maximum number of new connections per second for binary telnet interface, 0 for no limit", 0, false, 0, 65535),
+  CFG_MAP_INT32_MINMAX(oonf_stream_managed_config,
+      accept_burst, "accept_burst", "20",
+      "Maximum number of new connections for binary telnet interface accepted at once after an idle period,"
+      " 0 to use accept_rate", 0, false, 0, 65535),
+};
+
+static struct cfg_schema_section _bintelnet_section = {
+  .type = OONF_PLUGIN_GET_NAME(),
+  .mode = CFG_SSMODE_UNNAMED,
+  .cb_delta_handler = _cb_config_changed,
+  .entries = _bintelnet_entries,
+  .entry_count = ARRAYSIZE(_bintelnet_entries),
+};
+
+/* plugin declaration */
+struct oonf_subsystem oonf_bintelnet_subsystem = {
+  .name = OONF_PLUGIN_GET_NAME(),
+  .descr = "OONFD binary telnet interface plugin",
+  .author = "Henning Rogge",
+
+  .cfg_section = &_bintelnet_section,
+
+  .init = _init,
+  .cleanup = _cleanup,
+};
+DECLARE_OONF_PLUGIN(oonf_bintelnet_subsystem);
+
+/* binary telnet server */
+static struct oonf_stream_managed _bintelnet_managed = {
+  .config = {
+    .session_timeout = 120000, /* 120 seconds */
+    .maximum_input_buffer = 4096,
+    .allowed_sessions = 10,
+    .receive_data = _cb_receive_data,
+    .buffer_underrun = _handle_requests,
+  },
+};
+
+/* buffer for null terminated copy of a command line */
+static char _cmdline[BINTELNET_MAX_REQUEST_LENGTH + 1];
+
+/**
+ * Constructor of plugin
+ * @return 0 if initialization was successful, -1 otherwise
+ */
+static int
+_init(void) {
+  oonf_stream_add_managed(&_bintelnet_managed);
+  return 0;
+}
+
+/**
+ * Destructor of plugin
+ */
+static void
+_cleanup(void) {
+  oonf_stream_remove_managed(&_bintelnet_managed, true);
+}
+
+/**
+ * Callback for incoming data of a binary telnet session
+ * @param session pointer to stream session
+ * @return new state of session
+ */
+static enum oonf_stream_session_state
+_cb_receive_data(struct oonf_stream_session *session) {
+  if (abuf_getlen(&session->out) > TELNET_OUTPUT_WATERMARK) {
+    /* wait until the client has received the pending answers */
+    return STREAM_SESSION_ACTIVE;
+  }
+  return _handle_requests(session);
+}
+
+/**
+ * Execute all complete requests in the input buffer of a session.
+ * Stops if the output buffer grows above the telnet watermark,
+ * the rest of the requests will be executed when the answers
+ * have been sent.
+ * @param session pointer to stream session
+ * @return new state of session
+ */
+static enum oonf_stream_session_state
+_handle_requests(struct oonf_stream_session *session) {
+  uint32_t length;
+
+  while (abuf_getlen(&session->in) >= BINTELNET_REQUEST_HEADER_SIZE
+      && abuf_getlen(&session->out) <= TELNET_OUTPUT_WATERMARK) {
+    memcpy(&length, abuf_getptr(&session->in), sizeof(length));
+    length = ntohl(length);
+
+    if (length > BINTELNET_MAX_REQUEST_LENGTH) {
+      OONF_WARN(LOG_BINTELNET, "Binary telnet request too long: %u bytes",
+          length);
+      return STREAM_SESSION_CLEANUP;
+    }
+    if (abuf_getlen(&session->in) < BINTELNET_REQUEST_HEADER_SIZE + length) {
+      /* wait for the rest of the request */
+      break;
+    }
+
+    memcpy(_cmdline, abuf_getptr(&session->in) + BINTELNET_REQUEST_HEADER_SIZE,
+        length);
+    _cmdline[length] = 0;
+    abuf_pull(&session->in, BINTELNET_REQUEST_HEADER_SIZE + length);
+
+    _handle_request(session, _cmdline);
+    if (abuf_has_failed(&session->out)) {
+      OONF_WARN(LOG_BINTELNET, "Not enough memory for binary telnet answer");
+      return STREAM_SESSION_CLEANUP;
+    }
+  }
+  return STREAM_SESSION_ACTIVE;
+}
+
+/**
+ * Execute a single command line and add the answer to the
+ * output buffer of the session
+ * @param session pointer to stream session
+ * @param cmdline null terminated command line
+ */
+static void
+_handle_request(struct oonf_stream_session *session, char *cmdline) {
+  enum oonf_telnet_result result;
+  char *para;
+  size_t offset;
+  uint32_t length;
+
+  para = strchr(cmdline, ' ');
+  if (para) {
+    *para++ = 0;
+  }
+
+  /* reserve space for the answer header */
+  offset = abuf_getlen(&session->out);
+  abuf_append_uint32(&session->out, 0);
+  abuf_append_uint8(&session->out, 0);
+
+  result = oonf_telnet_execute_binary(cmdline, para,
+      &session->out, &session->remote_address);
+  if (abuf_has_failed(&session->out)) {
+    return;
+  }
+
+  OONF_DEBUG(LOG_BINTELNET, "Executed binary command '%s' (result %d)",
+      cmdline, result);
+
+  /* fill in the answer header */
+  length = htonl(abuf_getlen(&session->out) - offset - sizeof(length));
+  memcpy(abuf_getptr(&session->out) + offset, &length, sizeof(length));
+  abuf_getptr(&session->out)[offset + sizeof(length)] = result;
+}
+
+/**
+ * Handler for configuration changes
+ */
+static void
+_cb_config_changed(void) {
+  struct oonf_stream_managed_config config;
+
+  /* generate binary config */
+  memset(&config, 0, sizeof(config));
+  if (cfg_schema_tobin(&config, _bintelnet_section.post,
+      _bintelnet_entries, ARRAYSIZE(_bintelnet_entries))) {
+    /* error in conversion */
+    OONF_WARN(LOG_BINTELNET, "Cannot map binary telnet config to binary data");
+    goto apply_config_failed;
+  }
+
+  if (oonf_stream_apply_managed(&_bintelnet_managed, &config)) {
+    /* error while updating sockets */
+    goto apply_config_failed;
+  }
+
+  /* fall through */
+apply_config_failed:
+  netaddr_acl_remove(&config.acl);
+}
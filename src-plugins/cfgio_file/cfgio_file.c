@@ -166,7 +166,9 @@ _cb_file_load(struct cfg_instance *instance,
     parser = cfg_parser_find(instance, &dst, param, NULL);
   }
 
-  db = cfg_parser_parse_buffer(instance, parser, abuf_getptr(&dst), abuf_getlen(&dst), log);
+  /* parse the file content without modifying it */
+  db = cfg_parser_parse_const_buffer(instance, parser,
+      abuf_getptr(&dst), abuf_getlen(&dst), log);
   abuf_free(&dst);
   return db;
 }
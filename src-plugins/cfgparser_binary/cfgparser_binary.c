@@ -0,0 +1,139 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2013, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+#include "common/common_types.h"
+#include "common/autobuf.h"
+#include "config/cfg_binary.h"
+#include "config/cfg_db.h"
+#include "config/cfg_parser.h"
+#include "core/oonf_subsystem.h"
+#include "core/oonf_plugins.h"
+#include "core/oonf_cfg.h"
+
+#include "cfgparser_binary/cfgparser_binary.h"
+
+static void _early_cfg_init(void);
+static void _cleanup(void);
+
+static bool _cb_binary_check_hints(
+    struct autobuf *abuf, const char *path, const char *mimetype);
+static struct cfg_db *_cb_binary_parse(
+    char *src, size_t len, struct autobuf *log);
+static struct cfg_db *_cb_binary_parse_const(
+    const char *src, size_t len, struct autobuf *log);
+
+struct oonf_subsystem oonf_binary_parser_subsystem = {
+  .name = OONF_PLUGIN_GET_NAME(),
+  .descr = "OONFD binary configuration snapshot format plugin",
+  .author = "the olsr.org team",
+
+  .early_cfg_init = _early_cfg_init,
+  .cleanup = _cleanup,
+
+  .no_logging = true,
+};
+DECLARE_OONF_PLUGIN(oonf_binary_parser_subsystem);
+
+struct cfg_parser cfg_parser_binary = {
+  .name = "binary",
+  .check_hints = _cb_binary_check_hints,
+  .parse = _cb_binary_parse,
+  .parse_const = _cb_binary_parse_const,
+  .serialize = cfg_binary_serialize,
+};
+
+/**
+ * Callback to hook plugin into configuration system.
+ */
+static void
+_early_cfg_init(void)
+{
+  cfg_parser_add(oonf_cfg_get_instance(), &cfg_parser_binary);
+}
+
+/**
+ * Destructor of plugin
+ */
+static void
+_cleanup(void)
+{
+  cfg_parser_remove(oonf_cfg_get_instance(), &cfg_parser_binary);
+}
+
+/**
+ * Checks if a buffer contains a binary configuration snapshot
+ * @param abuf pointer to buffer, might be NULL
+ * @param path path of buffer content (unused)
+ * @param mimetype mimetype of buffer content (unused)
+ * @return true if buffer starts with the snapshot header
+ */
+static bool
+_cb_binary_check_hints(struct autobuf *abuf,
+    const char *path __attribute__((unused)),
+    const char *mimetype __attribute__((unused))) {
+  return abuf != NULL
+      && cfg_binary_is_snapshot(abuf_getptr(abuf), abuf_getlen(abuf));
+}
+
+/**
+ * Parse a buffer into a configuration database
+ * @param src pointer to buffer
+ * @param len length of buffer
+ * @param log autobuffer for logging output
+ * @return pointer to configuration database, NULL if an error happened
+ */
+static struct cfg_db *
+_cb_binary_parse(char *src, size_t len, struct autobuf *log) {
+  return cfg_binary_parse(src, len, log);
+}
+
+/**
+ * Parse a read-only buffer into a configuration database
+ * @param src pointer to buffer
+ * @param len length of buffer
+ * @param log autobuffer for logging output
+ * @return pointer to configuration database, NULL if an error happened
+ */
+static struct cfg_db *
+_cb_binary_parse_const(const char *src, size_t len, struct autobuf *log) {
+  return cfg_binary_parse(src, len, log);
+}
@@ -42,6 +42,7 @@
 #include <ctype.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <sys/types.h>
@@ -64,6 +65,8 @@ static void _cleanup(void);
 
 static struct cfg_db *_cb_compact_parse(
     char *src, size_t len, struct autobuf *log);
+static struct cfg_db *_cb_compact_parse_const(
+    const char *src, size_t len, struct autobuf *log);
 static int _cb_compact_serialize(
     struct autobuf *dst, struct cfg_db *src, struct autobuf *log);
 static int _parse_line(struct cfg_db *db, char *line,
@@ -86,6 +89,7 @@ DECLARE_OONF_PLUGIN(oonf_compact_parser_subsystem);
 struct cfg_parser cfg_parser_compact = {
   .name = "compact",
   .parse = _cb_compact_parse,
+  .parse_const = _cb_compact_parse_const,
   .serialize = _cb_compact_serialize,
   .def = true
 };
@@ -171,6 +175,81 @@ _cb_compact_parse(char *src, size_t len, struct autobuf *log) {
   return db;
 }
 
+/**
+ * Parse a read-only buffer into a configuration database in a single
+ * pass. Only the current line is copied into a temporary buffer,
+ * so the parser can work directly on a memory mapped file.
+ * @param src pointer to text buffer
+ * @param len length of buffer
+ * @param log autobuffer for logging output
+ * @return pointer to configuration database, NULL if an error happened
+ */
+static struct cfg_db *
+_cb_compact_parse_const(const char *src, size_t len, struct autobuf *log) {
+  char section[128];
+  char name[128];
+  struct cfg_db *db;
+  const char *line, *eol, *nul, *end;
+  char *buffer, *ptr;
+  size_t buffer_size, line_len;
+
+  db = cfg_db_add();
+  if (!db) {
+    return NULL;
+  }
+
+  memset(section, 0, sizeof(section));
+  memset(name, 0, sizeof(name));
+
+  buffer = NULL;
+  buffer_size = 0;
+
+  end = src + len;
+  for (line = src; line < end; line = eol + 1) {
+    /* find end of line, a zero byte ends a line too */
+    eol = memchr(line, '\n', end - line);
+    if (eol == NULL) {
+      eol = end;
+    }
+    nul = memchr(line, 0, eol - line);
+    if (nul != NULL) {
+      eol = nul;
+    }
+
+    line_len = eol - line;
+    if (line_len > 0 && line[line_len-1] == '\r') {
+      /* handle \r\n line ending */
+      line_len--;
+    }
+
+    if (line_len + 1 > buffer_size) {
+      ptr = realloc(buffer, line_len + 1);
+      if (ptr == NULL) {
+        cfg_append_printable_line(log,
+            "Out of memory error while allocating line buffer");
+        goto parse_error;
+      }
+      buffer = ptr;
+      buffer_size = line_len + 1;
+    }
+
+    memcpy(buffer, line, line_len);
+    buffer[line_len] = 0;
+
+    if (_parse_line(db, buffer, section, sizeof(section),
+        name, sizeof(name), log)) {
+      goto parse_error;
+    }
+  }
+  free(buffer);
+  return db;
+
+parse_error:
+  free(buffer);
+  cfg_db_remove(db);
+  return NULL;
+}
+
 /**
  * Serialize a configuration database into a buffer
  * @param dst target buffer
@@ -287,11 +366,13 @@ _parse_line(struct cfg_db *db, char *line,
   ptr = first;
 
   /* look for separator */
-  while (!isspace(*ptr)) {
+  while (*ptr != 0 && !isspace(*ptr)) {
     ptr++;
   }
 
-  *ptr++ = 0;
+  if (*ptr != 0) {
+    *ptr++ = 0;
+  }
 
   /* trim second token */
   ptr = str_trim(ptr);
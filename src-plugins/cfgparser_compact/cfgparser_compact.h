@@ -43,8 +43,10 @@
 #define CFGPARSER_COMPACT_H_
 
 #include "common/common_types.h"
+#include "config/cfg_parser.h"
 #include "core/oonf_subsystem.h"
 
 EXPORT extern struct oonf_subsystem oonf_compact_parser_subsystem;
+EXPORT extern struct cfg_parser cfg_parser_compact;
 
 #endif /* CFGPARSER_COMPACT_H_ */
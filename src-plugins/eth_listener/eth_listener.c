@@ -39,40 +39,95 @@
  *
  */
 
+/* must be first because of a problem with linux/netlink.h */
+#include <sys/socket.h>
+
+/* and now the rest of the includes */
+#include <linux/types.h>
+#include <linux/netlink.h>
+#include <linux/genetlink.h>
+#include <linux/rtnetlink.h>
 #include <linux/sockios.h>
 #include <net/if.h>
 #include <sys/ioctl.h>
 #include <sys/types.h>
-#include <sys/socket.h>
 #include <unistd.h>
 
 #include "common/common_types.h"
 #include "config/cfg_schema.h"
+#include "core/oonf_logging.h"
 #include "core/oonf_plugins.h"
+#include "subsystems/oonf_class.h"
 #include "subsystems/oonf_clock.h"
 #include "subsystems/oonf_interface.h"
 #include "subsystems/oonf_layer2.h"
 #include "subsystems/oonf_timer.h"
+#include "subsystems/os_system.h"
 
 #include "eth_listener/eth_listener.h"
 #include "eth_listener/ethtool-copy.h"
 
+/*
+ * constants of the ethtool generic netlink family, see
+ * linux/ethtool_netlink.h (which cannot be included together
+ * with ethtool-copy.h)
+ */
+#define ETHNL_GENL_NAME               "ethtool"
+#define ETHNL_MCGRP_MONITOR_NAME      "monitor"
+
+#define ETHNL_MSG_LINKMODES_GET       4
+#define ETHNL_MSG_LINKMODES_GET_REPLY 4
+#define ETHNL_MSG_LINKMODES_NTF       5
+
+#define ETHNL_A_HEADER_DEV_INDEX      1
+#define ETHNL_A_HEADER_FLAGS          3
+#define ETHNL_FLAG_COMPACT_BITSETS    (1 << 0)
+
+#define ETHNL_A_LINKMODES_HEADER      1
+#define ETHNL_A_LINKMODES_SPEED       5
+
 /* definitions */
 struct _eth_config {
   uint64_t interval;
 };
 
+/* state of the ethtool generic netlink family */
+enum _ethtool_family_state {
+  /* waiting for the answer of the kernel */
+  ETHTOOL_FAMILY_QUERY,
+
+  /* ethtool netlink is available */
+  ETHTOOL_FAMILY_AVAILABLE,
+
+  /* kernel has no ethtool netlink, use ioctl instead */
+  ETHTOOL_FAMILY_MISSING,
+};
+
 /* prototypes */
 static int _init(void);
 static void _cleanup(void);
 
 static void _cb_transmission_event(void *);
+static void _cb_interface_changed(struct oonf_interface_listener *);
+static void _cb_interface_removed(void *);
 static void _cb_config_changed(void);
 
+static void _send_genl_getfamily(void);
+static void _send_linkmodes_get(unsigned if_index);
+static void _query_ioctl(struct oonf_interface *interf);
+static void _set_linkspeed(unsigned if_index, int64_t ethspeed);
+static void _remove_linkspeed(const struct netaddr *mac);
+
+static void _cb_nl_message(struct nlmsghdr *hdr);
+static void _cb_nl_error(uint32_t seq, int error);
+static void _cb_nl_done(uint32_t seq);
+static void _cb_nl_timeout(void);
+
 /* configuration */
 static struct cfg_schema_entry _eth_entries[] = {
   CFG_MAP_CLOCK_MIN(_eth_config, interval, "interval", "60.0",
-      "Interval between two linklayer information updates", 100),
+      "Interval between two full linklayer information updates,"
+      " link changes are reported directly", 100),
 };
 
 static struct cfg_schema_section _eth_section = {
@@ -99,7 +154,7 @@ DECLARE_OONF_PLUGIN(eth_listener_subsystem);
 
 /* timer for generating netlink requests */
 static struct oonf_timer_info _transmission_timer_info = {
-  .name = "nl80211 listener timer",
+  .name = "eth listener timer",
   .callback = _cb_transmission_event,
   .periodic = true,
 };
@@ -108,81 +163,556 @@ static struct oonf_timer_entry _transmission_timer = {
   .info = &_transmission_timer_info
 };
 
+/* listener for changes of all interfaces */
+static struct oonf_interface_listener _if_listener = {
+  .process = _cb_interface_changed,
+};
+
+/* removal of interface objects, which does not trigger the listener */
+static struct oonf_class_extension _if_class_ext = {
+  .ext_name = "eth listener",
+  .class_name = OONF_CLASS_INTERFACE,
+  .cb_remove = _cb_interface_removed,
+};
+
+/* netlink socket for ethtool requests and notifications */
+static struct os_system_netlink _netlink_handler = {
+  .cb_message = _cb_nl_message,
+  .cb_error = _cb_nl_error,
+  .cb_done = _cb_nl_done,
+  .cb_timeout = _cb_nl_timeout,
+};
+
+/* buffer for netlink messages */
+static struct nlmsghdr *_msgbuf;
+
+/* generic netlink id of ethtool */
+static enum _ethtool_family_state _ethtool_state;
+static uint32_t _ethtool_id;
+static uint32_t _getfamily_seq;
+
+/* sequence number of the running linkmode dump, 0 if none */
+static uint32_t _dump_seq;
+
 static uint32_t _l2_origin;
 
+/**
+ * Constructor of plugin
+ * @return 0 if initialization was successful, -1 otherwise
+ */
 static int
 _init(void) {
+  _msgbuf = calloc(1, UIO_MAXIOV);
+  if (_msgbuf == NULL) {
+    OONF_WARN(LOG_ETH, "Not enough memory for ethtool netlink buffer");
+    return -1;
+  }
+
+  if (os_system_netlink_add(&_netlink_handler, NETLINK_GENERIC)) {
+    free(_msgbuf);
+    return -1;
+  }
+
+  if (oonf_class_extension_add(&_if_class_ext)) {
+    os_system_netlink_remove(&_netlink_handler);
+    free(_msgbuf);
+    return -1;
+  }
+
   oonf_timer_add(&_transmission_timer_info);
+  oonf_interface_add_listener(&_if_listener);
   _l2_origin = oonf_layer2_register_origin();
 
+  _ethtool_state = ETHTOOL_FAMILY_QUERY;
+  _ethtool_id = 0;
+  _dump_seq = 0;
+  _send_genl_getfamily();
   return 0;
 }
 
+/**
+ * Destructor of plugin
+ */
 static void
 _cleanup(void) {
   oonf_layer2_cleanup_origin(_l2_origin);
 
+  oonf_interface_remove_listener(&_if_listener);
+  oonf_class_extension_remove(&_if_class_ext);
   oonf_timer_stop(&_transmission_timer);
   oonf_timer_remove(&_transmission_timer_info);
+
+  os_system_netlink_remove(&_netlink_handler);
+  free(_msgbuf);
 }
 
+/**
+ * Timer callback for the periodic update of all interfaces.
+ * With ethtool netlink this is a single dump request.
+ * @param ptr unused
+ */
 static void
 _cb_transmission_event(void *ptr __attribute((unused))) {
-  struct oonf_layer2_net *l2net;
   struct oonf_interface *interf;
+  struct genlmsghdr *hdr;
+  uint32_t flags;
+  uint8_t nest[NLA_HDRLEN + sizeof(flags)];
+  struct nlattr *attr;
+
+  if (_ethtool_state == ETHTOOL_FAMILY_MISSING) {
+    avl_for_each_element(&oonf_interface_tree, interf, _node) {
+      _query_ioctl(interf);
+    }
+    return;
+  }
+
+  if (_ethtool_state != ETHTOOL_FAMILY_AVAILABLE || _dump_seq != 0) {
+    /* family unknown yet or the last dump is still running */
+    return;
+  }
+
+  memset(_msgbuf, 0, UIO_MAXIOV);
+
+  /* generic netlink initialization */
+  hdr = NLMSG_DATA(_msgbuf);
+  _msgbuf->nlmsg_len = NLMSG_LENGTH(sizeof(*hdr));
+  _msgbuf->nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  _msgbuf->nlmsg_type = _ethtool_id;
+
+  hdr->cmd = ETHNL_MSG_LINKMODES_GET;
+  hdr->version = 1;
+
+  /* request header without device, we are not interested in the bitsets */
+  flags = ETHNL_FLAG_COMPACT_BITSETS;
+  attr = (struct nlattr *)nest;
+  attr->nla_type = ETHNL_A_HEADER_FLAGS;
+  attr->nla_len = sizeof(nest);
+  memcpy(nest + NLA_HDRLEN, &flags, sizeof(flags));
+
+  if (os_system_netlink_addreq(_msgbuf,
+      ETHNL_A_LINKMODES_HEADER | NLA_F_NESTED, nest, sizeof(nest))) {
+    return;
+  }
+
+  _dump_seq = os_system_netlink_send(&_netlink_handler, _msgbuf);
+}
+
+/**
+ * Callback for interface changes, requests the link speed
+ * of the changed interface
+ * @param listener pointer to interface listener
+ */
+static void
+_cb_interface_changed(struct oonf_interface_listener *listener) {
+  struct oonf_interface *interf;
+
+  interf = avl_find_element(&oonf_interface_tree,
+      listener->old->name, interf, _node);
+  if (interf == NULL || interf->data.index != listener->old->index
+      || netaddr_cmp(&interf->data.mac, &listener->old->mac) != 0) {
+    /* interface vanished or was replaced, forget the old link speed */
+    _remove_linkspeed(&listener->old->mac);
+  }
+  if (interf == NULL || interf->data.index == 0) {
+    return;
+  }
+
+  if (!interf->data.up) {
+    /* no link speed without a link */
+    _remove_linkspeed(&interf->data.mac);
+  }
+  else if (_ethtool_state == ETHTOOL_FAMILY_AVAILABLE) {
+    _send_linkmodes_get(interf->data.index);
+  }
+  else if (_ethtool_state == ETHTOOL_FAMILY_MISSING) {
+    _query_ioctl(interf);
+  }
+}
+
+/**
+ * Callback for removed interface objects
+ * @param ptr pointer to interface
+ */
+static void
+_cb_interface_removed(void *ptr) {
+  struct oonf_interface *interf = ptr;
+
+  _remove_linkspeed(&interf->data.mac);
+}
+
+/**
+ * Request the generic netlink id of ethtool from the kernel
+ */
+static void
+_send_genl_getfamily(void) {
+  struct genlmsghdr *hdr;
+
+  memset(_msgbuf, 0, UIO_MAXIOV);
+
+  /* generic netlink initialization */
+  hdr = NLMSG_DATA(_msgbuf);
+  _msgbuf->nlmsg_len = NLMSG_LENGTH(sizeof(*hdr));
+  _msgbuf->nlmsg_flags = NLM_F_REQUEST;
+
+  /* request ethtool identifier */
+  _msgbuf->nlmsg_type = GENL_ID_CTRL;
+
+  hdr->cmd = CTRL_CMD_GETFAMILY;
+  hdr->version = 1;
+
+  if (os_system_netlink_addreq(_msgbuf, CTRL_ATTR_FAMILY_NAME,
+      ETHNL_GENL_NAME, sizeof(ETHNL_GENL_NAME))) {
+    _ethtool_state = ETHTOOL_FAMILY_MISSING;
+    return;
+  }
+
+  _getfamily_seq = os_system_netlink_send(&_netlink_handler, _msgbuf);
+}
+
+/**
+ * Request the link modes of a single interface from ethtool
+ * @param if_index interface index
+ */
+static void
+_send_linkmodes_get(unsigned if_index) {
+  struct genlmsghdr *hdr;
+  uint32_t value;
+  uint8_t nest[2 * (NLA_HDRLEN + sizeof(value))];
+  struct nlattr *attr;
+
+  memset(_msgbuf, 0, UIO_MAXIOV);
+
+  /* generic netlink initialization */
+  hdr = NLMSG_DATA(_msgbuf);
+  _msgbuf->nlmsg_len = NLMSG_LENGTH(sizeof(*hdr));
+  _msgbuf->nlmsg_flags = NLM_F_REQUEST;
+  _msgbuf->nlmsg_type = _ethtool_id;
+
+  hdr->cmd = ETHNL_MSG_LINKMODES_GET;
+  hdr->version = 1;
+
+  /* request header with interface index and flags */
+  value = if_index;
+  attr = (struct nlattr *)nest;
+  attr->nla_type = ETHNL_A_HEADER_DEV_INDEX;
+  attr->nla_len = NLA_HDRLEN + sizeof(value);
+  memcpy(nest + NLA_HDRLEN, &value, sizeof(value));
+
+  value = ETHNL_FLAG_COMPACT_BITSETS;
+  attr = (struct nlattr *)(nest + NLA_HDRLEN + sizeof(value));
+  attr->nla_type = ETHNL_A_HEADER_FLAGS;
+  attr->nla_len = NLA_HDRLEN + sizeof(value);
+  memcpy(nest + 2 * NLA_HDRLEN + sizeof(value), &value, sizeof(value));
+
+  if (os_system_netlink_addreq(_msgbuf,
+      ETHNL_A_LINKMODES_HEADER | NLA_F_NESTED, nest, sizeof(nest))) {
+    return;
+  }
+
+  os_system_netlink_send(&_netlink_handler, _msgbuf);
+}
+
+/**
+ * Query the link speed of an interface with the ethtool ioctl,
+ * fallback for kernels without ethtool netlink support
+ * @param interf pointer to interface
+ */
+static void
+_query_ioctl(struct oonf_interface *interf) {
   struct ethtool_cmd cmd;
   struct ifreq req;
   int64_t ethspeed;
-  int err;
 
+  if (!interf->data.up) {
+    _set_linkspeed(interf->data.index, 0);
+    return;
+  }
+
+  /* initialize ethtool command */
+  memset(&cmd, 0, sizeof(cmd));
+  cmd.cmd = ETHTOOL_GSET;
+
+  /* initialize interface request */
+  memset(&req, 0, sizeof(req));
+  req.ifr_data = (void *)&cmd;
+  strscpy(req.ifr_name, interf->data.name, IF_NAMESIZE);
+
+  /* request ethernet information from kernel */
+  if (ioctl(os_net_linux_get_ioctl_fd(AF_INET), SIOCETHTOOL, &req)) {
+    _set_linkspeed(interf->data.index, 0);
+    return;
+  }
+
+  ethspeed = ethtool_cmd_speed(&cmd);
+  if (ethspeed == (uint32_t)SPEED_UNKNOWN) {
+    ethspeed = 0;
+  }
+  _set_linkspeed(interf->data.index, ethspeed * 1000 * 1000);
+}
+
+/**
+ * Update the layer2 database with the link speed of an interface.
+ * The database is only changed if the value changed.
+ * @param if_index interface index
+ * @param ethspeed link speed in bit/s, 0 if unknown
+ */
+static void
+_set_linkspeed(unsigned if_index, int64_t ethspeed) {
+  struct oonf_layer2_net *l2net;
+  struct oonf_interface *interf;
+  struct oonf_layer2_data *data;
+  bool found;
+
+  found = false;
   avl_for_each_element(&oonf_interface_tree, interf, _node) {
-    /* layer-2 object for this interface */
-    l2net = oonf_layer2_net_get(&interf->data.mac);
-
-    /* initialize ethtool command */
-    memset(&cmd, 0, sizeof(cmd));
-    cmd.cmd = ETHTOOL_GSET;
-
-    /* initialize interface request */
-    memset(&req, 0, sizeof(req));
-    req.ifr_data = (void *)&cmd;
-    strscpy(req.ifr_name, "eth0", IF_NAMESIZE);
-
-    /* request ethernet information from kernel */
-    err = ioctl(os_net_linux_get_ioctl_fd(AF_INET), SIOCETHTOOL, &req);
-    if (err != 0) {
-      if (l2net != NULL) {
-        oonf_layer2_net_remove(l2net, _l2_origin);
-      }
-      continue;
+    if (interf->data.index == if_index) {
+      found = true;
+      break;
+    }
+  }
+  if (!found) {
+    /* not an interface used by us */
+    return;
+  }
+
+  if (ethspeed <= 0) {
+    _remove_linkspeed(&interf->data.mac);
+    return;
+  }
+
+  /* layer-2 object for this interface */
+  l2net = oonf_layer2_net_get(&interf->data.mac);
+  if (l2net) {
+    data = &l2net->data[OONF_LAYER2_NET_MAX_BITRATE];
+    if (!oonf_layer2_has_value(data) || oonf_layer2_get_origin(data) != _l2_origin) {
+      data = NULL;
     }
+  }
+  else {
+    data = NULL;
+  }
+
+  if (data && oonf_layer2_get_value(data) == ethspeed) {
+    /* nothing changed */
+    return;
+  }
 
+  if (l2net == NULL) {
+    l2net = oonf_layer2_net_add(&interf->data.mac);
     if (l2net == NULL) {
-      l2net = oonf_layer2_net_add(&interf->data.mac);
-      if (l2net == NULL) {
-        continue;
+      return;
+    }
+
+    /* copy interface static values */
+    l2net->if_index = interf->data.index;
+    strscpy(l2net->if_name, interf->data.name, sizeof(l2net->if_name));
+    l2net->if_type = OONF_LAYER2_TYPE_ETHERNET;
+  }
+
+  OONF_DEBUG(LOG_ETH, "Link speed of %s: %"PRId64" bit/s",
+      interf->data.name, ethspeed);
+
+  /* set corresponding database entries */
+  oonf_layer2_set_value(&l2net->neighdata[OONF_LAYER2_NEIGH_RX_BITRATE],
+      _l2_origin, ethspeed);
+  oonf_layer2_set_value(&l2net->neighdata[OONF_LAYER2_NEIGH_TX_BITRATE],
+      _l2_origin, ethspeed);
+  oonf_layer2_set_value(&l2net->data[OONF_LAYER2_NET_MAX_BITRATE],
+      _l2_origin, ethspeed);
+  oonf_layer2_net_commit(l2net);
+}
+
+/**
+ * Remove the link speed of an interface from the layer2 database,
+ * including the default bitrates of its neighbors
+ * @param mac hardware address of the interface
+ */
+static void
+_remove_linkspeed(const struct netaddr *mac) {
+  struct oonf_layer2_net *l2net;
+
+  l2net = oonf_layer2_net_get(mac);
+  if (l2net) {
+    oonf_layer2_net_remove(l2net, _l2_origin);
+  }
+}
+
+/**
+ * Parse the answer to the generic netlink family request
+ * and join the ethtool monitor group
+ * @param hdr pointer to netlink message
+ */
+static void
+_parse_cmd_newfamily(struct nlmsghdr *hdr) {
+  struct rtattr *attr, *grp, *grp_attr;
+  int len, grp_len, attr_len;
+  const char *name;
+  uint32_t group;
+  bool monitor;
+
+  attr = (struct rtattr *)((char *)NLMSG_DATA(hdr) + GENL_HDRLEN);
+  len = hdr->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN);
+
+  for (; RTA_OK(attr, len); attr = RTA_NEXT(attr, len)) {
+    if (attr->rta_type == CTRL_ATTR_FAMILY_ID) {
+      _ethtool_id = *(uint16_t *)RTA_DATA(attr);
+      continue;
+    }
+    if (attr->rta_type != CTRL_ATTR_MCAST_GROUPS) {
+      continue;
+    }
+
+    /* look for the monitor group */
+    grp = RTA_DATA(attr);
+    grp_len = RTA_PAYLOAD(attr);
+    for (; RTA_OK(grp, grp_len); grp = RTA_NEXT(grp, grp_len)) {
+      monitor = false;
+      group = 0;
+
+      grp_attr = RTA_DATA(grp);
+      attr_len = RTA_PAYLOAD(grp);
+      for (; RTA_OK(grp_attr, attr_len); grp_attr = RTA_NEXT(grp_attr, attr_len)) {
+        if (grp_attr->rta_type == CTRL_ATTR_MCAST_GRP_NAME) {
+          name = RTA_DATA(grp_attr);
+          monitor = strcmp(name, ETHNL_MCGRP_MONITOR_NAME) == 0;
+        }
+        else if (grp_attr->rta_type == CTRL_ATTR_MCAST_GRP_ID) {
+          group = *(uint32_t *)RTA_DATA(grp_attr);
+        }
       }
 
-      /* copy interface static values */
-      l2net->if_index = interf->data.index;
-      strscpy(l2net->if_name, interf->data.name, sizeof(l2net->if_name));
-      l2net->if_type = OONF_LAYER2_TYPE_ETHERNET;
+      if (monitor && group != 0
+          && os_system_netlink_add_mc(&_netlink_handler, &group, 1)) {
+        OONF_WARN(LOG_ETH, "Could not join ethtool monitor group %u", group);
+      }
     }
+  }
 
-    /* get ethernet linkspeed */
-    ethspeed = ethtool_cmd_speed(&cmd);
-    ethspeed *= 1000 * 1000;
+  if (_ethtool_id == 0) {
+    return;
+  }
+
+  OONF_DEBUG(LOG_ETH, "Found ethtool netlink family: %u", _ethtool_id);
+  _ethtool_state = ETHTOOL_FAMILY_AVAILABLE;
+
+  /* get initial values */
+  _cb_transmission_event(NULL);
+}
+
+/**
+ * Parse the link modes of an interface
+ * @param hdr pointer to netlink message
+ */
+static void
+_parse_linkmodes(struct nlmsghdr *hdr) {
+  struct rtattr *attr, *hdr_attr;
+  int len, hdr_len;
+  unsigned if_index;
+  uint32_t speed;
 
-    /* set corresponding database entries */
-    oonf_layer2_set_value(&l2net->neighdata[OONF_LAYER2_NEIGH_RX_BITRATE],
-        _l2_origin, ethspeed);
-    oonf_layer2_set_value(&l2net->neighdata[OONF_LAYER2_NEIGH_TX_BITRATE],
-        _l2_origin, ethspeed);
-    oonf_layer2_set_value(&l2net->data[OONF_LAYER2_NET_MAX_BITRATE],
-        _l2_origin, ethspeed);
+  if_index = 0;
+  speed = (uint32_t)SPEED_UNKNOWN;
+
+  attr = (struct rtattr *)((char *)NLMSG_DATA(hdr) + GENL_HDRLEN);
+  len = hdr->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN);
+
+  for (; RTA_OK(attr, len); attr = RTA_NEXT(attr, len)) {
+    switch (attr->rta_type & NLA_TYPE_MASK) {
+      case ETHNL_A_LINKMODES_HEADER:
+        hdr_attr = RTA_DATA(attr);
+        hdr_len = RTA_PAYLOAD(attr);
+        for (; RTA_OK(hdr_attr, hdr_len); hdr_attr = RTA_NEXT(hdr_attr, hdr_len)) {
+          if (hdr_attr->rta_type == ETHNL_A_HEADER_DEV_INDEX) {
+            if_index = *(uint32_t *)RTA_DATA(hdr_attr);
+          }
+        }
+        break;
+      case ETHNL_A_LINKMODES_SPEED:
+        speed = *(uint32_t *)RTA_DATA(attr);
+        break;
+      default:
+        break;
+    }
+  }
+
+  if (if_index == 0) {
+    return;
   }
+
+  if (speed == (uint32_t)SPEED_UNKNOWN) {
+    speed = 0;
+  }
+  _set_linkspeed(if_index, (int64_t)speed * 1000 * 1000);
 }
 
+/**
+ * Parse an incoming netlink message from the kernel
+ * @param hdr pointer to netlink message
+ */
+static void
+_cb_nl_message(struct nlmsghdr *hdr) {
+  struct genlmsghdr *gen_hdr;
+
+  gen_hdr = NLMSG_DATA(hdr);
+  if (hdr->nlmsg_type == GENL_ID_CTRL && gen_hdr->cmd == CTRL_CMD_NEWFAMILY) {
+    _parse_cmd_newfamily(hdr);
+    return;
+  }
+
+  if (_ethtool_id != 0 && hdr->nlmsg_type == _ethtool_id
+      && (gen_hdr->cmd == ETHNL_MSG_LINKMODES_GET_REPLY
+          || gen_hdr->cmd == ETHNL_MSG_LINKMODES_NTF)) {
+    _parse_linkmodes(hdr);
+    return;
+  }
+
+  OONF_INFO(LOG_ETH, "Unhandled incoming netlink message type %u cmd %u\n",
+      hdr->nlmsg_type, gen_hdr->cmd);
+}
+
+/**
+ * Feedback of the kernel for a netlink request
+ * @param seq sequence number of request
+ * @param error 0 for an acknowledgement, negative error code otherwise
+ */
+static void
+_cb_nl_error(uint32_t seq, int error) {
+  if (seq == _getfamily_seq && _ethtool_state == ETHTOOL_FAMILY_QUERY) {
+    /* no family id in the answer */
+    OONF_INFO(LOG_ETH, "No ethtool netlink support (%d), using ioctl", error);
+    _ethtool_state = ETHTOOL_FAMILY_MISSING;
+    _cb_transmission_event(NULL);
+  }
+  if (seq == _dump_seq) {
+    _dump_seq = 0;
+  }
+}
+
+/**
+ * End of a netlink dump
+ * @param seq sequence number of dump request
+ */
+static void
+_cb_nl_done(uint32_t seq) {
+  if (seq == _dump_seq) {
+    _dump_seq = 0;
+  }
+}
+
+/**
+ * Timeout of a netlink request
+ */
+static void
+_cb_nl_timeout(void) {
+  if (_ethtool_state == ETHTOOL_FAMILY_QUERY) {
+    _ethtool_state = ETHTOOL_FAMILY_MISSING;
+  }
+  _dump_seq = 0;
+}
+
+/**
+ * Configuration changed
+ */
 static void
 _cb_config_changed(void) {
   if (cfg_schema_tobin(&_config, _eth_section.post,
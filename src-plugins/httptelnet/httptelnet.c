@@ -39,6 +39,8 @@
  *
  */
 
+#include <stdlib.h>
+
 #include "common/common_types.h"
 #include "common/autobuf.h"
 #include "common/netaddr.h"
@@ -53,12 +55,26 @@
 
 #include "httptelnet/httptelnet.h"
 
+/* size of the blocks a large telnet answer is sent in */
+enum { HTTPTELNET_BLOCK_SIZE = 16384 };
+
+/* telnet answer that is sent to the http client block by block */
+struct _httptelnet_stream {
+  /* complete output of the telnet command */
+  struct autobuf answer;
+
+  /* number of bytes already copied into the http output buffer */
+  size_t offset;
+};
+
 /* prototypes */
 static int _init(void);
 static void _cleanup(void);
 
 static enum oonf_http_result _cb_generate_site(
     struct autobuf *out, struct oonf_http_session *);
+static bool _cb_stream_block(struct autobuf *out, struct oonf_http_session *);
+static void _cb_stream_stop(struct oonf_http_session *);
 
 static void _cb_config_changed(void);
 
@@ -118,13 +134,15 @@ _cleanup(void) {
 
 /**
  * Callback for generating a http site from the output of the
- * triggered telnet command
+ * triggered telnet command. Answers larger than one block are
+ * sent block by block as a http stream.
  * @param out pointer to output buffer
  * @param session pointer to http session
  * @return http result code
  */
 static enum oonf_http_result
 _cb_generate_site(struct autobuf *out, struct oonf_http_session *session) {
+  struct _httptelnet_stream *stream;
   const char *command, *param;
   enum oonf_telnet_result result;
 
@@ -135,26 +153,92 @@ _cb_generate_site(struct autobuf *out, struct oonf_http_session *session) {
     return HTTP_404_NOT_FOUND;
   }
 
-  result = oonf_telnet_execute(command, param, out, session->remote);
+  stream = calloc(1, sizeof(*stream));
+  if (stream == NULL) {
+    return HTTP_500_INTERNAL_SERVER_ERROR;
+  }
+  if (abuf_init(&stream->answer)) {
+    free(stream);
+    return HTTP_500_INTERNAL_SERVER_ERROR;
+  }
+  session->stream_data[0] = stream;
+
+  result = oonf_telnet_execute(command, param, &stream->answer, session->remote);
   switch (result) {
     case TELNET_RESULT_ACTIVE:
     case TELNET_RESULT_QUIT:
       OONF_DEBUG(LOG_HTTPTELNET, "httptelnet called command '%s'"
           " with parameters '%s'",
           command, param);
-      session->content_type = HTTP_CONTENTTYPE_TEXT;
-      return HTTP_200_OK;
+      break;
 
     case _TELNET_RESULT_UNKNOWN_COMMAND:
       OONF_WARN(LOG_HTTPTELNET, "Unknown command for httptelnet bridge: %s",
           command);
+      _cb_stream_stop(session);
       return HTTP_404_NOT_FOUND;
 
     default:
       OONF_WARN(LOG_HTTPTELNET, "Unknown telnet returncode: %d",
           result);
+      _cb_stream_stop(session);
       return HTTP_400_BAD_REQ;
   }
+
+  if (abuf_has_failed(&stream->answer)) {
+    _cb_stream_stop(session);
+    return HTTP_500_INTERNAL_SERVER_ERROR;
+  }
+
+  session->content_type = HTTP_CONTENTTYPE_TEXT;
+  if (_cb_stream_block(out, session)) {
+    /* the rest of the answer follows when the first block is sent */
+    session->stream_handler = _cb_stream_block;
+    session->stop_handler = _cb_stream_stop;
+  }
+  else {
+    _cb_stream_stop(session);
+  }
+  return HTTP_200_OK;
+}
+
+/**
+ * Copy the next block of a telnet answer into the http output buffer
+ * @param out pointer to output buffer
+ * @param session pointer to http session
+ * @return true if there is more data to send, false otherwise
+ */
+static bool
+_cb_stream_block(struct autobuf *out, struct oonf_http_session *session) {
+  struct _httptelnet_stream *stream;
+  size_t len;
+
+  stream = session->stream_data[0];
+
+  len = abuf_getlen(&stream->answer) - stream->offset;
+  if (len > HTTPTELNET_BLOCK_SIZE) {
+    len = HTTPTELNET_BLOCK_SIZE;
+  }
+
+  abuf_memcpy(out, abuf_getptr(&stream->answer) + stream->offset, len);
+  stream->offset += len;
+
+  return stream->offset < abuf_getlen(&stream->answer);
+}
+
+/**
+ * Free the buffered telnet answer of a http session
+ * @param session pointer to http session
+ */
+static void
+_cb_stream_stop(struct oonf_http_session *session) {
+  struct _httptelnet_stream *stream;
+
+  stream = session->stream_data[0];
+  session->stream_data[0] = NULL;
+
+  abuf_free(&stream->answer);
+  free(stream);
 }
 
 /**
@@ -54,6 +54,7 @@
 #include "subsystems/oonf_clock.h"
 #include "subsystems/oonf_interface.h"
 #include "subsystems/oonf_layer2.h"
+#include "subsystems/oonf_layer2_history.h"
 #include "subsystems/oonf_telnet.h"
 
 #include "layer2_viewer/layer2_viewer.h"
@@ -69,6 +70,7 @@
 /* definitions */
 struct _l2viewer_config {
   struct netaddr_acl acl;
+  bool history;
 };
 
 /* prototypes */
@@ -78,10 +80,15 @@ static void _cleanup(void);
 static void _cb_config_changed(void);
 
 static enum oonf_telnet_result _cb_handle_layer2(struct oonf_telnet_data *data);
+static int _print_history(struct autobuf *out);
+static enum oonf_telnet_result _cb_handle_layer2_binary(
+    struct oonf_telnet_data *data);
 
 /* configuration */
 static struct cfg_schema_entry _layer2_entries[] = {
   CFG_MAP_ACL(_l2viewer_config, acl, "acl", "default_accept", "acl for layer2 telnet command"),
+  CFG_MAP_BOOL(_l2viewer_config, history, "history", "no",
+      "Record the recent values of all layer2 neighbors for the 'layer2 history' command"),
 };
 
 static struct cfg_schema_section _layer2_section = {
@@ -93,6 +100,9 @@ static struct cfg_schema_section _layer2_section = {
 
 static struct _l2viewer_config _config;
 
+/* true if the plugin is a user of the layer2 history */
+static bool _history_active = false;
+
 /* plugin declaration */
 struct oonf_subsystem oonf_layer2_viewer_subsystem = {
   .name = OONF_PLUGIN_GET_NAME(),
@@ -118,8 +128,10 @@ static struct oonf_telnet_command _telnet_cmd =
       "\"layer2 neigh list\": show a table of all known WLAN neighbors\n"
       "\"layer2 neigh "JSON_TEMPLATE_FORMAT"\": show a json output of all known WLAN neighbors\n"
       "\"layer2 neigh <template>\": show a table of all known WLAN neighbors\n"
-      "     (use neigh_full/neigh_inactive to output all/inactive neighbors)\n",
-      .acl = &_config.acl);
+      "     (use neigh_full/neigh_inactive to output all/inactive neighbors)\n"
+      "\"layer2 history\": show average, minimum and maximum of the recent\n"
+      "     values of all known WLAN neighbors (needs the 'history' setting)\n",
+      .acl = &_config.acl, .binary_handler = _cb_handle_layer2_binary);
 
 /* template buffers */
 static struct {
@@ -231,6 +243,10 @@ _init(void) {
  */
 static void
 _cleanup(void) {
+  if (_history_active) {
+    oonf_layer2_history_remove();
+    _history_active = false;
+  }
   oonf_telnet_remove(&_telnet_cmd);
 }
 
@@ -429,6 +445,11 @@ _cb_handle_layer2(struct oonf_telnet_data *data) {
       }
     }
   }
+  else if (strcasecmp(data->parameter, "history") == 0) {
+    if (_print_history(data->out)) {
+      return TELNET_RESULT_INTERNAL_ERROR;
+    }
+  }
   else {
     abuf_appendf(data->out, "Error, unknown parameters for %s command: %s\n",
         data->command, data->parameter);
@@ -438,6 +459,156 @@ _cb_handle_layer2(struct oonf_telnet_data *data) {
   return TELNET_RESULT_ACTIVE;
 }
 
+/**
+ * Print the value history of all layer2 neighbors
+ * @param out pointer to output buffer
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_print_history(struct autobuf *out) {
+  const struct oonf_layer2_metadata *meta;
+  struct oonf_layer2_history *history;
+  struct oonf_layer2_net *net;
+  struct oonf_layer2_neigh *neigh;
+  struct netaddr_str nbuf;
+  struct isonumber_str avg_buf, min_buf, max_buf;
+  int i;
+
+  if (!_history_active) {
+    abuf_puts(out, "Error, layer2 history is not active\n");
+    return 0;
+  }
+
+  avl_for_each_element(&oonf_layer2_net_tree, net, _node) {
+    avl_for_each_element(&net->neighbors, neigh, _node) {
+      for (i=0; i<OONF_LAYER2_NEIGH_COUNT; i++) {
+        history = oonf_layer2_history_get(neigh, i);
+        if (history == NULL || history->count == 0) {
+          continue;
+        }
+
+        meta = &oonf_layer2_metadata_neigh[i];
+        if (!str_to_isonumber_s64(&avg_buf, history->ewma,
+            meta->unit, meta->fraction, meta->binary, false)
+            || !str_to_isonumber_s64(&min_buf, history->min,
+                meta->unit, meta->fraction, meta->binary, false)
+            || !str_to_isonumber_s64(&max_buf, history->max,
+                meta->unit, meta->fraction, meta->binary, false)) {
+          return -1;
+        }
+
+        abuf_appendf(out, "%s\t%s\t%u samples\tavg %s\tmin %s\tmax %s\n",
+            netaddr_to_string(&nbuf, &neigh->addr), meta->key,
+            history->count, avg_buf.buf, min_buf.buf, max_buf.buf);
+      }
+    }
+  }
+  return abuf_has_failed(out) ? -1 : 0;
+}
+
+/**
+ * Add the common values of a layer2 network to the typed output
+ * @param data pointer to telnet data
+ * @param net pointer to layer2 network
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_add_network_records(struct oonf_telnet_data *data,
+    struct oonf_layer2_net *net) {
+  char interface[IF_NAMESIZE];
+
+  oonf_telnet_record_netaddr(data, KEY_radio, &net->addr);
+  if (net->if_index) {
+    oonf_telnet_record_int64(data, KEY_ifindex, net->if_index);
+    if (if_indextoname(net->if_index, interface)) {
+      oonf_telnet_record_string(data, KEY_interface, interface);
+    }
+  }
+  return abuf_has_failed(data->out) ? -1 : 0;
+}
+
+/**
+ * Add the layer2 data values to the typed output
+ * @param data pointer to telnet data
+ * @param l2data array of layer2 data
+ * @param meta array of layer2 metadata
+ * @param count number of elements in both arrays
+ * @param last_seen timestamp when the object was updated, 0 if never
+ * @return -1 if an error happened, 0 otherwise
+ */
+static int
+_add_data_records(struct oonf_telnet_data *data,
+    struct oonf_layer2_data *l2data,
+    const struct oonf_layer2_metadata *meta, size_t count,
+    uint64_t last_seen) {
+  size_t i;
+
+  if (last_seen) {
+    /* milliseconds since last update */
+    oonf_telnet_record_int64(data, KEY_lastseen,
+        -oonf_clock_get_relative(last_seen));
+  }
+
+  for (i=0; i<count; i++) {
+    if (oonf_layer2_has_value(&l2data[i])) {
+      oonf_telnet_record_int64(data, meta[i].key,
+          oonf_layer2_get_value(&l2data[i]));
+    }
+  }
+  return oonf_telnet_record_end(data);
+}
+
+/**
+ * Implementation of the typed output of the 'layer2' telnet command.
+ * Output templates are ignored, each network or neighbor is
+ * represented by a record with all known values. All other
+ * parameters are answered with the text output of the command.
+ * @param data pointer to telnet data
+ * @return return code for telnet server
+ */
+static enum oonf_telnet_result
+_cb_handle_layer2_binary(struct oonf_telnet_data *data) {
+  struct oonf_layer2_net *net;
+  struct oonf_layer2_neigh *neigh;
+
+  if (data->parameter == NULL) {
+    /* let the text handler generate the error message */
+    return oonf_telnet_execute_text_as_binary(&_telnet_cmd, data);
+  }
+
+  if (str_hasnextword(data->parameter, _net_params.sub)) {
+    avl_for_each_element(&oonf_layer2_net_tree, net, _node) {
+      oonf_telnet_record_start(data, _net_params.sub);
+      if (net->if_ident[0]) {
+        oonf_telnet_record_string(data, KEY_ifid, net->if_ident);
+      }
+      if (_add_network_records(data, net)
+          || _add_data_records(data, net->data, oonf_layer2_metadata_net,
+              OONF_LAYER2_NET_COUNT, net->last_seen)) {
+        return TELNET_RESULT_INTERNAL_ERROR;
+      }
+    }
+  }
+  else if (str_hasnextword(data->parameter, _neigh_params.sub)) {
+    avl_for_each_element(&oonf_layer2_net_tree, net, _node) {
+      avl_for_each_element(&net->neighbors, neigh, _node) {
+        oonf_telnet_record_start(data, _neigh_params.sub);
+        oonf_telnet_record_netaddr(data, KEY_neighbor, &neigh->addr);
+        if (_add_network_records(data, net)
+            || _add_data_records(data, neigh->data, oonf_layer2_metadata_neigh,
+                OONF_LAYER2_NEIGH_COUNT, neigh->last_seen)) {
+          return TELNET_RESULT_INTERNAL_ERROR;
+        }
+      }
+    }
+  }
+  else {
+    /* history and error messages only exist as text */
+    return oonf_telnet_execute_text_as_binary(&_telnet_cmd, data);
+  }
+  return TELNET_RESULT_ACTIVE;
+}
+
 /**
  * Update configuration of layer2-viewer plugin
  */
@@ -448,4 +619,17 @@ _cb_config_changed(void) {
     OONF_WARN(LOG_LAYER2_VIEWER, "Could not convert layer2_listener config to bin");
     return;
   }
+
+  /* the history costs memory and time for every neighbor, use it only on request */
+  if (_config.history && !_history_active) {
+    if (oonf_layer2_history_add()) {
+      OONF_WARN(LOG_LAYER2_VIEWER, "Could not activate layer2 history");
+      return;
+    }
+    _history_active = true;
+  }
+  else if (!_config.history && _history_active) {
+    oonf_layer2_history_remove();
+    _history_active = false;
+  }
 }
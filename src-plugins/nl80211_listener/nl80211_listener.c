@@ -56,6 +56,7 @@
 #include "common/avl.h"
 #include "common/avl_comp.h"
 #include "common/common_types.h"
+#include "common/list.h"
 #include "common/netaddr.h"
 #include "common/netaddr_acl.h"
 #include "common/string.h"
@@ -75,8 +76,13 @@
 #include "nl80211_listener/nl80211_listener.h"
 
 /* definitions */
+
+/* number of netlink sockets for nl80211 dumps running in parallel */
+#define NL80211_DUMP_SOCKETS 4
+
 struct _nl80211_config {
   uint64_t interval;
+  uint64_t scan_interval;
 };
 
 enum query_type {
@@ -88,6 +94,52 @@ enum query_type {
   QUERY_COUNT,
 };
 
+/* periodic nl80211 dump of one interface */
+struct _nl80211_dump {
+  /* node for queue of dumps waiting for a free socket */
+  struct list_entity _node;
+
+  /* interface index and type of the dump */
+  unsigned if_index;
+  enum query_type type;
+
+  /* timestamp when the last dump was finished */
+  uint64_t last_finished;
+
+  /* true while the dump is processed by the kernel */
+  bool running;
+};
+
+/* dump state of an interface */
+struct _nl80211_if {
+  struct avl_node _node;
+
+  /* interface index, key of the tree */
+  unsigned if_index;
+
+  /* number of the last timer tick that has seen the interface */
+  uint32_t tick;
+
+  struct _nl80211_dump dumps[QUERY_COUNT];
+};
+
+/*
+ * netlink socket for dumps, the kernel only allows one running
+ * dump per socket
+ */
+struct _nl80211_dump_socket {
+  struct os_system_netlink netlink;
+
+  /* running dump, NULL if none or if the interface has been removed */
+  struct _nl80211_dump *dump;
+
+  /* sequence number of the running dump */
+  uint32_t seq;
+
+  /* true while the socket waits for the end of a dump */
+  bool busy;
+};
+
 /* prototypes */
 static int _init(void);
 static void _cleanup(void);
@@ -102,10 +154,25 @@ static void _cb_nl_done(uint32_t seq);
 
 static void _cb_transmission_event(void *);
 
+static struct _nl80211_if *_get_interface(unsigned if_index, bool create);
+static void _remove_interface(struct _nl80211_if *);
+static void _queue_dump(unsigned if_index, enum query_type type);
+static void _process_dump_queue(void);
+static struct _nl80211_dump_socket *_get_dump_socket(uint32_t seq);
+static void _dump_finished(struct _nl80211_dump_socket *);
+
+static void _cb_dump_error(uint32_t seq, int error);
+static void _cb_dump_done(uint32_t seq);
+static void _cb_dump_timeout(void);
+
 /* configuration */
 static struct cfg_schema_entry _nl80211_entries[] = {
   CFG_MAP_CLOCK_MIN(_nl80211_config, interval, "interval", "1.0",
-      "Interval between two linklayer information updates", 100),
+      "Maximum age of the station data of an interface before it is"
+      " refreshed by a station dump", 100),
+  CFG_MAP_CLOCK_MIN(_nl80211_config, scan_interval, "scan_interval", "1.0",
+      "Interval between two scan dumps of an interface, new scan results"
+      " announced by the kernel are dumped immediately", 100),
 };
 
 static struct cfg_schema_section _nl80211_section = {
@@ -143,8 +210,22 @@ static struct nlmsghdr *_msgbuf;
 static int _nl80211_id = -1;
 static bool _nl80211_mc_set = false;
 
-static char _last_queried_if[IF_NAMESIZE];
-static enum query_type _next_query_type;
+/* sockets for parallel dumps */
+static struct _nl80211_dump_socket _dump_sockets[NL80211_DUMP_SOCKETS];
+
+/* dumps waiting for a free socket */
+static struct list_entity _dump_queue;
+
+/* tree of interface dump states */
+static struct avl_tree _interface_tree;
+
+static struct oonf_class _interface_class = {
+  .name = "nl80211 interface",
+  .size = sizeof(struct _nl80211_if),
+};
+
+/* counter for timer ticks */
+static uint32_t _current_tick;
 
 static uint32_t _l2_origin;
 
@@ -165,6 +246,8 @@ struct oonf_timer_entry _transmission_timer = {
  */
 static int
 _init(void) {
+  size_t i;
+
   _msgbuf = calloc(1, UIO_MAXIOV);
   if (_msgbuf == NULL) {
     OONF_WARN(LOG_NL80211, "Not enough memory for nl80211 memory buffer");
@@ -176,12 +259,31 @@ _init(void) {
     return -1;
   }
 
+  for (i=0; i<NL80211_DUMP_SOCKETS; i++) {
+    memset(&_dump_sockets[i], 0, sizeof(_dump_sockets[i]));
+    _dump_sockets[i].netlink.cb_message = _cb_nl_message;
+    _dump_sockets[i].netlink.cb_error = _cb_dump_error;
+    _dump_sockets[i].netlink.cb_done = _cb_dump_done;
+    _dump_sockets[i].netlink.cb_timeout = _cb_dump_timeout;
+
+    if (os_system_netlink_add(&_dump_sockets[i].netlink, NETLINK_GENERIC)) {
+      while (i > 0) {
+        os_system_netlink_remove(&_dump_sockets[--i].netlink);
+      }
+      os_system_netlink_remove(&_netlink_handler);
+      free(_msgbuf);
+      return -1;
+    }
+  }
+
   _l2_origin = oonf_layer2_register_origin();
 
-  oonf_timer_add(&_transmission_timer_info);
+  oonf_class_add(&_interface_class);
+  avl_init(&_interface_tree, avl_comp_uint32, false);
+  list_init_head(&_dump_queue);
+  _current_tick = 0;
 
-  memset(_last_queried_if, 0, sizeof(_last_queried_if));
-  _next_query_type = QUERY_STATION_DUMP;
+  oonf_timer_add(&_transmission_timer_info);
 
   _send_genl_getfamily();
   return 0;
@@ -192,10 +294,22 @@ _init(void) {
  */
 static void
 _cleanup(void) {
+  struct _nl80211_if *interf, *interf_it;
+  size_t i;
+
   oonf_layer2_cleanup_origin(_l2_origin);
 
   oonf_timer_stop(&_transmission_timer);
   oonf_timer_remove(&_transmission_timer_info);
+
+  avl_for_each_element_safe(&_interface_tree, interf, _node, interf_it) {
+    _remove_interface(interf);
+  }
+  oonf_class_remove(&_interface_class);
+
+  for (i=0; i<NL80211_DUMP_SOCKETS; i++) {
+    os_system_netlink_remove(&_dump_sockets[i].netlink);
+  }
   os_system_netlink_remove(&_netlink_handler);
 
   free (_msgbuf);
@@ -240,6 +354,7 @@ _parse_cmd_newfamily(struct nlmsghdr *hdr) {
   };
   struct nlattr *attrs[CTRL_ATTR_MAX+1];
   struct nlattr *mcgrp;
+  const char *name;
   int iterator;
 
   if (nlmsg_parse(hdr, sizeof(struct genlmsghdr),
@@ -278,13 +393,13 @@ _parse_cmd_newfamily(struct nlmsghdr *hdr) {
         !tb_mcgrp[CTRL_ATTR_MCAST_GRP_ID])
       continue;
 
-    if (strcmp(nla_data(tb_mcgrp[CTRL_ATTR_MCAST_GRP_NAME]), "mlme"))
+    /* station events and notifications about new scan results */
+    name = nla_data(tb_mcgrp[CTRL_ATTR_MCAST_GRP_NAME]);
+    if (strcmp(name, "mlme") != 0 && strcmp(name, "scan") != 0)
       continue;
 
     group = nla_get_u32(tb_mcgrp[CTRL_ATTR_MCAST_GRP_ID]);
-    OONF_DEBUG(LOG_NL80211, "Found multicast group %s: %d",
-        (char *)nla_data(tb_mcgrp[CTRL_ATTR_MCAST_GRP_NAME]),
-        group);
+    OONF_DEBUG(LOG_NL80211, "Found multicast group %s: %d", name, group);
 
     if (os_system_netlink_add_mc(&_netlink_handler, &group, 1)) {
       OONF_WARN(LOG_NL80211,
@@ -293,7 +408,6 @@ _parse_cmd_newfamily(struct nlmsghdr *hdr) {
     else {
       _nl80211_mc_set = true;
     }
-    break;
   }
 }
 
@@ -566,6 +680,11 @@ _parse_cmd_new_scan_result(struct nlmsghdr *msg) {
   }
 
   if (!tb[NL80211_ATTR_BSS]) {
+    if (tb[NL80211_ATTR_IFINDEX] != NULL && msg->nlmsg_seq == 0) {
+      /* kernel event about new scan results, get them */
+      _queue_dump(nla_get_u32(tb[NL80211_ATTR_IFINDEX]), QUERY_SCAN_DUMP);
+      return;
+    }
     OONF_WARN(LOG_NL80211, "bss info missing!\n");
     return;
   }
@@ -754,6 +873,9 @@ _cb_nl_message(struct nlmsghdr *hdr) {
   }
 
   if (hdr->nlmsg_type == _nl80211_id) {
+    /* report all changes of a dump as one event per object */
+    oonf_layer2_transaction_begin();
+
     if (gen_hdr->cmd == NL80211_CMD_NEW_STATION) {
       _parse_cmd_new_station(hdr);
       return;
@@ -797,10 +919,12 @@ _send_genl_getfamily(void) {
 
 /**
  * Request a station dump from nl80211
+ * @param nl pointer to netlink socket
  * @param if_idx interface index to be dumped
+ * @return netlink sequence number of request
  */
-static void
-_send_nl80211_get_station_dump(int if_idx) {
+static int
+_send_nl80211_get_station_dump(struct os_system_netlink *nl, int if_idx) {
   struct genlmsghdr *hdr;
 
   memset(_msgbuf, 0, UIO_MAXIOV);
@@ -817,15 +941,17 @@ _send_nl80211_get_station_dump(int if_idx) {
   /* add interface index to the request */
   os_system_netlink_addreq(_msgbuf, NL80211_ATTR_IFINDEX, &if_idx, sizeof(if_idx));
 
-  os_system_netlink_send(&_netlink_handler, _msgbuf);
+  return os_system_netlink_send(nl, _msgbuf);
 }
 
 /**
  * Request a passive scan dump from nl80211
+ * @param nl pointer to netlink socket
  * @param if_idx interface index to be dumped
+ * @return netlink sequence number of request
  */
-static void
-_send_nl80211_get_scan_dump(int if_idx) {
+static int
+_send_nl80211_get_scan_dump(struct os_system_netlink *nl, int if_idx) {
   struct genlmsghdr *hdr;
 
   memset(_msgbuf, 0, UIO_MAXIOV);
@@ -842,72 +968,258 @@ _send_nl80211_get_scan_dump(int if_idx) {
   /* add interface index to the request */
   os_system_netlink_addreq(_msgbuf, NL80211_ATTR_IFINDEX, &if_idx, sizeof(if_idx));
 
-  os_system_netlink_send(&_netlink_handler, _msgbuf);
+  return os_system_netlink_send(nl, _msgbuf);
 }
 
 /**
- * Transmit the next netlink command to nl80211
+ * Queue the dumps of all interfaces with outdated data
  * @param ptr unused
  */
 static void
 _cb_transmission_event(void *ptr __attribute__((unused))) {
   struct oonf_interface *interf;
+  struct _nl80211_if *nif, *nif_it;
 
-  if (_last_queried_if[0] == 0) {
-    /* get first interface */
-    interf = avl_first_element(&oonf_interface_tree, interf, _node);
+  if (_nl80211_id == -1) {
+    /* nl80211 family not known yet */
+    return;
+  }
+
+  _current_tick++;
+
+  avl_for_each_element(&oonf_interface_tree, interf, _node) {
+    if (interf->data.index == 0) {
+      continue;
+    }
+
+    nif = _get_interface(interf->data.index, true);
+    if (nif == NULL) {
+      continue;
+    }
+    nif->tick = _current_tick;
+
+    if (oonf_clock_get_relative(nif->dumps[QUERY_STATION_DUMP].last_finished)
+        <= -(int64_t)_config.interval) {
+      _queue_dump(nif->if_index, QUERY_STATION_DUMP);
+    }
+    if (oonf_clock_get_relative(nif->dumps[QUERY_SCAN_DUMP].last_finished)
+        <= -(int64_t)_config.scan_interval) {
+      _queue_dump(nif->if_index, QUERY_SCAN_DUMP);
+    }
   }
-  else {
-    /* get next interface */
-    interf = avl_find_ge_element(&oonf_interface_tree, _last_queried_if, interf, _node);
 
-    if (interf != NULL && strcmp(_last_queried_if, interf->data.name) == 0) {
-      interf = avl_next_element_safe(&oonf_interface_tree, interf, _node);
+  /* remove state of interfaces that are gone */
+  avl_for_each_element_safe(&_interface_tree, nif, _node, nif_it) {
+    if (nif->tick != _current_tick) {
+      _remove_interface(nif);
     }
   }
+}
+
+/**
+ * Get the dump state of an interface
+ * @param if_index interface index
+ * @param create true if the state should be created if necessary
+ * @return pointer to interface state, NULL if not found
+ *   or out of memory
+ */
+static struct _nl80211_if *
+_get_interface(unsigned if_index, bool create) {
+  struct _nl80211_if *nif;
+  int i;
 
-  if (!interf && _next_query_type < QUERY_COUNT-1) {
-    /* begin next query type */
-    _next_query_type++;
-    interf = avl_first_element(&oonf_interface_tree, interf, _node);
+  nif = avl_find_uint32_element(&_interface_tree, &if_index, nif, _node);
+  if (nif != NULL || !create) {
+    return nif;
   }
 
-  if (!interf) {
-    /* nothing to do anymore */
-    memset(_last_queried_if, 0, sizeof(_last_queried_if));
-    _next_query_type = QUERY_FIRST;
+  nif = oonf_class_malloc(&_interface_class);
+  if (nif == NULL) {
+    return NULL;
+  }
+
+  nif->if_index = if_index;
+  nif->tick = _current_tick;
+  nif->_node.key = &nif->if_index;
+  avl_insert(&_interface_tree, &nif->_node);
+
+  for (i=0; i<QUERY_COUNT; i++) {
+    nif->dumps[i].if_index = if_index;
+    nif->dumps[i].type = i;
+  }
+  return nif;
+}
+
+/**
+ * Remove the dump state of an interface
+ * @param nif pointer to interface state
+ */
+static void
+_remove_interface(struct _nl80211_if *nif) {
+  size_t i;
+  int j;
+
+  for (j=0; j<QUERY_COUNT; j++) {
+    if (list_is_node_added(&nif->dumps[j]._node)) {
+      list_remove(&nif->dumps[j]._node);
+    }
+  }
+
+  /* running dumps must not access the state anymore */
+  for (i=0; i<NL80211_DUMP_SOCKETS; i++) {
+    if (_dump_sockets[i].dump != NULL
+        && _dump_sockets[i].dump->if_index == nif->if_index) {
+      _dump_sockets[i].dump = NULL;
+    }
+  }
+
+  avl_remove(&_interface_tree, &nif->_node);
+  oonf_class_free(&_interface_class, nif);
+}
+
+/**
+ * Add a dump to the queue if it is not already waiting or running
+ * @param if_index interface index
+ * @param type type of dump
+ */
+static void
+_queue_dump(unsigned if_index, enum query_type type) {
+  struct _nl80211_if *nif;
+  struct _nl80211_dump *dump;
+
+  nif = _get_interface(if_index, true);
+  if (nif == NULL) {
     return;
   }
-  else {
-    strscpy(_last_queried_if, interf->data.name, sizeof(_last_queried_if));
+
+  dump = &nif->dumps[type];
+  if (dump->running || list_is_node_added(&dump->_node)) {
+    return;
   }
 
-  OONF_DEBUG(LOG_NL80211, "Send Query %d to NL80211 interface %s",
-      _next_query_type, interf->data.name);
-  if (_next_query_type == QUERY_STATION_DUMP) {
-    _send_nl80211_get_station_dump(interf->data.index);
+  list_add_tail(&_dump_queue, &dump->_node);
+  _process_dump_queue();
+}
+
+/**
+ * Start waiting dumps on all idle dump sockets
+ */
+static void
+_process_dump_queue(void) {
+  struct _nl80211_dump_socket *sock;
+  struct _nl80211_dump *dump;
+  size_t i;
+
+  for (i=0; i<NL80211_DUMP_SOCKETS && !list_is_empty(&_dump_queue); i++) {
+    sock = &_dump_sockets[i];
+    if (sock->busy) {
+      continue;
+    }
+
+    dump = list_first_element(&_dump_queue, dump, _node);
+    list_remove(&dump->_node);
+
+    OONF_DEBUG(LOG_NL80211, "Send Query %d to NL80211 interface %d",
+        dump->type, dump->if_index);
+
+    if (dump->type == QUERY_STATION_DUMP) {
+      sock->seq = _send_nl80211_get_station_dump(&sock->netlink, dump->if_index);
+    }
+    else {
+      sock->seq = _send_nl80211_get_scan_dump(&sock->netlink, dump->if_index);
+    }
+
+    dump->running = true;
+    sock->dump = dump;
+    sock->busy = true;
   }
-  else if (_next_query_type == QUERY_SCAN_DUMP){
-    _send_nl80211_get_scan_dump(interf->data.index);
+}
+
+/**
+ * @param seq netlink sequence number
+ * @return dump socket waiting for the sequence number, NULL if not found
+ */
+static struct _nl80211_dump_socket *
+_get_dump_socket(uint32_t seq) {
+  size_t i;
+
+  for (i=0; i<NL80211_DUMP_SOCKETS; i++) {
+    if (_dump_sockets[i].busy && _dump_sockets[i].seq == seq) {
+      return &_dump_sockets[i];
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Mark the dump of a socket as finished and start the next one
+ * @param sock pointer to dump socket
+ */
+static void
+_dump_finished(struct _nl80211_dump_socket *sock) {
+  if (sock->dump) {
+    sock->dump->running = false;
+    sock->dump->last_finished = oonf_clock_getNow();
+    sock->dump = NULL;
   }
+  sock->busy = false;
+
+  _process_dump_queue();
 }
 
 static void
 _cb_nl_error(uint32_t seq __attribute((unused)), int error __attribute((unused))) {
   OONF_DEBUG(LOG_NL80211, "%u: Received error %d", seq, error);
-  _cb_transmission_event(NULL);
 }
 
 static void
 _cb_nl_timeout(void) {
   OONF_DEBUG(LOG_NL80211, "Received timeout");
-  _cb_transmission_event(NULL);
 }
 
 static void
 _cb_nl_done(uint32_t seq __attribute((unused))) {
   OONF_DEBUG(LOG_NL80211, "%u: Received done", seq);
-  _cb_transmission_event(NULL);
+}
+
+static void
+_cb_dump_error(uint32_t seq, int error __attribute((unused))) {
+  struct _nl80211_dump_socket *sock;
+
+  OONF_DEBUG(LOG_NL80211, "%u: Received dump error %d", seq, error);
+
+  sock = _get_dump_socket(seq);
+  if (sock) {
+    _dump_finished(sock);
+  }
+}
+
+static void
+_cb_dump_done(uint32_t seq) {
+  struct _nl80211_dump_socket *sock;
+
+  OONF_DEBUG(LOG_NL80211, "%u: Received dump done", seq);
+
+  sock = _get_dump_socket(seq);
+  if (sock) {
+    _dump_finished(sock);
+  }
+}
+
+static void
+_cb_dump_timeout(void) {
+  size_t i;
+
+  OONF_DEBUG(LOG_NL80211, "Received dump timeout");
+
+  /* the timer of the socket that timed out is already stopped */
+  for (i=0; i<NL80211_DUMP_SOCKETS; i++) {
+    if (_dump_sockets[i].busy
+        && !oonf_timer_is_active(&_dump_sockets[i].netlink.timeout)
+        && abuf_getlen(&_dump_sockets[i].netlink.out) == 0) {
+      _dump_finished(&_dump_sockets[i]);
+    }
+  }
 }
 
 /**
@@ -922,5 +1234,11 @@ _cb_config_changed(void) {
     return;
   }
 
-  oonf_timer_set_ext(&_transmission_timer, 1, _config.interval);
+  /* check four times per interval to keep the age of the data bounded */
+  if (_config.scan_interval < _config.interval) {
+    oonf_timer_set_ext(&_transmission_timer, 1, _config.scan_interval / 4);
+  }
+  else {
+    oonf_timer_set_ext(&_transmission_timer, 1, _config.interval / 4);
+  }
 }
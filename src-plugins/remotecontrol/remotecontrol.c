@@ -56,7 +56,9 @@
 #include "core/oonf_logging.h"
 #include "subsystems/oonf_class.h"
 #include "core/oonf_plugins.h"
+#include "subsystems/oonf_http.h"
 #include "subsystems/oonf_timer.h"
+#include "subsystems/oonf_stream_socket.h"
 #include "core/oonf_subsystem.h"
 #include "subsystems/os_routing.h"
 
@@ -92,6 +94,8 @@ static enum oonf_telnet_result _update_logfilter(struct oonf_telnet_data *data,
 
 static void _print_memory(struct autobuf *buf);
 static void _print_timer(struct autobuf *buf);
+static void _print_stream(struct autobuf *buf);
+static void _print_http(struct autobuf *buf);
 
 static enum oonf_telnet_result _start_logging(struct oonf_telnet_data *data,
     struct _remotecontrol_session *rc_session);
@@ -139,7 +143,9 @@ DECLARE_OONF_PLUGIN(oonf_remotecontrol_subsystem);
 static struct oonf_telnet_command _telnet_cmds[] = {
   TELNET_CMD("resources", _cb_handle_resource,
       "\"resources memory\": display information about memory usage\n"
-      "\"resources timer\": display information about active timers\n",
+      "\"resources timer\": display information about active timers\n"
+      "\"resources stream\": display statistics of stream sockets and sessions\n"
+      "\"resources http\": display statistics of http sites\n",
       .acl = &_remotecontrol_config.acl),
   TELNET_CMD("log", _cb_handle_log,
       "\"log\":      continuous output of logging to this console\n"
@@ -233,6 +239,7 @@ _cleanup(void)
 static void
 _print_memory(struct autobuf *buf) {
   struct oonf_class *c;
+  struct oonf_class_extension *ext;
 
   avl_for_each_element(&oonf_classes, c, _node) {
     abuf_appendf(buf, "%-25s (MEMORY) size: %"PRINTF_SIZE_T_SPECIFIER
@@ -242,6 +249,13 @@ _print_memory(struct autobuf *buf) {
         oonf_class_get_free(c),
         oonf_class_get_allocations(c),
         oonf_class_get_recycled(c));
+
+    list_for_each_element(&c->_extensions, ext, _node) {
+      abuf_appendf(buf, "    %-21s (EXTENSION) callbacks: %"PRIu64
+          " callback time: %"PRIu64" us filtered: %"PRIu64"\n",
+          ext->ext_name, ext->callback_count, ext->callback_time,
+          ext->filtered_count);
+    }
   }
 }
 
@@ -259,6 +273,56 @@ _print_timer(struct autobuf *buf) {
   }
 }
 
+/**
+ * Print statistics of stream sockets and their sessions
+ * @param buf output buffer
+ */
+static void
+_print_stream(struct autobuf *buf) {
+  struct oonf_stream_socket *stream;
+  struct oonf_stream_session *session;
+  struct netaddr_str nbuf;
+
+  list_for_each_element(&oonf_stream_head, stream, node) {
+    abuf_appendf(buf, "%-25s (STREAM) accepted: %"PRIu64
+        " rejected (acl/rate/sessions): %"PRIu64"/%"PRIu64"/%"PRIu64
+        " bytes in/out: %"PRIu64"/%"PRIu64
+        " callbacks: %"PRIu64" callback time: %"PRIu64" us\n",
+        netaddr_socket_to_string(&nbuf, &stream->local_socket),
+        stream->accepted, stream->rejected_acl, stream->rejected_rate,
+        stream->rejected_sessions, stream->bytes_in, stream->bytes_out,
+        stream->callback_count, stream->callback_time);
+
+    list_for_each_element(&stream->session, session, node) {
+      abuf_appendf(buf, "    %-21s (SESSION) bytes in/out: %"PRIu64"/%"PRIu64
+          " callbacks: %"PRIu64" callback time: %"PRIu64" us\n",
+          netaddr_to_string(&nbuf, &session->remote_address),
+          session->bytes_in, session->bytes_out,
+          session->callback_count, session->callback_time);
+    }
+  }
+}
+
+/**
+ * Print request statistics of http sites
+ * @param buf output buffer
+ */
+static void
+_print_http(struct autobuf *buf) {
+  struct oonf_http_handler *handler;
+
+  if (!oonf_subsystem_is_initialized(&oonf_http_subsystem)) {
+    return;
+  }
+
+  avl_for_each_element(&oonf_http_site_tree, handler, node) {
+    abuf_appendf(buf, "%-25s (HTTP) requests: %"PRIu64
+        " content time total/max: %"PRIu64"/%"PRIu64" us\n",
+        handler->site, handler->request_count,
+        handler->request_time_total, handler->request_time_max);
+  }
+}
+
 /**
  * Handle resource command
  * @param data pointer to telnet data
@@ -275,6 +339,16 @@ _cb_handle_resource(struct oonf_telnet_data *data) {
     abuf_puts(data->out, "\nTimer cookies:\n");
     _print_timer(data->out);
   }
+
+  if (data->parameter == NULL || strcasecmp(data->parameter, "stream") == 0) {
+    abuf_puts(data->out, "\nStream sockets:\n");
+    _print_stream(data->out);
+  }
+
+  if (data->parameter == NULL || strcasecmp(data->parameter, "http") == 0) {
+    abuf_puts(data->out, "\nHTTP sites:\n");
+    _print_http(data->out);
+  }
   return TELNET_RESULT_ACTIVE;
 }
 
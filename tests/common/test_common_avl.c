@@ -299,6 +299,67 @@ static void test_find(bool do_random) {
   END_TEST();
 }
 
+static void test_find_typed(bool do_random) {
+  struct tree_element *e;
+  struct avl_node *typed, *generic;
+  int i;
+
+  START_TEST();
+  avl_init(&head, avl_comp_uint32, true);
+  add_elements(nodes, do_random);
+
+  for (i=0; i<COUNT; i++) {
+    CHECK_TRUE(avl_find_uint32(&head, &nodes[i].value) == &nodes[i].node, "node of element %d not found", i);
+    e = avl_find_uint32_element(&head, &nodes[i].value, e, node);
+    CHECK_TRUE(e == &nodes[i], "element %d not found", i);
+  }
+  i = 255;
+  CHECK_TRUE(avl_find_uint32(&head, (uint32_t *)&i) == NULL, "non-existing element found: %d", i);
+
+  /* typed lookup must return the same node as the generic one */
+  additional_node1.value = nodes[3].value;
+  additional_node1.node.key = &additional_node1.value;
+  CHECK_TRUE(avl_insert(&head, &additional_node1.node) == 0, "insert duplicate (in dup tree) was not successful");
+
+  for (i=0; i<COUNT; i++) {
+    typed = avl_find_uint32(&head, &nodes[i].value);
+    generic = avl_find(&head, &nodes[i].value);
+
+    CHECK_TRUE(typed == generic, "typed and generic lookup of element %d differ", i);
+  }
+  END_TEST();
+}
+
+static void test_find_netaddr(void) {
+  struct netaddr_element {
+    struct netaddr addr;
+    struct avl_node node;
+  } addrs[4], *e;
+  const char *strings[] = { "10.0.0.1", "10.0.0.0/8", "fe80::1", "00:11:22:33:44:55" };
+  struct netaddr key;
+  size_t i;
+
+  START_TEST();
+  avl_init(&head, avl_comp_netaddr, false);
+
+  memset(addrs, 0, sizeof(addrs));
+  for (i=0; i<ARRAYSIZE(addrs); i++) {
+    CHECK_TRUE(netaddr_from_string(&addrs[i].addr, strings[i]) == 0, "Could not parse %s", strings[i]);
+    addrs[i].node.key = &addrs[i].addr;
+    CHECK_TRUE(avl_insert(&head, &addrs[i].node) == 0, "Could not insert %s", strings[i]);
+  }
+
+  for (i=0; i<ARRAYSIZE(addrs); i++) {
+    CHECK_TRUE(netaddr_from_string(&key, strings[i]) == 0, "Could not parse %s", strings[i]);
+    e = avl_find_element(&head, &key, e, node);
+    CHECK_TRUE(e == &addrs[i], "Could not find %s", strings[i]);
+  }
+
+  CHECK_TRUE(netaddr_from_string(&key, "10.0.0.2") == 0, "Could not parse 10.0.0.2");
+  CHECK_TRUE(avl_find(&head, &key) == NULL, "Found 10.0.0.2");
+  END_TEST();
+}
+
 static void test_delete_nondup(bool do_random) {
   START_TEST();
 
@@ -840,6 +901,7 @@ static void do_tests(bool do_random) {
   test_insert_nondup(do_random);
   test_insert_dup(do_random);
   test_find(do_random);
+  test_find_typed(do_random);
   test_delete_nondup(do_random);
   test_delete_dup(do_random);
   test_greaterequal(do_random);
@@ -860,6 +922,7 @@ int main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))
   do_tests(true);
   test_random_insert();
   test_for_each_key_macros();
+  test_find_netaddr();
 
   return FINISH_TESTING();
 }
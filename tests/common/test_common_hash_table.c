@@ -0,0 +1,339 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2013, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/avl.h"
+#include "common/avl_comp.h"
+#include "common/hash_table.h"
+#include "cunit/cunit.h"
+
+/* number of elements for growth and random tests */
+#define COUNT 5000
+
+struct table_element {
+  uint32_t value;
+  struct hash_node node;
+  struct avl_node _avl_node;
+};
+
+struct string_element {
+  const char *name;
+  struct hash_node node;
+};
+
+static struct hash_table table;
+static struct table_element elements[COUNT];
+
+static void clear_elements(void) {
+  uint32_t i;
+
+  memset(elements, 0, sizeof(elements));
+  for (i=0; i<COUNT; i++) {
+    elements[i].value = i * 7;
+    elements[i].node.key = &elements[i].value;
+  }
+  hash_table_init(&table, hash_table_hash_uint32, avl_comp_uint32);
+}
+
+static void test_insert_find(void) {
+  struct table_element *element, dup;
+  uint32_t i, key;
+
+  START_TEST();
+  CHECK_TRUE(hash_table_is_empty(&table), "Table not empty");
+
+  key = 7;
+  CHECK_TRUE(hash_table_find(&table, &key) == NULL, "Found element in empty table");
+
+  for (i=0; i<10; i++) {
+    CHECK_TRUE(hash_table_insert(&table, &elements[i].node) == 0, "Could not insert %u", i);
+    CHECK_TRUE(hash_table_is_node_added(&elements[i].node), "Node %u not added", i);
+  }
+  CHECK_TRUE(table.count == 10, "Table has %u elements", table.count);
+
+  for (i=0; i<10; i++) {
+    key = i * 7;
+    element = hash_table_find_element(&table, &key, element, node);
+    CHECK_TRUE(element == &elements[i], "Could not find %u", key);
+  }
+
+  key = 8;
+  CHECK_TRUE(hash_table_find(&table, &key) == NULL, "Found non-existing key %u", key);
+
+  memset(&dup, 0, sizeof(dup));
+  dup.value = 14;
+  dup.node.key = &dup.value;
+  CHECK_TRUE(hash_table_insert(&table, &dup.node) != 0, "Duplicate was inserted");
+  CHECK_TRUE(!hash_table_is_node_added(&dup.node), "Duplicate was added");
+  CHECK_TRUE(table.count == 10, "Table has %u elements", table.count);
+
+  hash_table_remove(&table, &elements[2].node);
+  CHECK_TRUE(!hash_table_is_node_added(&elements[2].node), "Node 2 still added");
+  CHECK_TRUE(hash_table_find(&table, &elements[2].value) == NULL, "Found removed key");
+  CHECK_TRUE(hash_table_insert(&table, &dup.node) == 0, "Could not insert replacement");
+  element = hash_table_find_element(&table, &elements[2].value, element, node);
+  CHECK_TRUE(element == &dup, "Could not find replacement");
+
+  hash_table_remove(&table, &dup.node);
+  for (i=0; i<10; i++) {
+    if (i != 2) {
+      hash_table_remove(&table, &elements[i].node);
+    }
+  }
+  CHECK_TRUE(hash_table_is_empty(&table), "Table not empty");
+  CHECK_TRUE(table._slots == NULL && table._old_slots == NULL, "Slots not released");
+  END_TEST();
+}
+
+static void test_iteration(void) {
+  struct table_element *element, *ptr;
+  uint32_t i;
+
+  START_TEST();
+  for (i=0; i<100; i++) {
+    hash_table_insert(&table, &elements[i].node);
+  }
+
+  i = 0;
+  hash_table_for_each_element(&table, element, node) {
+    CHECK_TRUE(element == &elements[i], "Element %u is %u", i, element->value);
+    i++;
+  }
+  CHECK_TRUE(i == 100, "Iteration had %u elements", i);
+
+  element = hash_table_first_element(&table, element, node);
+  CHECK_TRUE(element == &elements[0], "Wrong first element");
+  element = hash_table_next_element(element, node);
+  CHECK_TRUE(element == &elements[1], "Wrong second element");
+  element = hash_table_last_element(&table, element, node);
+  CHECK_TRUE(element == &elements[99], "Wrong last element");
+
+  i = 0;
+  hash_table_for_each_element_safe(&table, element, node, ptr) {
+    hash_table_remove(&table, &element->node);
+    i++;
+  }
+  CHECK_TRUE(i == 100, "Safe iteration had %u elements", i);
+  CHECK_TRUE(hash_table_is_empty(&table), "Table not empty");
+  END_TEST();
+}
+
+static void test_rehash(void) {
+  struct table_element *element;
+  uint32_t i, j, errors, key;
+  bool rehashed;
+
+  START_TEST();
+
+  errors = 0;
+  rehashed = false;
+  for (i=0; i<COUNT; i++) {
+    if (hash_table_insert(&table, &elements[i].node)) {
+      errors++;
+    }
+    rehashed |= table._old_slots != NULL;
+
+    /* lookups must work while nodes are migrated */
+    j = rand() % (i+1);
+    element = hash_table_find_element(&table, &elements[j].value, element, node);
+    if (element != &elements[j]) {
+      errors++;
+    }
+  }
+  CHECK_TRUE(errors == 0, "%u errors while inserting", errors);
+  CHECK_TRUE(rehashed, "Table was never rehashed");
+  CHECK_TRUE(table.count == COUNT, "Table has %u elements", table.count);
+  CHECK_TRUE(table.count * 2 <= table._size, "Load factor too high (%u/%u)",
+      table.count, table._size);
+
+  /* remove every odd element */
+  for (i=1; i<COUNT; i+=2) {
+    hash_table_remove(&table, &elements[i].node);
+  }
+
+  for (i=0; i<COUNT; i++) {
+    element = hash_table_find_element(&table, &elements[i].value, element, node);
+    if (element != ((i & 1) ? NULL : &elements[i])) {
+      errors++;
+    }
+    key = elements[i].value + 1;
+    if (hash_table_find(&table, &key) != NULL) {
+      errors++;
+    }
+  }
+  CHECK_TRUE(errors == 0, "%u errors after removing", errors);
+  CHECK_TRUE(table.count == COUNT/2, "Table has %u elements", table.count);
+
+  for (i=0; i<COUNT; i+=2) {
+    hash_table_remove(&table, &elements[i].node);
+  }
+  CHECK_TRUE(hash_table_is_empty(&table), "Table not empty");
+  CHECK_TRUE(table._slots == NULL && table._old_slots == NULL, "Slots not released");
+  END_TEST();
+}
+
+static void test_reserve(void) {
+  struct hash_node **slots;
+  uint32_t i, errors;
+
+  START_TEST();
+
+  CHECK_TRUE(hash_table_reserve(&table) == 0, "Could not reserve empty table");
+  CHECK_TRUE(table._slots != NULL, "No slots after reserve");
+
+  errors = 0;
+  for (i=0; i<COUNT; i++) {
+    if (hash_table_reserve(&table)) {
+      errors++;
+    }
+
+    /* insert must use the reserved slot array */
+    slots = table._slots;
+    if (hash_table_insert(&table, &elements[i].node) || table._slots != slots) {
+      errors++;
+    }
+  }
+  CHECK_TRUE(errors == 0, "%u inserts did not use the reserved slots", errors);
+  CHECK_TRUE(table.count == COUNT, "Table has %u elements", table.count);
+
+  hash_table_free(&table);
+  END_TEST();
+}
+
+static void test_random(void) {
+  struct table_element *element;
+  struct avl_tree tree;
+  uint32_t i, j, errors;
+
+  START_TEST();
+  avl_init(&tree, avl_comp_uint32, false);
+  for (i=0; i<COUNT; i++) {
+    elements[i]._avl_node.key = &elements[i].value;
+  }
+
+  srand(42);
+  errors = 0;
+  for (i=0; i<COUNT*10; i++) {
+    j = rand() % COUNT;
+    if (hash_table_is_node_added(&elements[j].node)) {
+      hash_table_remove(&table, &elements[j].node);
+      avl_remove(&tree, &elements[j]._avl_node);
+    }
+    else {
+      if (hash_table_insert(&table, &elements[j].node)) {
+        errors++;
+      }
+      avl_insert(&tree, &elements[j]._avl_node);
+    }
+
+    if (table.count != tree.count) {
+      errors++;
+    }
+  }
+  CHECK_TRUE(errors == 0, "%u errors during random changes", errors);
+
+  /* compare with the avl tree */
+  for (i=0; i<COUNT; i++) {
+    element = hash_table_find_element(&table, &elements[i].value, element, node);
+    if (element != avl_find_element(&tree, &elements[i].value, element, _avl_node)) {
+      errors++;
+    }
+  }
+  CHECK_TRUE(errors == 0, "%u lookups differ from avl tree", errors);
+
+  hash_table_free(&table);
+  CHECK_TRUE(hash_table_is_empty(&table), "Table not empty");
+  for (i=0; i<COUNT; i++) {
+    if (hash_table_is_node_added(&elements[i].node)) {
+      errors++;
+    }
+  }
+  CHECK_TRUE(errors == 0, "%u nodes still added after free", errors);
+  END_TEST();
+}
+
+static void test_strcase(void) {
+  struct string_element names[3], *element;
+  struct hash_table strings;
+
+  START_TEST();
+  memset(names, 0, sizeof(names));
+  names[0].name = "interface";
+  names[1].name = "Layer2";
+  names[2].name = "LAYER2";
+
+  hash_table_init(&strings, hash_table_hash_strcase, avl_comp_strcasecmp);
+  names[0].node.key = names[0].name;
+  names[1].node.key = names[1].name;
+  names[2].node.key = names[2].name;
+
+  CHECK_TRUE(hash_table_insert(&strings, &names[0].node) == 0, "Could not insert %s", names[0].name);
+  CHECK_TRUE(hash_table_insert(&strings, &names[1].node) == 0, "Could not insert %s", names[1].name);
+  CHECK_TRUE(hash_table_insert(&strings, &names[2].node) != 0, "Case duplicate was inserted");
+
+  element = hash_table_find_element(&strings, "Interface", element, node);
+  CHECK_TRUE(element == &names[0], "Could not find 'Interface'");
+  element = hash_table_find_element(&strings, "layer2", element, node);
+  CHECK_TRUE(element == &names[1], "Could not find 'layer2'");
+  element = hash_table_find_element(&strings, "layer3", element, node);
+  CHECK_TRUE(element == NULL, "Found 'layer3'");
+
+  hash_table_free(&strings);
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  BEGIN_TESTING(clear_elements);
+
+  test_insert_find();
+  test_iteration();
+  test_rehash();
+  test_reserve();
+  test_random();
+  test_strcase();
+
+  return FINISH_TESTING();
+}
@@ -0,0 +1,262 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2013, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/netaddr.h"
+#include "common/netaddr_acl.h"
+#include "common/string.h"
+#include "cunit/cunit.h"
+
+/* number of prefixes and addresses for the comparison with linear checks */
+#define RANDOM_PREFIXES 500
+#define RANDOM_CHECKS   20000
+
+struct acl_check {
+  const char *addr;
+  bool accept;
+};
+
+static struct netaddr_acl acl;
+static struct strarray params;
+
+static void clear_elements(void) {
+  netaddr_acl_remove(&acl);
+  strarray_free(&params);
+}
+
+static int
+_create_acl(struct netaddr_acl *dst, const char **entries, size_t count) {
+  struct const_strarray value;
+  size_t i;
+
+  strarray_free(&params);
+  for (i=0; i<count; i++) {
+    if (strarray_append(&params, entries[i])) {
+      return -1;
+    }
+  }
+
+  value.value = params.value;
+  value.length = params.length;
+  return netaddr_acl_from_strarray(dst, &value);
+}
+
+static void
+_check_addresses(const char *test, struct netaddr_acl *a,
+    struct acl_check *checks, size_t count) {
+  struct netaddr addr;
+  size_t i;
+
+  for (i=0; i<count; i++) {
+    CHECK_NAMED_TRUE(netaddr_from_string(&addr, checks[i].addr) == 0,
+        test, __LINE__, "Could not parse %s", checks[i].addr);
+    CHECK_NAMED_TRUE(netaddr_acl_check_accept(a, &addr) == checks[i].accept,
+        test, __LINE__, "%s was %s", checks[i].addr,
+        checks[i].accept ? "rejected" : "accepted");
+  }
+}
+
+static void test_accept_first(void) {
+  const char *entries[] = {
+    "10.0.0.0/8", "-10.1.0.0/16", "+10.1.1.0/24", "-192.168.0.0/16",
+    "-172.16.0.0/12", "fd00::/8", "-fd00:1::/32", "10:00:00:00:00:0a",
+  };
+  struct acl_check checks[] = {
+    { "10.0.0.1", true },
+    { "172.16.0.1", false },
+    { "10.1.0.1", true },
+    { "10.1.1.1", true },
+    { "11.0.0.1", false },
+    { "192.168.1.1", false },
+    { "fd00::1", true },
+    { "fd00:1::1", true },
+    { "fe80::1", false },
+    { "10:00:00:00:00:0a", true },
+    { "10:00:00:00:00:0b", false },
+  };
+
+  START_TEST();
+  CHECK_TRUE(_create_acl(&acl, entries, ARRAYSIZE(entries)) == 0, "Could not create ACL");
+  CHECK_TRUE(acl._trie != NULL, "ACL has no trie");
+  _check_addresses(__func__, &acl, checks, ARRAYSIZE(checks));
+  END_TEST();
+}
+
+static void test_reject_first(void) {
+  const char *entries[] = {
+    ACL_FIRST_REJECT, ACL_DEFAULT_ACCEPT,
+    "10.0.0.0/8", "-10.1.0.0/16", "+10.1.1.0/24", "-10.2.3.4",
+    "-fd00:1::/32", "-198.51.100.0/24", "-203.0.113.0/24", "192.0.2.0/24",
+  };
+  struct acl_check checks[] = {
+    { "10.0.0.1", true },
+    { "10.1.0.1", false },
+    { "10.1.1.1", false },
+    { "10.2.3.4", false },
+    { "10.2.3.5", true },
+    { "11.0.0.1", true },
+    { "fd00::1", true },
+    { "fd00:1::1", false },
+    { "198.51.100.1", false },
+    { "192.0.2.1", true },
+  };
+
+  START_TEST();
+  CHECK_TRUE(_create_acl(&acl, entries, ARRAYSIZE(entries)) == 0, "Could not create ACL");
+  CHECK_TRUE(acl._trie != NULL, "ACL has no trie");
+  _check_addresses(__func__, &acl, checks, ARRAYSIZE(checks));
+  END_TEST();
+}
+
+static void test_default_route(void) {
+  const char *entries[] = {
+    ACL_FIRST_REJECT, "0.0.0.0/0", "-127.0.0.0/8", "-::/0", "+::1",
+    "-198.51.100.0/24", "-203.0.113.0/24", "192.0.2.0/24", "2001:db8::/32",
+  };
+  struct acl_check checks[] = {
+    { "1.2.3.4", true },
+    { "127.0.0.1", false },
+    { "::1", false },
+    { "::2", false },
+    { "203.0.113.1", false },
+    { "2001:db8::1", false },
+  };
+
+  START_TEST();
+  CHECK_TRUE(_create_acl(&acl, entries, ARRAYSIZE(entries)) == 0, "Could not create ACL");
+  CHECK_TRUE(acl._trie != NULL, "ACL has no trie");
+  _check_addresses(__func__, &acl, checks, ARRAYSIZE(checks));
+  END_TEST();
+}
+
+static void test_small_linear(void) {
+  const char *entries[] = {
+    ACL_FIRST_REJECT, "10.0.0.0/8", "-10.1.0.0/16", "fd00::/8",
+  };
+  struct acl_check checks[] = {
+    { "10.0.0.1", true },
+    { "10.1.0.1", false },
+    { "11.0.0.1", false },
+    { "fd00::1", true },
+  };
+
+  START_TEST();
+  CHECK_TRUE(_create_acl(&acl, entries, ARRAYSIZE(entries)) == 0, "Could not create ACL");
+  CHECK_TRUE(acl._trie == NULL, "Small ACL has a trie");
+  _check_addresses(__func__, &acl, checks, ARRAYSIZE(checks));
+  END_TEST();
+}
+
+static void test_random_against_linear(void) {
+  struct netaddr_acl copy, linear;
+  struct netaddr_str nbuf;
+  struct netaddr addr;
+  char buf[RANDOM_PREFIXES][32];
+  const char *entries[RANDOM_PREFIXES + 1];
+  uint8_t bin[4];
+  size_t i, j, errors;
+  bool result;
+
+  START_TEST();
+
+  srand(42);
+
+  /* random IPv4 prefixes, nested and overlapping */
+  entries[0] = ACL_FIRST_REJECT;
+  for (i=0; i<RANDOM_PREFIXES; i++) {
+    for (j=0; j<sizeof(bin); j++) {
+      bin[j] = (rand() % 4) * 64;
+    }
+    CHECK_TRUE(netaddr_from_binary_prefix(&addr, bin, sizeof(bin), AF_INET, rand() % 33) == 0,
+        "Could not create prefix");
+    snprintf(buf[i], sizeof(buf[i]), "%s%s",
+        (rand() % 2) ? "-" : "", netaddr_to_string(&nbuf, &addr));
+    entries[i+1] = buf[i];
+  }
+
+  CHECK_TRUE(_create_acl(&acl, entries, ARRAYSIZE(entries)) == 0, "Could not create ACL");
+
+  memset(&copy, 0, sizeof(copy));
+  CHECK_TRUE(netaddr_acl_copy(&copy, &acl) == 0, "Could not copy ACL");
+
+  /* same ACL without trie */
+  memcpy(&linear, &acl, sizeof(linear));
+  linear._trie = NULL;
+
+  errors = 0;
+  for (i=0; i<RANDOM_CHECKS; i++) {
+    for (j=0; j<sizeof(bin); j++) {
+      bin[j] = (rand() % 4) * 64 + (rand() % 2);
+    }
+    if (netaddr_from_binary(&addr, bin, sizeof(bin), AF_INET)) {
+      errors++;
+      continue;
+    }
+
+    result = netaddr_acl_check_accept(&linear, &addr);
+    if (netaddr_acl_check_accept(&acl, &addr) != result
+        || netaddr_acl_check_accept(&copy, &addr) != result) {
+      errors++;
+    }
+  }
+  CHECK_TRUE(errors == 0, "%"PRINTF_SIZE_T_SPECIFIER" of %d checks differ from linear ACL check",
+      errors, RANDOM_CHECKS);
+
+  netaddr_acl_remove(&copy);
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  BEGIN_TESTING(clear_elements);
+
+  test_accept_first();
+  test_reject_first();
+  test_default_route();
+  test_small_linear();
+  test_random_against_linear();
+
+  return FINISH_TESTING();
+}
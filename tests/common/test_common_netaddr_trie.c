@@ -0,0 +1,337 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2013, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/netaddr.h"
+#include "common/netaddr_trie.h"
+#include "cunit/cunit.h"
+
+/* number of random prefixes for the comparison with linear lookups */
+#define RANDOM_COUNT 1000
+
+struct trie_element {
+  struct netaddr prefix;
+  struct netaddr_trie_node node;
+};
+
+static struct netaddr_trie trie;
+
+static const char *prefixes[] = {
+  "10.0.0.0/8", "10.1.0.0/16", "10.1.1.0/24", "10.1.1.1",
+  "10.128.0.0/9", "192.168.0.0/16", "0.0.0.0/0",
+  "fd00::/8", "fd00:1::/32", "fe80::1", "10:00:00:00:00:0a",
+};
+
+/* same prefixes in trie order */
+static const char *sorted[] = {
+  "0.0.0.0/0", "10.0.0.0/8", "10.1.0.0/16", "10.1.1.0/24", "10.1.1.1",
+  "10.128.0.0/9", "192.168.0.0/16",
+  "fd00::/8", "fd00:1::/32", "fe80::1", "10:00:00:00:00:0a",
+};
+
+static struct trie_element elements[ARRAYSIZE(prefixes)];
+static struct trie_element random_elements[RANDOM_COUNT];
+
+static void clear_elements(void) {
+  memset(elements, 0, sizeof(elements));
+  memset(random_elements, 0, sizeof(random_elements));
+  netaddr_trie_init(&trie);
+}
+
+static void
+_add_elements(void) {
+  size_t i;
+
+  for (i=0; i<ARRAYSIZE(prefixes); i++) {
+    CHECK_TRUE(netaddr_from_string(&elements[i].prefix, prefixes[i]) == 0,
+        "Could not parse %s", prefixes[i]);
+    elements[i].node.key = &elements[i].prefix;
+    CHECK_TRUE(netaddr_trie_insert(&trie, &elements[i].node) == 0,
+        "Could not insert %s", prefixes[i]);
+  }
+}
+
+static void
+_remove_elements(void) {
+  size_t i;
+
+  for (i=0; i<ARRAYSIZE(prefixes); i++) {
+    netaddr_trie_remove(&trie, &elements[i].node);
+  }
+  CHECK_TRUE(netaddr_trie_is_empty(&trie), "Trie not empty");
+  CHECK_TRUE(trie._free_glue == NULL, "Trie still has internal nodes");
+}
+
+static struct trie_element *
+_find_lpm(const char *str) {
+  struct trie_element *element;
+  struct netaddr addr;
+
+  if (netaddr_from_string(&addr, str)) {
+    return NULL;
+  }
+  return netaddr_trie_find_lpm_element(&trie, &addr, element, node);
+}
+
+static void test_insert_find(void) {
+  struct trie_element *element, dup;
+  struct netaddr addr;
+  size_t i;
+
+  START_TEST();
+  _add_elements();
+
+  CHECK_TRUE(trie.count == ARRAYSIZE(prefixes), "Trie has %u elements", trie.count);
+
+  for (i=0; i<ARRAYSIZE(prefixes); i++) {
+    element = netaddr_trie_find_element(&trie, &elements[i].prefix, element, node);
+    CHECK_TRUE(element == &elements[i], "Could not find %s", prefixes[i]);
+  }
+
+  /* internal nodes are not part of the result */
+  CHECK_TRUE(netaddr_from_string(&addr, "10.0.0.0/7") == 0, "Could not parse prefix");
+  CHECK_TRUE(netaddr_trie_find(&trie, &addr) == NULL, "Found 10.0.0.0/7");
+  CHECK_TRUE(netaddr_from_string(&addr, "10.0.0.0/1") == 0, "Could not parse prefix");
+  CHECK_TRUE(netaddr_trie_find(&trie, &addr) == NULL, "Found 10.0.0.0/1");
+  CHECK_TRUE(netaddr_from_string(&addr, "fd00::/16") == 0, "Could not parse prefix");
+  CHECK_TRUE(netaddr_trie_find(&trie, &addr) == NULL, "Found fd00::/16");
+
+  /* duplicates are rejected */
+  memset(&dup, 0, sizeof(dup));
+  memcpy(&dup.prefix, &elements[2].prefix, sizeof(dup.prefix));
+  dup.node.key = &dup.prefix;
+  CHECK_TRUE(netaddr_trie_insert(&trie, &dup.node) != 0, "Duplicate was inserted");
+  CHECK_TRUE(trie.count == ARRAYSIZE(prefixes), "Trie has %u elements", trie.count);
+
+  _remove_elements();
+  END_TEST();
+}
+
+static void test_lpm(void) {
+  struct trie_element *element;
+
+  START_TEST();
+  _add_elements();
+
+  element = _find_lpm("10.1.1.1");
+  CHECK_TRUE(element == &elements[3], "Wrong LPM for 10.1.1.1");
+  element = _find_lpm("10.1.1.2");
+  CHECK_TRUE(element == &elements[2], "Wrong LPM for 10.1.1.2");
+  element = _find_lpm("10.1.2.1");
+  CHECK_TRUE(element == &elements[1], "Wrong LPM for 10.1.2.1");
+  element = _find_lpm("10.2.0.1");
+  CHECK_TRUE(element == &elements[0], "Wrong LPM for 10.2.0.1");
+  element = _find_lpm("10.200.0.1");
+  CHECK_TRUE(element == &elements[4], "Wrong LPM for 10.200.0.1");
+  element = _find_lpm("11.0.0.1");
+  CHECK_TRUE(element == &elements[6], "Wrong LPM for 11.0.0.1");
+  element = _find_lpm("10.1.0.0/20");
+  CHECK_TRUE(element == &elements[1], "Wrong covering prefix for 10.1.0.0/20");
+
+  element = _find_lpm("fd00:1:2::1");
+  CHECK_TRUE(element == &elements[8], "Wrong LPM for fd00:1:2::1");
+  element = _find_lpm("fd00:2::1");
+  CHECK_TRUE(element == &elements[7], "Wrong LPM for fd00:2::1");
+  element = _find_lpm("fe80::2");
+  CHECK_TRUE(element == NULL, "Wrong LPM for fe80::2");
+  element = _find_lpm("10:00:00:00:00:0a");
+  CHECK_TRUE(element == &elements[10], "Wrong LPM for MAC");
+
+  _remove_elements();
+  END_TEST();
+}
+
+static void test_iteration(void) {
+  struct trie_element *element, *ptr;
+  struct netaddr_str nbuf;
+  struct netaddr prefix;
+  size_t i;
+
+  START_TEST();
+  _add_elements();
+
+  i = 0;
+  netaddr_trie_for_each_element(&trie, element, node) {
+    CHECK_TRUE(i < ARRAYSIZE(sorted)
+        && strcmp(netaddr_to_string(&nbuf, &element->prefix), sorted[i]) == 0,
+        "Element %"PRINTF_SIZE_T_SPECIFIER" is %s", i, nbuf.buf);
+    i++;
+  }
+  CHECK_TRUE(i == ARRAYSIZE(sorted), "Iteration had %"PRINTF_SIZE_T_SPECIFIER" elements", i);
+
+  /* subtree of 10.1.0.0/16 */
+  CHECK_TRUE(netaddr_from_string(&prefix, "10.1.0.0/16") == 0, "Could not parse prefix");
+  i = 0;
+  netaddr_trie_for_each_element_in_subtree(&trie, &prefix, element, node) {
+    CHECK_TRUE(element == &elements[1+i], "Subtree element %"PRINTF_SIZE_T_SPECIFIER" is %s",
+        i, netaddr_to_string(&nbuf, &element->prefix));
+    i++;
+  }
+  CHECK_TRUE(i == 3, "Subtree had %"PRINTF_SIZE_T_SPECIFIER" elements", i);
+
+  /* subtree prefix that is not part of the trie */
+  CHECK_TRUE(netaddr_from_string(&prefix, "fd00::/16") == 0, "Could not parse prefix");
+  i = 0;
+  netaddr_trie_for_each_element_in_subtree(&trie, &prefix, element, node) {
+    CHECK_TRUE(element == &elements[8], "Subtree element is %s",
+        netaddr_to_string(&nbuf, &element->prefix));
+    i++;
+  }
+  CHECK_TRUE(i == 1, "Subtree of fd00::/16 had %"PRINTF_SIZE_T_SPECIFIER" elements", i);
+
+  CHECK_TRUE(netaddr_from_string(&prefix, "10.0.0.0/7") == 0, "Could not parse prefix");
+  i = 0;
+  netaddr_trie_for_each_element_in_subtree(&trie, &prefix, element, node) {
+    i++;
+  }
+  CHECK_TRUE(i == 5, "Subtree of 10.0.0.0/7 had %"PRINTF_SIZE_T_SPECIFIER" elements", i);
+
+  /* remove everything during iteration */
+  i = 0;
+  netaddr_trie_for_each_element_safe(&trie, element, node, ptr) {
+    netaddr_trie_remove(&trie, &element->node);
+    i++;
+  }
+  CHECK_TRUE(i == ARRAYSIZE(sorted), "Safe iteration had %"PRINTF_SIZE_T_SPECIFIER" elements", i);
+  CHECK_TRUE(netaddr_trie_is_empty(&trie), "Trie not empty");
+  CHECK_TRUE(trie._free_glue == NULL, "Trie still has internal nodes");
+  END_TEST();
+}
+
+static void test_random(void) {
+  struct trie_element *element, *best;
+  struct netaddr addr;
+  uint8_t bin[4];
+  size_t i, j, count, errors;
+
+  START_TEST();
+
+  srand(23);
+  count = 0;
+  for (i=0; i<RANDOM_COUNT; i++) {
+    for (j=0; j<sizeof(bin); j++) {
+      bin[j] = (rand() % 4) * 64;
+    }
+    netaddr_from_binary_prefix(&random_elements[i].prefix, bin, sizeof(bin), AF_INET, rand() % 33);
+    random_elements[i].node.key = &random_elements[i].prefix;
+
+    if (netaddr_trie_insert(&trie, &random_elements[i].node) == 0) {
+      count++;
+    }
+    else {
+      /* mark duplicate as unused */
+      random_elements[i].node.key = NULL;
+    }
+  }
+  CHECK_TRUE(trie.count == count, "Trie has %u elements, should have %"PRINTF_SIZE_T_SPECIFIER,
+      trie.count, count);
+
+  /* remove every third element */
+  for (i=0; i<RANDOM_COUNT; i+=3) {
+    if (random_elements[i].node.key != NULL) {
+      netaddr_trie_remove(&trie, &random_elements[i].node);
+      random_elements[i].node.key = NULL;
+      count--;
+    }
+  }
+  CHECK_TRUE(trie.count == count, "Trie has %u elements, should have %"PRINTF_SIZE_T_SPECIFIER,
+      trie.count, count);
+
+  i = 0;
+  netaddr_trie_for_each_element(&trie, element, node) {
+    i++;
+  }
+  CHECK_TRUE(i == count, "Iteration had %"PRINTF_SIZE_T_SPECIFIER" elements", i);
+
+  /* compare lookups with a linear search */
+  errors = 0;
+  for (i=0; i<RANDOM_COUNT; i++) {
+    for (j=0; j<sizeof(bin); j++) {
+      bin[j] = (rand() % 4) * 64 + (rand() % 2);
+    }
+    netaddr_from_binary(&addr, bin, sizeof(bin), AF_INET);
+
+    best = NULL;
+    for (j=0; j<RANDOM_COUNT; j++) {
+      if (random_elements[j].node.key != NULL
+          && netaddr_is_in_subnet(&random_elements[j].prefix, &addr)
+          && (best == NULL || netaddr_get_prefix_length(&best->prefix)
+              < netaddr_get_prefix_length(&random_elements[j].prefix))) {
+        best = &random_elements[j];
+      }
+    }
+
+    if (netaddr_trie_find_lpm_element(&trie, &addr, element, node) != best) {
+      errors++;
+    }
+  }
+  CHECK_TRUE(errors == 0, "%"PRINTF_SIZE_T_SPECIFIER" lookups differ from linear search", errors);
+
+  for (i=0; i<RANDOM_COUNT; i++) {
+    if (random_elements[i].node.key != NULL) {
+      element = netaddr_trie_find_element(&trie, &random_elements[i].prefix, element, node);
+      if (element != &random_elements[i]) {
+        errors++;
+      }
+      netaddr_trie_remove(&trie, &random_elements[i].node);
+    }
+  }
+  CHECK_TRUE(errors == 0, "%"PRINTF_SIZE_T_SPECIFIER" prefixes not found", errors);
+  CHECK_TRUE(netaddr_trie_is_empty(&trie), "Trie not empty");
+  CHECK_TRUE(trie._free_glue == NULL, "Trie still has internal nodes");
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  BEGIN_TESTING(clear_elements);
+
+  test_insert_find();
+  test_lpm();
+  test_iteration();
+  test_random();
+
+  return FINISH_TESTING();
+}
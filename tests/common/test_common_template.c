@@ -0,0 +1,134 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2013, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "common/autobuf.h"
+#include "common/template.h"
+#include "cunit/cunit.h"
+
+static struct autobuf out;
+
+static struct abuf_template_data data[] = {
+  { .key = "name" },
+  { .key = "value" },
+  { .key = "flag" },
+};
+
+static void clear_elements(void) {
+  abuf_clear(&out);
+  data[0].value = NULL;
+  data[1].value = NULL;
+  data[2].value = NULL;
+}
+
+static void test_template(void) {
+  struct abuf_template_storage *storage;
+  const char *format = "%name%=%value% (%unknown%) 100\\% %flag%.";
+
+  START_TEST();
+  data[0].value = "eth0";
+  data[1].value = "42";
+  data[2].value = NULL;
+
+  storage = abuf_template_init(data, ARRAYSIZE(data), format);
+  CHECK_TRUE(storage != NULL, "Could not initialize template");
+  if (storage) {
+    CHECK_TRUE(storage->count == 3, "Template has %"PRINTF_SIZE_T_SPECIFIER" keys", storage->count);
+    CHECK_TRUE(storage->format_length == strlen(format), "Wrong format length %"PRINTF_SIZE_T_SPECIFIER,
+        storage->format_length);
+
+    CHECK_TRUE(abuf_add_template(&out, format, storage) == 0, "Could not render template");
+    CHECK_TRUE(strcmp(abuf_getptr(&out), "eth0=42 (%unknown%) 100\\% .") == 0,
+        "Wrong template output: '%s'", abuf_getptr(&out));
+
+    /* render again with new values */
+    abuf_clear(&out);
+    data[1].value = "43";
+    data[2].value = "true";
+    CHECK_TRUE(abuf_add_template(&out, format, storage) == 0, "Could not render template");
+    CHECK_TRUE(strcmp(abuf_getptr(&out), "eth0=43 (%unknown%) 100\\% true.") == 0,
+        "Wrong template output: '%s'", abuf_getptr(&out));
+    free(storage);
+  }
+  END_TEST();
+}
+
+static void test_json(void) {
+  const char *expected =
+      "  {\n"
+      "      \"name\" : \"a\\\"b\\\\c\\u000a\\u007fd\",\n"
+      "      \"flag\" : 0\n"
+      "  }\n";
+
+  START_TEST();
+  data[0].value = "a\"b\\c\n\177d";
+  data[0].string = true;
+  data[2].value = "";
+  data[2].string = false;
+
+  CHECK_TRUE(abuf_add_json(&out, "  ", data, ARRAYSIZE(data)) == 0, "Could not generate JSON");
+  CHECK_TRUE(strcmp(abuf_getptr(&out), expected) == 0,
+      "Wrong JSON output: '%s'", abuf_getptr(&out));
+
+  abuf_clear(&out);
+  data[0].value = NULL;
+  data[2].value = NULL;
+  CHECK_TRUE(abuf_add_json(&out, "", data, ARRAYSIZE(data)) == 0, "Could not generate JSON");
+  CHECK_TRUE(strcmp(abuf_getptr(&out), "{\n}\n") == 0,
+      "Wrong JSON output: '%s'", abuf_getptr(&out));
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  abuf_init(&out);
+  BEGIN_TESTING(clear_elements);
+
+  test_template();
+  test_json();
+
+  abuf_free(&out);
+  return FINISH_TESTING();
+}
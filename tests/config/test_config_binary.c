@@ -0,0 +1,296 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2013, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/autobuf.h"
+#include "common/common_types.h"
+#include "common/string.h"
+#include "config/cfg_binary.h"
+#include "config/cfg_db.h"
+
+#include "cunit/cunit.h"
+
+/*
+ * configuration used for the round trip tests in compact text format,
+ * cfg_db_add_entry() puts new list values in front
+ */
+static const char COMPACT_CONFIG[] =
+    "[global]\n"
+    "\tfork no\n"
+    "\tplugin cfgio_file\n"
+    "\tplugin cfgparser_binary\n"
+    "[interface]\n"
+    "\tbindto -::1\n"
+    "\tbindto -127.0.0.1/8\n"
+    "[interface=eth0]\n"
+    "\tbindto 10.0.0.0/8\n"
+    "\tport 269\n"
+    "[interface=eth1]\n"
+    "\tport 270\n"
+    "[log]\n";
+
+static struct cfg_db *db = NULL;
+static struct autobuf out, text1, text2;
+
+static void
+clear_elements(void) {
+  if (db) {
+    cfg_db_remove(db);
+  }
+  db = cfg_db_add();
+
+  cfg_db_add_entry(db, "global", NULL, "fork", "no");
+  cfg_db_add_entry(db, "global", NULL, "plugin", "cfgparser_binary");
+  cfg_db_add_entry(db, "global", NULL, "plugin", "cfgio_file");
+  cfg_db_add_entry(db, "interface", NULL, "bindto", "-127.0.0.1/8");
+  cfg_db_add_entry(db, "interface", NULL, "bindto", "-::1");
+  cfg_db_add_entry(db, "interface", "eth0", "bindto", "10.0.0.0/8");
+  cfg_db_add_entry(db, "interface", "eth0", "port", "269");
+  cfg_db_add_entry(db, "interface", "eth1", "port", "270");
+  cfg_db_add_unnamedsection(db, "log");
+
+  abuf_clear(&out);
+  abuf_clear(&text1);
+  abuf_clear(&text2);
+}
+
+/**
+ * Write a database in compact text format
+ * @param dst target buffer
+ * @param src configuration database
+ */
+static void
+_to_compact(struct autobuf *dst, struct cfg_db *src) {
+  struct cfg_section_type *section, *s_it;
+  struct cfg_named_section *name, *n_it;
+  struct cfg_entry *entry, *e_it;
+  char *ptr;
+
+  CFG_FOR_ALL_SECTION_TYPES(src, section, s_it) {
+    CFG_FOR_ALL_SECTION_NAMES(section, name, n_it) {
+      if (cfg_db_is_named_section(name)) {
+        abuf_appendf(dst, "[%s=%s]\n", section->type, name->name);
+      }
+      else {
+        abuf_appendf(dst, "[%s]\n", section->type);
+      }
+
+      CFG_FOR_ALL_ENTRIES(name, entry, e_it) {
+        strarray_for_each_element(&entry->val, ptr) {
+          abuf_appendf(dst, "\t%s %s\n", entry->name, ptr);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Count the occurrences of a string in a buffer
+ * @param buf pointer to buffer
+ * @param len length of buffer
+ * @param str zero terminated string
+ * @return number of occurrences
+ */
+static int
+_count_string(const char *buf, size_t len, const char *str) {
+  size_t i, str_len;
+  int count;
+
+  str_len = strlen(str) + 1;
+  count = 0;
+  for (i=0; i + str_len <= len; i++) {
+    if (memcmp(buf + i, str, str_len) == 0) {
+      count++;
+    }
+  }
+  return count;
+}
+
+static void
+test_roundtrip(void) {
+  struct cfg_db *db2;
+
+  START_TEST();
+
+  _to_compact(&text1, db);
+  CHECK_TRUE(strcmp(abuf_getptr(&text1), COMPACT_CONFIG) == 0,
+      "Unexpected compact text:\n%s", abuf_getptr(&text1));
+
+  CHECK_TRUE(cfg_binary_serialize(&out, db, NULL) == 0, "Serialization failed");
+  CHECK_TRUE(cfg_binary_is_snapshot(abuf_getptr(&out), abuf_getlen(&out)),
+      "Snapshot header not recognized");
+
+  db2 = cfg_binary_parse(abuf_getptr(&out), abuf_getlen(&out), NULL);
+  CHECK_TRUE(db2 != NULL, "Parsing of snapshot failed");
+  if (db2) {
+    _to_compact(&text2, db2);
+    CHECK_TRUE(strcmp(abuf_getptr(&text2), COMPACT_CONFIG) == 0,
+        "Round trip changed configuration:\n%s", abuf_getptr(&text2));
+    CHECK_TRUE(cfg_db_find_namedsection(db2, "log", NULL) != NULL,
+        "Empty section was lost");
+    cfg_db_remove(db2);
+  }
+
+  END_TEST();
+}
+
+static void
+test_roundtrip_empty(void) {
+  struct cfg_db *db2;
+
+  START_TEST();
+
+  cfg_db_remove(db);
+  db = cfg_db_add();
+
+  CHECK_TRUE(cfg_binary_serialize(&out, db, NULL) == 0, "Serialization failed");
+  CHECK_TRUE(abuf_getlen(&out) == CFG_BINARY_HEADER_LENGTH,
+      "Empty snapshot has %" PRINTF_SIZE_T_SPECIFIER " bytes", abuf_getlen(&out));
+
+  db2 = cfg_binary_parse(abuf_getptr(&out), abuf_getlen(&out), NULL);
+  CHECK_TRUE(db2 != NULL, "Parsing of snapshot failed");
+  if (db2) {
+    CHECK_TRUE(db2->sectiontypes.count == 0, "Empty snapshot has sections");
+    cfg_db_remove(db2);
+  }
+
+  END_TEST();
+}
+
+static void
+test_string_table(void) {
+  START_TEST();
+
+  CHECK_TRUE(cfg_binary_serialize(&out, db, NULL) == 0, "Serialization failed");
+
+  /* section types and keys are stored only once */
+  CHECK_TRUE(_count_string(abuf_getptr(&out), abuf_getlen(&out), "interface") == 1,
+      "Section type stored more than once");
+  CHECK_TRUE(_count_string(abuf_getptr(&out), abuf_getlen(&out), "bindto") == 1,
+      "Key stored more than once");
+  CHECK_TRUE(_count_string(abuf_getptr(&out), abuf_getlen(&out), "port") == 1,
+      "Key stored more than once");
+
+  END_TEST();
+}
+
+static void
+test_corrupt_snapshot(void) {
+  struct cfg_db *db2;
+  char *copy;
+  size_t len, i;
+  bool all_rejected;
+
+  START_TEST();
+
+  CHECK_TRUE(cfg_binary_serialize(&out, db, NULL) == 0, "Serialization failed");
+  len = abuf_getlen(&out);
+
+  copy = malloc(len);
+  CHECK_TRUE(copy != NULL, "Out of memory");
+  if (copy == NULL) {
+    END_TEST();
+    return;
+  }
+
+  /* every truncated snapshot must be rejected */
+  all_rejected = true;
+  for (i=0; i<len; i++) {
+    memcpy(copy, abuf_getptr(&out), i);
+    db2 = cfg_binary_parse(copy, i, &text1);
+    if (db2) {
+      all_rejected = false;
+      cfg_db_remove(db2);
+    }
+  }
+  CHECK_TRUE(all_rejected, "Truncated snapshot was accepted");
+
+  /* wrong magic */
+  memcpy(copy, abuf_getptr(&out), len);
+  copy[0] = 'X';
+  db2 = cfg_binary_parse(copy, len, &text1);
+  CHECK_TRUE(db2 == NULL, "Snapshot with wrong magic was accepted");
+
+  /* unknown version */
+  memcpy(copy, abuf_getptr(&out), len);
+  copy[5] = CFG_BINARY_VERSION + 1;
+  db2 = cfg_binary_parse(copy, len, &text1);
+  CHECK_TRUE(db2 == NULL, "Snapshot with unknown version was accepted");
+
+  /* string reference of first section type outside of string table */
+  memcpy(copy, abuf_getptr(&out), len);
+  i = CFG_BINARY_HEADER_LENGTH + ntohl(*(uint32_t *)(copy + 8));
+  memset(copy + i, 0x7f, 4);
+  db2 = cfg_binary_parse(copy, len, &text1);
+  CHECK_TRUE(db2 == NULL, "Snapshot with illegal string reference was accepted");
+
+  if (db2) {
+    cfg_db_remove(db2);
+  }
+  free(copy);
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  abuf_init(&out);
+  abuf_init(&text1);
+  abuf_init(&text2);
+
+  BEGIN_TESTING(clear_elements);
+
+  test_roundtrip();
+  test_roundtrip_empty();
+  test_string_table();
+  test_corrupt_snapshot();
+
+  abuf_free(&out);
+  abuf_free(&text1);
+  abuf_free(&text2);
+  if (db) {
+    cfg_db_remove(db);
+  }
+
+  return FINISH_TESTING();
+}
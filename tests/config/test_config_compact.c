@@ -0,0 +1,203 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2013, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/autobuf.h"
+#include "common/common_types.h"
+#include "config/cfg_db.h"
+#include "config/cfg_parser.h"
+
+#include "cfgparser_compact/cfgparser_compact.h"
+
+#include "cunit/cunit.h"
+
+static struct cfg_db *db_const = NULL, *db_copy = NULL;
+static struct autobuf out, text1, text2;
+
+static void
+clear_elements(void) {
+  if (db_const) {
+    cfg_db_remove(db_const);
+    db_const = NULL;
+  }
+  if (db_copy) {
+    cfg_db_remove(db_copy);
+    db_copy = NULL;
+  }
+  abuf_clear(&out);
+  abuf_clear(&text1);
+  abuf_clear(&text2);
+}
+
+/**
+ * Parse a buffer with the read-only parser and with the
+ * in-place parser (working on a copy)
+ * @param src pointer to buffer
+ * @param len length of buffer
+ */
+static void
+_parse_both(const char *src, size_t len) {
+  char *copy;
+
+  db_const = cfg_parser_compact.parse_const(src, len, &out);
+
+  /* the in-place parser needs a zero byte behind the buffer */
+  copy = calloc(1, len + 1);
+  if (copy) {
+    memcpy(copy, src, len);
+    db_copy = cfg_parser_compact.parse(copy, len, &out);
+    free(copy);
+  }
+}
+
+static void
+test_parse_const(void) {
+  static const char CONFIG[] =
+      "# comment\n"
+      "[global]\n"
+      "\tfork no\r\n"
+      "\n"
+      "[interface=eth0]\n"
+      "  port 269  \n"
+      "\tbindto 10.0.0.0/8\n"
+      "[out]\n"
+      "\tinfo all";
+  const struct const_strarray *value;
+
+  START_TEST();
+
+  _parse_both(CONFIG, sizeof(CONFIG) - 1);
+  CHECK_TRUE(db_const != NULL, "read-only parser failed: %s", abuf_getptr(&out));
+  CHECK_TRUE(db_copy != NULL, "in-place parser failed: %s", abuf_getptr(&out));
+  if (db_const == NULL || db_copy == NULL) {
+    END_TEST();
+    return;
+  }
+
+  value = cfg_db_get_entry_value(db_const, "global", NULL, "fork");
+  CHECK_TRUE(value != NULL && strcmp(value->value, "no") == 0,
+      "\\r\\n line ending was not removed");
+  value = cfg_db_get_entry_value(db_const, "interface", "eth0", "port");
+  CHECK_TRUE(value != NULL && strcmp(value->value, "269") == 0,
+      "whitespace was not trimmed");
+  value = cfg_db_get_entry_value(db_const, "out", NULL, "info");
+  CHECK_TRUE(value != NULL && strcmp(value->value, "all") == 0,
+      "last line without line ending was not parsed");
+
+  cfg_parser_compact.serialize(&text1, db_const, &out);
+  cfg_parser_compact.serialize(&text2, db_copy, &out);
+  CHECK_TRUE(strcmp(abuf_getptr(&text1), abuf_getptr(&text2)) == 0,
+      "parsers differ:\n%s\n%s", abuf_getptr(&text1), abuf_getptr(&text2));
+  END_TEST();
+}
+
+static void
+test_parse_const_zero_byte(void) {
+  /* a zero byte ends the line, the rest is a new line */
+  static const char CONFIG[] =
+      "[global]\n"
+      "\tfork no\0\tplugin cfgio_file\n"
+      "\tfailfast yes\n";
+  const struct const_strarray *value;
+
+  START_TEST();
+
+  _parse_both(CONFIG, sizeof(CONFIG) - 1);
+  CHECK_TRUE(db_const != NULL, "read-only parser failed: %s", abuf_getptr(&out));
+  CHECK_TRUE(db_copy != NULL, "in-place parser failed: %s", abuf_getptr(&out));
+  if (db_const == NULL || db_copy == NULL) {
+    END_TEST();
+    return;
+  }
+
+  value = cfg_db_get_entry_value(db_const, "global", NULL, "fork");
+  CHECK_TRUE(value != NULL && strcmp(value->value, "no") == 0,
+      "entry before zero byte is wrong");
+  value = cfg_db_get_entry_value(db_const, "global", NULL, "plugin");
+  CHECK_TRUE(value != NULL && strcmp(value->value, "cfgio_file") == 0,
+      "entry behind zero byte was dropped");
+
+  cfg_parser_compact.serialize(&text1, db_const, &out);
+  cfg_parser_compact.serialize(&text2, db_copy, &out);
+  CHECK_TRUE(strcmp(abuf_getptr(&text1), abuf_getptr(&text2)) == 0,
+      "parsers differ:\n%s\n%s", abuf_getptr(&text1), abuf_getptr(&text2));
+  END_TEST();
+}
+
+static void
+test_key_only(void) {
+  /* the value must not be taken from the next line */
+  static const char CONFIG[] =
+      "[global]\n"
+      "\tfork\n"
+      "\tplugin cfgio_file\n";
+
+  START_TEST();
+
+  _parse_both(CONFIG, sizeof(CONFIG) - 1);
+  CHECK_TRUE(db_const == NULL, "read-only parser accepted entry without value");
+  CHECK_TRUE(db_copy == NULL, "in-place parser accepted entry without value");
+  CHECK_TRUE(strstr(abuf_getptr(&out), "No second token found") != NULL
+      && strstr(abuf_getptr(&out), "plugin") == NULL,
+      "Wrong error message: %s", abuf_getptr(&out));
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  abuf_init(&out);
+  abuf_init(&text1);
+  abuf_init(&text2);
+
+  BEGIN_TESTING(clear_elements);
+
+  test_parse_const();
+  test_parse_const_zero_byte();
+  test_key_only();
+
+  abuf_free(&text2);
+  abuf_free(&text1);
+  abuf_free(&out);
+  return FINISH_TESTING();
+}
@@ -491,6 +491,69 @@ handler_modify_two_sections(void) {
   }
 }
 
+static void handler_dirty_section(void);
+
+static void
+test_delta_dirty_section(void) {
+  START_TEST();
+
+  handler_1.cb_delta_handler = handler_dirty_section;
+
+  cfg_db_add_entry(db_pre, SECTION_TYPE_1, NAME_1, KEY_1, value_1.value);
+  cfg_db_add_entry(db_pre, SECTION_TYPE_1, NAME_2, KEY_2, value_2.value);
+
+  /* change of first section is not tracked */
+  cfg_db_add_entry(db_post, SECTION_TYPE_1, NAME_1, KEY_1, value_2.value);
+  cfg_db_add_entry(db_post, SECTION_TYPE_1, NAME_2, KEY_2, value_2.value);
+
+  CHECK_TRUE(cfg_db_is_clean(db_post), "Untracked db is dirty");
+
+  cfg_db_track_changes(db_post, true);
+  cfg_db_overwrite_entry(db_post, SECTION_TYPE_1, NAME_2, KEY_2, value_3.value);
+
+  CHECK_TRUE(!cfg_db_is_clean(db_post), "Tracked db is clean after change");
+  CHECK_TRUE(db_post->dirty.count == 1, "%u sections are dirty", db_post->dirty.count);
+
+  CHECK_TRUE(cfg_schema_handle_db_dirty_changes(db_pre, db_post, db_post) == 0,
+      "delta calculation failed");
+  CHECK_TRUE(callback_counter == 1, "Callback counter was called %d times", callback_counter);
+
+  cfg_db_clear_dirty(db_post);
+  CHECK_TRUE(cfg_db_is_clean(db_post), "db is dirty after clear");
+
+  /* without dirty sections nothing is compared */
+  callback_counter = 0;
+  CHECK_TRUE(cfg_schema_handle_db_dirty_changes(db_pre, db_post, db_post) == 0,
+      "delta calculation failed");
+  CHECK_TRUE(callback_counter == 0, "Callback counter was called %d times", callback_counter);
+  END_TEST();
+}
+
+static void
+handler_dirty_section(void) {
+  callback_counter++;
+
+  CHECK_TRUE(callback_counter == 1, "Callback was called %d times!", callback_counter);
+  if (callback_counter > 1) {
+    return;
+  }
+  CHECK_TRUE(handler_1.pre != NULL, "No pre named-section found.");
+  CHECK_TRUE(handler_1.post != NULL, "No post named-section found.");
+
+  if (handler_1.post == NULL) {
+    return;
+  }
+
+  CHECK_TRUE(handler_1.post->name != NULL && strcmp(handler_1.post->name, NAME_2) == 0,
+      "Illegal name of changed section: %s", handler_1.post->name);
+
+  CHECK_TRUE(!entries_1[0].delta_changed, "Key 1 did change!");
+  CHECK_TRUE( entries_1[1].delta_changed, "Key 2 did not change!");
+
+  CHECK_TRUE(strarray_cmp_c(entries_1[1].post, &value_3) == 0,
+      "Unknown post data for key 2: %s", entries_1[1].post->value);
+}
+
 int
 main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
   cfg_schema_add(&schema);
@@ -505,6 +568,7 @@ main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
   test_delta_remove_two_sections();
   test_delta_modify_single_section();
   test_delta_modify_two_sections();
+  test_delta_dirty_section();
 
   abuf_free(&out);
   if (db_post) {
@@ -40,6 +40,7 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "config/cfg_schema.h"
 #include "config/cfg_db.h"
@@ -258,6 +259,137 @@ test_list_3(void) {
   END_TEST();
 }
 
+static void
+test_list_copy(void) {
+  struct cfg_db *db, *copy;
+  struct cfg_entry *entry;
+  const char *expected[] = { "test 3", "test 2", "test 1", "test 4" };
+  char *ptr;
+  size_t cnt;
+  START_TEST();
+
+  db = cfg_db_add();
+  cfg_db_set_entry(db, "section1", "testname", "key1", "test 1", false);
+  cfg_db_set_entry(db, "section1", "testname", "key1", "test 2", true);
+  cfg_db_set_entry(db, "section1", "testname", "key1", "test 3", true);
+  cfg_db_add_namedsection(db, "section1", "empty");
+
+  copy = cfg_db_duplicate(db);
+  CHECK_TRUE(copy != NULL, "Could not duplicate db");
+  if (copy == NULL) {
+    cfg_db_remove(db);
+    END_TEST();
+    return;
+  }
+
+  CHECK_TRUE(cfg_db_find_namedsection(copy, "section1", "empty") != NULL,
+      "empty section was not copied");
+
+  entry = cfg_db_find_entry(copy, "section1", "testname", "key1");
+  CHECK_TRUE(entry != NULL && cfg_db_entry_get_listsize(entry) == 3,
+      "duplicate did not copy three values");
+
+  /* copying into an existing entry appends the values */
+  cfg_db_set_entry(db, "section1", "testname", "key1", "test 4", false);
+  CHECK_TRUE(cfg_db_copy(copy, db) == 0, "Could not copy db");
+
+  entry = cfg_db_find_entry(copy, "section1", "testname", "key1");
+  CHECK_TRUE(entry != NULL, "entry missing after copy");
+  if (entry) {
+    cnt = 0;
+    strarray_for_each_element(&entry->val, ptr) {
+      CHECK_TRUE(cnt < ARRAYSIZE(expected) && strcmp(ptr, expected[cnt]) == 0,
+          "part %"PRINTF_SIZE_T_SPECIFIER" was '%s'", cnt+1, ptr);
+      cnt++;
+    }
+    CHECK_TRUE(cnt == ARRAYSIZE(expected),
+        "copy did create %"PRINTF_SIZE_T_SPECIFIER" values", cnt);
+  }
+
+  cfg_db_remove(copy);
+  cfg_db_remove(db);
+  END_TEST();
+}
+
+static void
+test_list_copy_dirty(void) {
+  struct cfg_db *db, *base, *copy;
+  struct cfg_section_type *section1, *section2;
+  const struct const_strarray *value;
+  START_TEST();
+
+  db = cfg_db_add();
+  cfg_db_set_entry(db, "section1", "name1", "key1", "test 1", false);
+  cfg_db_set_entry(db, "section2", "name2", "key1", "test 2", false);
+
+  base = cfg_db_duplicate(db);
+  CHECK_TRUE(base != NULL, "Could not duplicate db");
+  if (base == NULL) {
+    cfg_db_remove(db);
+    END_TEST();
+    return;
+  }
+  section1 = cfg_db_find_sectiontype(base, "section1");
+  section2 = cfg_db_find_sectiontype(base, "section2");
+
+  /* only section2 changes */
+  cfg_db_track_changes(db, true);
+  cfg_db_overwrite_entry(db, "section2", "name2", "key1", "test 3");
+
+  copy = cfg_db_duplicate_dirty(db, base);
+  CHECK_TRUE(copy != NULL, "Could not duplicate dirty db");
+  if (copy == NULL) {
+    cfg_db_remove(base);
+    cfg_db_remove(db);
+    END_TEST();
+    return;
+  }
+
+  /* unchanged section type has been moved from base */
+  CHECK_TRUE(cfg_db_find_sectiontype(copy, "section1") == section1,
+      "unchanged section type was not moved");
+  CHECK_TRUE(section1->db == copy, "moved section type points to old db");
+  CHECK_TRUE(cfg_db_find_sectiontype(base, "section1") == NULL,
+      "unchanged section type is still in base");
+
+  /* changed section type has been copied, base keeps the old value */
+  CHECK_TRUE(cfg_db_find_sectiontype(base, "section2") == section2,
+      "changed section type was removed from base");
+  value = cfg_db_get_entry_value(copy, "section2", "name2", "key1");
+  CHECK_TRUE(value != NULL && strcmp(value->value, "test 3") == 0,
+      "changed value was not copied");
+  value = cfg_db_get_entry_value(base, "section2", "name2", "key1");
+  CHECK_TRUE(value != NULL && strcmp(value->value, "test 2") == 0,
+      "base value was modified");
+
+  /* the copy records the copied sections */
+  CHECK_TRUE(copy->dirty.count == 1 && !copy->dirty_all,
+      "%u dirty sections in copy", copy->dirty.count);
+
+  cfg_db_remove(copy);
+  cfg_db_remove(base);
+
+  /* without change tracking the whole db is copied */
+  cfg_db_track_changes(db, false);
+  base = cfg_db_duplicate(db);
+  copy = base == NULL ? NULL : cfg_db_duplicate_dirty(db, base);
+  CHECK_TRUE(copy != NULL, "Could not duplicate untracked db");
+  if (copy) {
+    CHECK_TRUE(cfg_db_find_sectiontype(base, "section1") != NULL
+        && cfg_db_find_sectiontype(copy, "section1") != NULL
+        && cfg_db_find_sectiontype(base, "section1")
+           != cfg_db_find_sectiontype(copy, "section1"),
+        "untracked db was not copied completely");
+    CHECK_TRUE(copy->dirty_all, "complete copy is not marked dirty");
+    cfg_db_remove(copy);
+  }
+  if (base) {
+    cfg_db_remove(base);
+  }
+  cfg_db_remove(db);
+  END_TEST();
+}
+
 int
 main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
   cfg_schema_add(&schema);
@@ -268,6 +400,8 @@ main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
   test_list_1();
   test_list_2();
   test_list_3();
+  test_list_copy();
+  test_list_copy_dirty();
 
   cfg_schema_remove_section(&schema, &section);
 
@@ -223,6 +223,64 @@ test_dual_binary_mapping(void) {
   END_TEST();
 }
 
+static void
+test_cached_binary_mapping(void) {
+  struct bin_data data;
+  struct cfg_entry *entry;
+  struct cfg_db *copy;
+
+  START_TEST();
+
+  memset(&data, 0, sizeof(data));
+
+  cfg_db_link_schema(db, &schema);
+  CHECK_TRUE(cfg_schema_validate(db, false, false, &out) == 0,
+      "Validation failed: %s", abuf_getptr(&out));
+
+  entry = cfg_db_find_entry(db, CFG_SEC, CFG_SECNAME, "integer");
+  CHECK_TRUE(entry != NULL, "Could not find integer entry");
+  if (entry) {
+    CHECK_TRUE(entry->_bincache.cb_to_binary != NULL,
+        "Validation did not fill binary cache");
+  }
+
+  entry = cfg_db_find_entry(db, CFG_SEC, CFG_SECNAME, "string");
+  CHECK_TRUE(entry != NULL, "Could not find string entry");
+  if (entry) {
+    CHECK_TRUE(entry->_bincache.cb_to_binary == NULL,
+        "Allocated string was cached");
+  }
+
+  /* duplicated entries keep their binary value */
+  copy = cfg_db_duplicate(db);
+  CHECK_TRUE(copy != NULL, "Could not duplicate db");
+  if (copy) {
+    entry = cfg_db_find_entry(copy, CFG_SEC, CFG_SECNAME, "address");
+    CHECK_TRUE(entry != NULL && entry->_bincache.cb_to_binary != NULL,
+        "Duplicated entry has no binary cache");
+    cfg_db_remove(copy);
+  }
+
+  /* changing a value must invalidate the cache */
+  cfg_db_overwrite_entry(db, CFG_SEC, CFG_SECNAME, "integer", "7");
+  entry = cfg_db_find_entry(db, CFG_SEC, CFG_SECNAME, "integer");
+  CHECK_TRUE(entry != NULL && entry->_bincache.cb_to_binary == NULL,
+      "Binary cache still valid after change");
+
+  CHECK_TRUE(cfg_schema_tobin(&data, cfg_db_find_namedsection(db, CFG_SEC, CFG_SECNAME),
+      entries, ARRAYSIZE(entries)) == 0, "Conversion failed");
+  CHECK_TRUE(data.integer == 7, "Integer is not '7' but '%d'", data.integer);
+  CHECK_TRUE(data.choice == 1, "Choice is not '1' but '%d'", data.choice);
+  CHECK_TRUE(data.fractional == -31415, "Fractional is not '-31415' but '%d'",
+      data.fractional);
+  CHECK_TRUE(data.boolean, "Boolean was false");
+  CHECK_TRUE(memcmp(netaddr_get_binptr(&data.address), IP_10_coloncolon_1, 16) == 0,
+      "Netaddr Address part is not consistent");
+
+  free(data.string);
+  END_TEST();
+}
+
 int
 main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
   cfg_schema_add(&schema);
@@ -234,6 +292,7 @@ main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
 
   test_binary_mapping();
   test_dual_binary_mapping();
+  test_cached_binary_mapping();
 
   abuf_free(&out);
   if (db) {
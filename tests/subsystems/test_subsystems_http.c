@@ -0,0 +1,200 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2013, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+#include <string.h>
+
+#include "common/common_types.h"
+#include "common/avl.h"
+#include "core/oonf_subsystem.h"
+#include "subsystems/oonf_class.h"
+#include "subsystems/oonf_http.h"
+
+#include "cunit/cunit.h"
+
+static struct oonf_http_handler root_dir = { .site = "/" };
+static struct oonf_http_handler a_dir = { .site = "/a/" };
+static struct oonf_http_handler a_site = { .site = "/a" };
+static struct oonf_http_handler neigh_param = { .site = "/neighbor/:address" };
+static struct oonf_http_handler neigh_local = { .site = "/neighbor/local" };
+static struct oonf_http_handler neigh_links = { .site = "/neighbor/:address/links" };
+
+static struct oonf_http_handler *handlers[] = {
+  &root_dir, &a_dir, &a_site, &neigh_param, &neigh_local, &neigh_links,
+};
+
+static struct oonf_http_session session;
+
+static void
+clear_elements(void) {
+  size_t i;
+
+  for (i=0; i<ARRAYSIZE(handlers); i++) {
+    oonf_http_remove(handlers[i]);
+  }
+  memset(&session, 0, sizeof(session));
+}
+
+static void
+add_handlers(void) {
+  size_t i;
+
+  for (i=0; i<ARRAYSIZE(handlers); i++) {
+    oonf_http_add(handlers[i]);
+  }
+}
+
+static struct oonf_http_handler *
+lookup(const char *uri) {
+  static char buffer[256];
+
+  memset(&session, 0, sizeof(session));
+  strscpy(buffer, uri, sizeof(buffer));
+  return oonf_http_get_site_handler(buffer, &session);
+}
+
+static uint32_t
+get_path_node_count(void) {
+  struct oonf_class *c;
+
+  c = avl_find_element(&oonf_classes, "http path segment", c, _node);
+  return c == NULL ? 0 : oonf_class_get_usage(c);
+}
+
+static void
+test_prefix(void) {
+  START_TEST();
+  add_handlers();
+
+  CHECK_TRUE(lookup("/a") == &a_site, "/a did not match site");
+  CHECK_TRUE(lookup("/a/") == &a_dir, "/a/ did not match directory");
+  CHECK_TRUE(lookup("/a/b/c") == &a_dir, "/a/b/c did not match /a/");
+  CHECK_TRUE(lookup("/b") == &root_dir, "/b did not match /");
+  CHECK_TRUE(lookup("/") == &root_dir, "/ did not match /");
+  CHECK_TRUE(session.param_count == 0, "Directory match has %d parameters",
+      (int)session.param_count);
+
+  oonf_http_remove(&root_dir);
+  CHECK_TRUE(lookup("/b") == NULL, "/b matched without root directory");
+  CHECK_TRUE(lookup("/a/b") == &a_dir, "/a/b did not match /a/");
+  END_TEST();
+}
+
+static void
+test_param(void) {
+  START_TEST();
+  add_handlers();
+
+  CHECK_TRUE(lookup("/neighbor/local") == &neigh_local, "fixed segment did not match");
+  CHECK_TRUE(session.param_count == 0, "fixed segment added a parameter");
+
+  CHECK_TRUE(lookup("/neighbor/10.0.0.1") == &neigh_param, "path parameter did not match");
+  CHECK_TRUE(session.param_count == 1, "path parameter count is %d",
+      (int)session.param_count);
+  CHECK_TRUE(session.param_count > 0 && strcmp(session.param_name[0], "address") == 0,
+      "wrong parameter name");
+  CHECK_TRUE(session.param_count > 0 && strcmp(session.param_value[0], "10.0.0.1") == 0,
+      "wrong parameter value");
+
+  CHECK_TRUE(lookup("/neighbor/fe80::1/links") == &neigh_links, "parameter in the middle did not match");
+  CHECK_TRUE(session.param_count == 1
+      && strcmp(session.param_value[0], "fe80::1") == 0, "wrong parameter value");
+
+  /* no match below the parameter falls back to the longest directory */
+  CHECK_TRUE(lookup("/neighbor/10.0.0.1/other") == &root_dir, "unknown site did not match /");
+  CHECK_TRUE(session.param_count == 0, "directory match kept path parameter");
+  END_TEST();
+}
+
+static void
+test_add_failure(void) {
+  struct oonf_http_handler conflict = { .site = "/neighbor/:other/new" };
+  struct oonf_http_handler deep = { .site = "/neighbor/local/deep/" };
+  struct oonf_http_handler duplicate = { .site = "/a//" };
+  uint32_t count;
+
+  START_TEST();
+  add_handlers();
+  count = get_path_node_count();
+  CHECK_TRUE(count > 0, "No path nodes allocated");
+
+  /* parameter name conflict */
+  oonf_http_add(&conflict);
+  CHECK_TRUE(!avl_is_node_added(&conflict.node), "conflicting site was added");
+  CHECK_TRUE(get_path_node_count() == count, "path nodes changed: %u instead of %u",
+      get_path_node_count(), count);
+
+  /* different site string for an existing directory */
+  oonf_http_add(&duplicate);
+  CHECK_TRUE(!avl_is_node_added(&duplicate.node), "duplicate directory was added");
+  CHECK_TRUE(get_path_node_count() == count, "path nodes changed: %u instead of %u",
+      get_path_node_count(), count);
+  CHECK_TRUE(lookup("/a/") == &a_dir, "/a/ did not match directory");
+
+  /* directory with a new path node, removed together with the site */
+  oonf_http_add(&deep);
+  CHECK_TRUE(get_path_node_count() == count + 1, "No path node allocated for new directory");
+  CHECK_TRUE(lookup("/neighbor/local/deep/x") == &deep, "new directory did not match");
+  oonf_http_remove(&deep);
+  CHECK_TRUE(get_path_node_count() == count, "path nodes changed: %u instead of %u",
+      get_path_node_count(), count);
+  CHECK_TRUE(lookup("/neighbor/local") == &neigh_local, "fixed segment did not match");
+
+  clear_elements();
+  CHECK_TRUE(get_path_node_count() == 0, "%u path nodes left", get_path_node_count());
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  oonf_class_subsystem.init();
+  oonf_http_subsystem.init();
+
+  BEGIN_TESTING(clear_elements);
+
+  test_prefix();
+  test_param();
+  test_add_failure();
+
+  oonf_http_subsystem.cleanup();
+  oonf_class_subsystem.cleanup();
+  return FINISH_TESTING();
+}
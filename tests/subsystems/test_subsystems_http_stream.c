@@ -0,0 +1,388 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2013, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "common/common_types.h"
+#include "common/autobuf.h"
+#include "config/cfg_db.h"
+#include "config/cfg_schema.h"
+#include "core/oonf_logging.h"
+#include "core/oonf_subsystem.h"
+#include "subsystems/oonf_class.h"
+#include "subsystems/oonf_clock.h"
+#include "subsystems/oonf_http.h"
+#include "subsystems/oonf_socket.h"
+#include "subsystems/oonf_stream_socket.h"
+#include "subsystems/oonf_timer.h"
+#include "subsystems/os_clock.h"
+#include "subsystems/os_net.h"
+
+#include "cunit/cunit.h"
+
+/* number of blocks generated by the stream handler after the first one */
+#define STREAM_BLOCKS 20
+
+static enum oonf_http_result _cb_stream_content(
+    struct autobuf *out, struct oonf_http_session *session);
+static bool _cb_stream_block(struct autobuf *out, struct oonf_http_session *session);
+static void _cb_stream_stop(struct oonf_http_session *session);
+
+static struct oonf_appdata appdata = {
+  .app_name = "test",
+  .app_version = "0",
+};
+
+static struct oonf_subsystem *subsystems[] = {
+  &oonf_os_clock_subsystem,
+  &oonf_clock_subsystem,
+  &oonf_timer_subsystem,
+  &oonf_socket_subsystem,
+  &oonf_os_net_subsystem,
+  &oonf_class_subsystem,
+  &oonf_stream_socket_subsystem,
+  &oonf_http_subsystem,
+};
+
+static struct oonf_http_handler stream_site = {
+  .site = "/stream",
+  .acl = { .accept_default = true },
+  .content_handler = _cb_stream_content,
+};
+
+static struct cfg_schema schema;
+static struct cfg_db *db;
+static uint16_t port;
+
+static struct autobuf expected, received;
+static struct oonf_socket_entry client;
+static bool closed;
+static int stopped;
+
+static void
+clear_elements(void) {
+  abuf_clear(&received);
+  closed = false;
+  stopped = 0;
+}
+
+static enum oonf_http_result
+_cb_stream_content(struct autobuf *out, struct oonf_http_session *session) {
+  abuf_puts(out, "block 0\n");
+
+  session->stream_data[0] = (void *)1;
+  session->stream_handler = _cb_stream_block;
+  session->stop_handler = _cb_stream_stop;
+  return HTTP_200_OK;
+}
+
+static bool
+_cb_stream_block(struct autobuf *out, struct oonf_http_session *session) {
+  uintptr_t block;
+
+  block = (uintptr_t)session->stream_data[0];
+  abuf_appendf(out, "block %u\n", (unsigned)block);
+
+  session->stream_data[0] = (void *)(block + 1);
+  return block < STREAM_BLOCKS;
+}
+
+static void
+_cb_stream_stop(struct oonf_http_session *session __attribute__((unused))) {
+  stopped++;
+}
+
+static void
+_cb_client_receive(int fd, void *data __attribute__((unused)),
+    bool event_read, bool event_write __attribute__((unused))) {
+  char buffer[1024];
+  ssize_t result;
+
+  if (!event_read) {
+    return;
+  }
+
+  result = recv(fd, buffer, sizeof(buffer), 0);
+  if (result < 0 && errno == EINTR) {
+    return;
+  }
+  if (result <= 0) {
+    oonf_socket_remove(&client);
+    closed = true;
+    return;
+  }
+  abuf_memcpy(&received, buffer, result);
+}
+
+static bool
+_cb_stop_scheduler(void) {
+  return closed;
+}
+
+/**
+ * Send a request to the http subsystem and collect the answer
+ * until the server closes the connection.
+ * @param request http request
+ * @return pointer to body of the answer, NULL if an error happened
+ */
+static const char *
+_request(const char *request) {
+  struct sockaddr_in addr;
+  const char *body;
+  int sock;
+
+  sock = socket(AF_INET, SOCK_STREAM, 0);
+  if (sock == -1) {
+    return NULL;
+  }
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  if (connect(sock, (struct sockaddr *)&addr, sizeof(addr))
+      || send(sock, request, strlen(request), 0) != (ssize_t)strlen(request)) {
+    close(sock);
+    return NULL;
+  }
+
+  client.fd = sock;
+  client.process = _cb_client_receive;
+  client.event_read = true;
+  oonf_socket_add(&client);
+
+  if (oonf_socket_handle(_cb_stop_scheduler, oonf_clock_get_absolute(5000))) {
+    closed = false;
+  }
+  if (!closed) {
+    oonf_socket_remove(&client);
+  }
+  close(sock);
+
+  if (!closed) {
+    return NULL;
+  }
+
+  body = strstr(abuf_getptr(&received), "\r\n\r\n");
+  return body == NULL ? NULL : body + 4;
+}
+
+/**
+ * Remove the chunked transfer encoding framing from a http body
+ * @param out output buffer for decoded body
+ * @param body chunked http body
+ * @return -1 if the framing was broken, 0 otherwise
+ */
+static int
+_decode_chunked(struct autobuf *out, const char *body) {
+  unsigned long length;
+  char *end;
+
+  while (true) {
+    length = strtoul(body, &end, 16);
+    if (end == body || strncmp(end, "\r\n", 2) != 0) {
+      return -1;
+    }
+    body = end + 2;
+
+    if (length == 0) {
+      /* last chunk must be followed by an empty trailer */
+      return strcmp(body, "\r\n") == 0 ? 0 : -1;
+    }
+    if (strlen(body) < length + 2 || strncmp(body + length, "\r\n", 2) != 0) {
+      return -1;
+    }
+    abuf_memcpy(out, body, length);
+    body += length + 2;
+  }
+}
+
+static void
+test_chunked(void) {
+  struct autobuf decoded;
+  const char *body;
+
+  START_TEST();
+  abuf_init(&decoded);
+
+  body = _request("GET /stream HTTP/1.1\r\n\r\n");
+  CHECK_TRUE(body != NULL, "No answer received");
+  if (body) {
+    CHECK_TRUE(strncmp(abuf_getptr(&received), "HTTP/1.1 200", 12) == 0,
+        "Wrong status line");
+    CHECK_TRUE(strstr(abuf_getptr(&received), "Transfer-Encoding: chunked\r\n") != NULL,
+        "No chunked transfer encoding");
+    CHECK_TRUE(strstr(abuf_getptr(&received), "Content-length") == NULL,
+        "Content-length in chunked answer");
+    CHECK_TRUE(_decode_chunked(&decoded, body) == 0, "Broken chunk framing: %s", body);
+    CHECK_TRUE(strcmp(abuf_getptr(&decoded), abuf_getptr(&expected)) == 0,
+        "Wrong decoded body: %s", abuf_getptr(&decoded));
+  }
+  CHECK_TRUE(stopped == 1, "stop handler called %d times", stopped);
+
+  abuf_free(&decoded);
+  END_TEST();
+}
+
+static void
+test_unframed(void) {
+  const char *body;
+
+  START_TEST();
+
+  body = _request("GET /stream HTTP/1.0\r\n\r\n");
+  CHECK_TRUE(body != NULL, "No answer received");
+  if (body) {
+    CHECK_TRUE(strncmp(abuf_getptr(&received), "HTTP/1.0 200", 12) == 0,
+        "Wrong status line");
+    CHECK_TRUE(strstr(abuf_getptr(&received), "Transfer-Encoding") == NULL,
+        "Chunked transfer encoding for HTTP/1.0");
+    CHECK_TRUE(strstr(abuf_getptr(&received), "Content-length") == NULL,
+        "Content-length in unframed stream");
+    CHECK_TRUE(strcmp(body, abuf_getptr(&expected)) == 0,
+        "Wrong body: %s", body);
+  }
+  CHECK_TRUE(stopped == 1, "stop handler called %d times", stopped);
+  END_TEST();
+}
+
+/**
+ * @return free tcp port on the loopback interface, 0 if an error happened
+ */
+static uint16_t
+_get_free_port(void) {
+  struct sockaddr_in addr;
+  socklen_t len;
+  int sock;
+
+  sock = socket(AF_INET, SOCK_STREAM, 0);
+  if (sock == -1) {
+    return 0;
+  }
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  len = sizeof(addr);
+
+  if (bind(sock, (struct sockaddr *)&addr, sizeof(addr))
+      || getsockname(sock, (struct sockaddr *)&addr, &len)) {
+    close(sock);
+    return 0;
+  }
+  close(sock);
+  return ntohs(addr.sin_port);
+}
+
+static int
+_configure_http(void) {
+  char buffer[6];
+
+  port = _get_free_port();
+  if (port == 0) {
+    return -1;
+  }
+  snprintf(buffer, sizeof(buffer), "%u", port);
+
+  cfg_schema_add(&schema);
+  cfg_schema_add_section(&schema, oonf_http_subsystem.cfg_section);
+
+  db = cfg_db_add();
+  if (db == NULL) {
+    return -1;
+  }
+  cfg_db_link_schema(db, &schema);
+
+  cfg_db_add_entry(db, "http", NULL, "port", buffer);
+  cfg_db_add_entry(db, "http", NULL, "bindto_v6", "-");
+  return cfg_schema_handle_db_startup_changes(db);
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  size_t i;
+  unsigned block;
+
+  if (oonf_log_init(&appdata, LOG_SEVERITY_WARN)) {
+    return 1;
+  }
+  for (i=0; i<ARRAYSIZE(subsystems); i++) {
+    if (subsystems[i]->init != NULL && subsystems[i]->init()) {
+      return 1;
+    }
+  }
+  if (_configure_http()) {
+    return 1;
+  }
+  oonf_http_add(&stream_site);
+
+  abuf_init(&expected);
+  abuf_init(&received);
+  for (block = 0; block <= STREAM_BLOCKS; block++) {
+    abuf_appendf(&expected, "block %u\n", block);
+  }
+
+  BEGIN_TESTING(clear_elements);
+
+  test_chunked();
+  test_unframed();
+
+  abuf_free(&received);
+  abuf_free(&expected);
+
+  oonf_http_remove(&stream_site);
+  for (i=ARRAYSIZE(subsystems); i>0; i--) {
+    if (subsystems[i-1]->cleanup != NULL) {
+      subsystems[i-1]->cleanup();
+    }
+  }
+  cfg_db_remove(db);
+  cfg_schema_remove_section(&schema, oonf_http_subsystem.cfg_section);
+  oonf_log_cleanup();
+  return FINISH_TESTING();
+}
@@ -0,0 +1,211 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2013, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+#include <string.h>
+
+#include "common/common_types.h"
+#include "common/netaddr.h"
+#include "core/oonf_logging.h"
+#include "core/oonf_subsystem.h"
+#include "subsystems/oonf_class.h"
+#include "subsystems/oonf_clock.h"
+#include "subsystems/oonf_layer2.h"
+#include "subsystems/oonf_timer.h"
+#include "subsystems/os_clock.h"
+
+#include "cunit/cunit.h"
+
+static struct oonf_appdata appdata = {
+  .app_name = "test",
+  .app_version = "0",
+};
+
+static struct oonf_subsystem *subsystems[] = {
+  &oonf_os_clock_subsystem,
+  &oonf_clock_subsystem,
+  &oonf_timer_subsystem,
+  &oonf_class_subsystem,
+  &oonf_layer2_subsystem,
+};
+
+static struct netaddr net_addr, neigh_addr;
+static uint32_t origin1, origin2;
+
+static void
+clear_elements(void) {
+  oonf_layer2_cleanup_origin(origin1);
+  oonf_layer2_cleanup_origin(origin2);
+}
+
+static void
+test_cleanup_net_data(void) {
+  struct oonf_layer2_net *l2net;
+
+  START_TEST();
+
+  l2net = oonf_layer2_net_add(&net_addr);
+  CHECK_TRUE(l2net != NULL, "Cannot create network");
+  if (l2net == NULL) {
+    END_TEST();
+    return;
+  }
+
+  oonf_layer2_set_value(&l2net->data[OONF_LAYER2_NET_FREQUENCY], origin1, 2412000000ll);
+  oonf_layer2_net_commit(l2net);
+
+  oonf_layer2_cleanup_origin(origin1);
+  CHECK_TRUE(oonf_layer2_net_get(&net_addr) == NULL,
+      "network without data survived the cleanup of its originator");
+  END_TEST();
+}
+
+static void
+test_cleanup_neighdata(void) {
+  struct oonf_layer2_net *l2net;
+
+  START_TEST();
+
+  l2net = oonf_layer2_net_add(&net_addr);
+  CHECK_TRUE(l2net != NULL, "Cannot create network");
+  if (l2net == NULL) {
+    END_TEST();
+    return;
+  }
+
+  oonf_layer2_set_value(&l2net->data[OONF_LAYER2_NET_FREQUENCY], origin1, 2412000000ll);
+  oonf_layer2_net_commit(l2net);
+
+  /* second originator only contributes neighbor defaults */
+  oonf_layer2_set_value(&l2net->neighdata[OONF_LAYER2_NEIGH_TX_BITRATE], origin2, 1000000000ll);
+  oonf_layer2_set_value(&l2net->neighdata[OONF_LAYER2_NEIGH_RX_BITRATE], origin2, 1000000000ll);
+  oonf_layer2_net_commit(l2net);
+
+  oonf_layer2_cleanup_origin(origin2);
+
+  l2net = oonf_layer2_net_get(&net_addr);
+  CHECK_TRUE(l2net != NULL, "network lost data of another originator");
+  if (l2net == NULL) {
+    END_TEST();
+    return;
+  }
+  CHECK_TRUE(!oonf_layer2_has_value(&l2net->neighdata[OONF_LAYER2_NEIGH_TX_BITRATE]),
+      "tx bitrate default survived the cleanup of its originator");
+  CHECK_TRUE(!oonf_layer2_has_value(&l2net->neighdata[OONF_LAYER2_NEIGH_RX_BITRATE]),
+      "rx bitrate default survived the cleanup of its originator");
+  CHECK_TRUE(oonf_layer2_has_value(&l2net->data[OONF_LAYER2_NET_FREQUENCY]),
+      "frequency of another originator was removed");
+
+  oonf_layer2_cleanup_origin(origin1);
+  CHECK_TRUE(oonf_layer2_net_get(&net_addr) == NULL,
+      "network without data survived the cleanup of its originator");
+  END_TEST();
+}
+
+static void
+test_cleanup_neighdata_with_neighbor(void) {
+  struct oonf_layer2_net *l2net;
+  struct oonf_layer2_neigh *l2neigh;
+
+  START_TEST();
+
+  l2net = oonf_layer2_net_add(&net_addr);
+  l2neigh = l2net ? oonf_layer2_neigh_add(l2net, &neigh_addr) : NULL;
+  CHECK_TRUE(l2neigh != NULL, "Cannot create neighbor");
+  if (l2neigh == NULL) {
+    END_TEST();
+    return;
+  }
+
+  oonf_layer2_set_value(&l2neigh->data[OONF_LAYER2_NEIGH_SIGNAL], origin1, -40);
+  oonf_layer2_neigh_commit(l2neigh);
+
+  /* network has no data of its own, only the defaults of the second originator */
+  oonf_layer2_set_value(&l2net->neighdata[OONF_LAYER2_NEIGH_TX_BITRATE], origin2, 1000000000ll);
+  oonf_layer2_net_commit(l2net);
+  CHECK_TRUE(oonf_layer2_neigh_query(&net_addr, &neigh_addr, OONF_LAYER2_NEIGH_TX_BITRATE) != NULL,
+      "neighbor does not see the network default");
+
+  oonf_layer2_cleanup_origin(origin2);
+  CHECK_TRUE(oonf_layer2_neigh_query(&net_addr, &neigh_addr, OONF_LAYER2_NEIGH_TX_BITRATE) == NULL,
+      "network default survived the cleanup of its originator");
+  CHECK_TRUE(oonf_layer2_neigh_query(&net_addr, &neigh_addr, OONF_LAYER2_NEIGH_SIGNAL) != NULL,
+      "signal of another originator was removed");
+
+  oonf_layer2_cleanup_origin(origin1);
+  CHECK_TRUE(oonf_layer2_net_get(&net_addr) == NULL,
+      "network without neighbors survived the cleanup of its originators");
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  size_t i;
+
+  if (oonf_log_init(&appdata, LOG_SEVERITY_WARN)) {
+    return 1;
+  }
+  for (i=0; i<ARRAYSIZE(subsystems); i++) {
+    if (subsystems[i]->init != NULL && subsystems[i]->init()) {
+      return 1;
+    }
+  }
+
+  if (netaddr_from_string(&net_addr, "02:00:00:00:00:01")
+      || netaddr_from_string(&neigh_addr, "02:00:00:00:00:02")) {
+    return 1;
+  }
+  origin1 = oonf_layer2_register_origin();
+  origin2 = oonf_layer2_register_origin();
+
+  BEGIN_TESTING(clear_elements);
+
+  test_cleanup_net_data();
+  test_cleanup_neighdata();
+  test_cleanup_neighdata_with_neighbor();
+
+  for (i=ARRAYSIZE(subsystems); i>0; i--) {
+    if (subsystems[i-1]->cleanup != NULL) {
+      subsystems[i-1]->cleanup();
+    }
+  }
+  oonf_log_cleanup();
+  return FINISH_TESTING();
+}
@@ -0,0 +1,257 @@
+
+/*
+ * The olsr.org Optimized Link-State Routing daemon version 2 (olsrd2)
+ * Copyright (c) 2004-2013, the olsr.org team - see HISTORY file
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in
+ *   the documentation and/or other materials provided with the
+ *   distribution.
+ * * Neither the name of olsr.org, olsrd nor the names of its
+ *   contributors may be used to endorse or promote products derived
+ *   from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Visit http://www.olsr.org for more information.
+ *
+ * If you find this software useful feel free to make a donation
+ * to the project. For more information see the website or contact
+ * the copyright holders.
+ *
+ */
+
+
+#include <string.h>
+
+#include "common/common_types.h"
+#include "common/netaddr.h"
+#include "core/oonf_logging.h"
+#include "core/oonf_subsystem.h"
+#include "subsystems/oonf_class.h"
+#include "subsystems/oonf_clock.h"
+#include "subsystems/oonf_layer2.h"
+#include "subsystems/oonf_layer2_history.h"
+#include "subsystems/oonf_timer.h"
+#include "subsystems/os_clock.h"
+
+#include "cunit/cunit.h"
+
+static struct oonf_appdata appdata = {
+  .app_name = "test",
+  .app_version = "0",
+};
+
+static struct oonf_subsystem *subsystems[] = {
+  &oonf_os_clock_subsystem,
+  &oonf_clock_subsystem,
+  &oonf_timer_subsystem,
+  &oonf_class_subsystem,
+  &oonf_layer2_subsystem,
+};
+
+static struct oonf_layer2_history history;
+
+static void
+clear_elements(void) {
+  memset(&history, 0, sizeof(history));
+}
+
+static int64_t
+get_value(size_t age) {
+  const struct oonf_layer2_sample *sample;
+
+  sample = oonf_layer2_history_get_sample(&history, age);
+  return sample == NULL ? -1 : sample->value;
+}
+
+static void
+test_ring(void) {
+  int64_t i;
+
+  START_TEST();
+
+  CHECK_TRUE(oonf_layer2_history_get_sample(&history, 0) == NULL,
+      "Empty history has a sample");
+
+  for (i=1; i<=3; i++) {
+    oonf_layer2_history_append(&history, i * 1000, i);
+  }
+  CHECK_TRUE(history.count == 3, "count is %u", history.count);
+  CHECK_TRUE(get_value(0) == 3, "newest sample is %"PRId64, get_value(0));
+  CHECK_TRUE(get_value(2) == 1, "oldest sample is %"PRId64, get_value(2));
+  CHECK_TRUE(oonf_layer2_history_get_sample(&history, 3) == NULL,
+      "sample behind the oldest one");
+
+  /* wrap around the end of the ring twice */
+  for (i=4; i<=2*OONF_LAYER2_HISTORY_SIZE+3; i++) {
+    oonf_layer2_history_append(&history, i * 1000, i);
+  }
+  CHECK_TRUE(history.count == OONF_LAYER2_HISTORY_SIZE, "count is %u", history.count);
+  CHECK_TRUE(get_value(0) == 2*OONF_LAYER2_HISTORY_SIZE+3,
+      "newest sample is %"PRId64, get_value(0));
+  CHECK_TRUE(get_value(OONF_LAYER2_HISTORY_SIZE-1) == OONF_LAYER2_HISTORY_SIZE+4,
+      "oldest sample is %"PRId64, get_value(OONF_LAYER2_HISTORY_SIZE-1));
+  CHECK_TRUE(oonf_layer2_history_get_sample(&history, 0)->timestamp
+      == (2*OONF_LAYER2_HISTORY_SIZE+3) * 1000, "wrong timestamp of newest sample");
+  CHECK_TRUE(oonf_layer2_history_get_sample(&history, OONF_LAYER2_HISTORY_SIZE) == NULL,
+      "sample behind the oldest one");
+  END_TEST();
+}
+
+static void
+test_min_max(void) {
+  int i;
+
+  START_TEST();
+
+  oonf_layer2_history_append(&history, 0, 100);
+  for (i=1; i<OONF_LAYER2_HISTORY_SIZE; i++) {
+    oonf_layer2_history_append(&history, i, -5);
+  }
+  CHECK_TRUE(history.min == -5 && history.max == 100,
+      "min/max is %"PRId64"/%"PRId64, history.min, history.max);
+
+  /* overwrite the maximum */
+  oonf_layer2_history_append(&history, i++, 3);
+  CHECK_TRUE(history.min == -5 && history.max == 3,
+      "min/max after overwriting max is %"PRId64"/%"PRId64, history.min, history.max);
+
+  /* overwrite all minimums */
+  while (i < 2*OONF_LAYER2_HISTORY_SIZE) {
+    oonf_layer2_history_append(&history, i++, 7);
+  }
+  CHECK_TRUE(history.min == 3 && history.max == 7,
+      "min/max after overwriting min is %"PRId64"/%"PRId64, history.min, history.max);
+  END_TEST();
+}
+
+static void
+test_ewma(void) {
+  int i;
+
+  START_TEST();
+
+  oonf_layer2_history_append(&history, 0, 80);
+  CHECK_TRUE(history.ewma == 80, "ewma of first sample is %"PRId64, history.ewma);
+
+  for (i=1; i<20; i++) {
+    oonf_layer2_history_append(&history, i, 80);
+  }
+  CHECK_TRUE(history.ewma == 80, "ewma of constant value is %"PRId64, history.ewma);
+
+  /* new sample has a weight of 1/8 */
+  oonf_layer2_history_append(&history, i++, 0);
+  CHECK_TRUE(history.ewma == 70, "ewma after first drop is %"PRId64, history.ewma);
+
+  /* 70 - 70/8 = 61.25, the fraction must not get lost */
+  oonf_layer2_history_append(&history, i++, 0);
+  CHECK_TRUE(history.ewma == 61, "ewma after second drop is %"PRId64, history.ewma);
+  oonf_layer2_history_append(&history, i++, 0);
+  CHECK_TRUE(history.ewma == 53, "ewma after third drop is %"PRId64, history.ewma);
+  END_TEST();
+}
+
+static void
+test_neighbor(void) {
+  struct oonf_layer2_net *l2net;
+  struct oonf_layer2_neigh *l2neigh;
+  struct oonf_layer2_history *h;
+  struct netaddr addr;
+  uint32_t origin;
+
+  START_TEST();
+
+  CHECK_TRUE(oonf_layer2_history_add() == 0, "Cannot activate history");
+  origin = oonf_layer2_register_origin();
+
+  CHECK_TRUE(netaddr_from_string(&addr, "02:00:00:00:00:01") == 0, "Bad address");
+  l2net = oonf_layer2_net_add(&addr);
+  CHECK_TRUE(netaddr_from_string(&addr, "02:00:00:00:00:02") == 0, "Bad address");
+  l2neigh = l2net ? oonf_layer2_neigh_add(l2net, &addr) : NULL;
+  CHECK_TRUE(l2neigh != NULL, "Cannot create neighbor");
+  if (l2neigh == NULL) {
+    END_TEST();
+    return;
+  }
+
+  oonf_layer2_set_value(&l2neigh->data[OONF_LAYER2_NEIGH_SIGNAL], origin, -40);
+  oonf_layer2_neigh_commit(l2neigh);
+
+  /* every commit adds a sample, even without a change */
+  oonf_layer2_neigh_commit(l2neigh);
+  h = oonf_layer2_history_get(l2neigh, OONF_LAYER2_NEIGH_SIGNAL);
+  CHECK_TRUE(h != NULL && h->count == 2, "%u signal samples after two commits",
+      h ? h->count : 0);
+  h = oonf_layer2_history_get(l2neigh, OONF_LAYER2_NEIGH_TX_BITRATE);
+  CHECK_TRUE(h != NULL && h->count == 0, "sample for a value that was never set");
+
+  /* deactivate history while the neighbor exists */
+  oonf_layer2_history_remove();
+  CHECK_TRUE(oonf_layer2_history_get(l2neigh, OONF_LAYER2_NEIGH_SIGNAL) == NULL,
+      "inactive history is accessible");
+  oonf_layer2_neigh_commit(l2neigh);
+
+  /* activate it again, the old samples must be gone */
+  CHECK_TRUE(oonf_layer2_history_add() == 0, "Cannot activate history again");
+  h = oonf_layer2_history_get(l2neigh, OONF_LAYER2_NEIGH_SIGNAL);
+  CHECK_TRUE(h != NULL && h->count == 0, "%u old samples after reactivation",
+      h ? h->count : 0);
+
+  oonf_layer2_set_value(&l2neigh->data[OONF_LAYER2_NEIGH_SIGNAL], origin, -60);
+  oonf_layer2_neigh_commit(l2neigh);
+  CHECK_TRUE(h != NULL && h->count == 1 && h->ewma == -60,
+      "wrong history after reactivation");
+
+  oonf_layer2_history_remove();
+  oonf_layer2_net_remove(l2net, origin);
+  oonf_layer2_cleanup_origin(origin);
+  END_TEST();
+}
+
+int
+main(int argc __attribute__ ((unused)), char **argv __attribute__ ((unused))) {
+  size_t i;
+
+  if (oonf_log_init(&appdata, LOG_SEVERITY_WARN)) {
+    return 1;
+  }
+  for (i=0; i<ARRAYSIZE(subsystems); i++) {
+    if (subsystems[i]->init != NULL && subsystems[i]->init()) {
+      return 1;
+    }
+  }
+
+  BEGIN_TESTING(clear_elements);
+
+  test_ring();
+  test_min_max();
+  test_ewma();
+  test_neighbor();
+
+  for (i=ARRAYSIZE(subsystems); i>0; i--) {
+    if (subsystems[i-1]->cleanup != NULL) {
+      subsystems[i-1]->cleanup();
+    }
+  }
+  oonf_log_cleanup();
+  return FINISH_TESTING();
+}